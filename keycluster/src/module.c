@@ -38,7 +38,7 @@ key_vector_t KeyVector = {
         {PORTB, GPIOB, kCLOCK_PortB,  7}, // trackball microswitch
         {PORTA, GPIOA, kCLOCK_PortA,  8}, // right microswitch
     },
-    .keyStates = {0}
+    .keyStates = 0
 };
 
 void BlackberryTrackball_Init(void)
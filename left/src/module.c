@@ -21,7 +21,7 @@ key_matrix_t KeyMatrix = {
         {PORTA, GPIOA, kCLOCK_PortA,  7},
         {PORTA, GPIOA, kCLOCK_PortA,  4}
     },
-    .keyStates = {0}
+    .keyStates = 0
 };
 
 void Module_Init(void)
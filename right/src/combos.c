@@ -0,0 +1,238 @@
+#include <string.h>
+#include "combos.h"
+#include "postponer.h"
+#include "timer.h"
+
+combo_t Combos[COMBO_MAX_COUNT];
+uint8_t ComboCount = 0;
+bool ComboPending = false;
+
+#define INDEXED_KEY_COUNT (SLOT_COUNT*MAX_KEY_COUNT_PER_MODULE)
+
+// Bitmask of combos which every key is a member of. A press of a key with an empty mask costs a single lookup.
+static uint16_t keyCombos[INDEXED_KEY_COUNT];
+
+// State of the pending match, i.e., of member presses which are being held back in the postponer.
+static uint16_t candidates;
+static key_state_t* pendingKeys[COMBO_MAX_KEY_COUNT];
+static uint8_t pendingKeyCount;
+static uint32_t pendingStartTime;
+static uint16_t pendingTimeout;
+
+// State of fired combos: members which are still held, and combos whose output has not been released yet.
+static uint8_t heldMembers[COMBO_MAX_COUNT];
+static uint16_t heldOutputs;
+
+static uint16_t keyIndex(key_state_t* key)
+{
+    key_state_t* first = &KeyStates[0][0];
+    return first <= key && key < first + INDEXED_KEY_COUNT ? key - first : INDEXED_KEY_COUNT;
+}
+
+static uint8_t memberPosition(uint8_t comboIdx, key_state_t* key)
+{
+    for (uint8_t i = 0; i < Combos[comboIdx].keyCount; i++) {
+        if (Combos[comboIdx].keys[i] == key) {
+            return i;
+        }
+    }
+    return COMBO_NONE;
+}
+
+static void rebuildKeyCombos(void)
+{
+    memset(keyCombos, 0, sizeof keyCombos);
+    for (uint8_t i = 0; i < ComboCount; i++) {
+        for (uint8_t j = 0; j < Combos[i].keyCount; j++) {
+            keyCombos[keyIndex(Combos[i].keys[j])] |= 1 << i;
+        }
+    }
+}
+
+// Candidates contain all pending keys, so a candidate of the same size is matched completely.
+static uint8_t findCompleteCombo(void)
+{
+    for (uint8_t i = 0; i < ComboCount; i++) {
+        if ((candidates & (1 << i)) && Combos[i].keyCount == pendingKeyCount) {
+            return i;
+        }
+    }
+    return COMBO_NONE;
+}
+
+static void updatePendingTimeout(void)
+{
+    pendingTimeout = 0;
+    for (uint8_t i = 0; i < ComboCount; i++) {
+        if ((candidates & (1 << i)) && Combos[i].timeout > pendingTimeout) {
+            pendingTimeout = Combos[i].timeout;
+        }
+    }
+}
+
+static void clearPending(void)
+{
+    ComboPending = false;
+    candidates = 0;
+    pendingKeyCount = 0;
+}
+
+// Replaces the postponed presses of the first queuedCount pending keys by a press of the output key.
+// Returns false if they are not in the queue anymore, in which case they get replayed as they are.
+static bool fire(uint8_t comboIdx, uint8_t queuedCount)
+{
+    combo_t* combo = &Combos[comboIdx];
+    bool replaced = PostponerExtended_ReplaceKeypresses(pendingKeys, queuedCount, combo->output);
+
+    if (replaced) {
+        heldMembers[comboIdx] = (1 << combo->keyCount) - 1;
+        heldOutputs |= 1 << comboIdx;
+    }
+    clearPending();
+    return replaced;
+}
+
+// Ends the pending match with all pending presses in the queue, firing the complete combo if there is one.
+static void resolve(void)
+{
+    uint8_t comboIdx = findCompleteCombo();
+    if (comboIdx == COMBO_NONE) {
+        clearPending();
+    } else {
+        fire(comboIdx, pendingKeyCount);
+    }
+}
+
+static void startPending(key_state_t* keyState, uint16_t mask)
+{
+    ComboPending = true;
+    candidates = mask;
+    pendingKeys[0] = keyState;
+    pendingKeyCount = 1;
+    pendingStartTime = CurrentTime;
+    updatePendingTimeout();
+    PostponerCore_PostponeNCycles(0);
+}
+
+static key_state_t* processRelease(key_state_t* keyState, uint16_t mask)
+{
+    for (uint8_t i = 0; i < ComboCount; i++) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        uint8_t position = memberPosition(i, keyState);
+        if (heldMembers[i] & (1 << position)) {
+            heldMembers[i] &= ~(1 << position);
+            if (heldOutputs & (1 << i)) {
+                heldOutputs &= ~(1 << i);
+                return Combos[i].output;
+            }
+            return NULL;
+        }
+    }
+
+    // A release of a pending key ends the match. Its press is still queued, so the release simply follows it.
+    if (ComboPending) {
+        for (uint8_t i = 0; i < pendingKeyCount; i++) {
+            if (pendingKeys[i] == keyState) {
+                resolve();
+                break;
+            }
+        }
+    }
+    return keyState;
+}
+
+// Called for every debounced key event before it gets committed. Returns the key whose event should be
+// committed instead (the output key of a combo), or NULL if the event is consumed.
+key_state_t* Combos_ProcessKeyEvent(key_state_t* keyState, bool active)
+{
+    if (ComboCount == 0) {
+        return keyState;
+    }
+
+    uint16_t idx = keyIndex(keyState);
+    uint16_t mask = idx < INDEXED_KEY_COUNT ? keyCombos[idx] : 0;
+
+    if (!active) {
+        return processRelease(keyState, mask);
+    }
+
+    if (ComboPending) {
+        if ((mask & candidates) && pendingKeyCount < COMBO_MAX_KEY_COUNT) {
+            pendingKeys[pendingKeyCount++] = keyState;
+            candidates &= mask;
+            updatePendingTimeout();
+
+            uint8_t comboIdx = findCompleteCombo();
+            // Wait for the rest of a longer combo, unless this one is the only candidate left.
+            if (comboIdx != COMBO_NONE && candidates == (1 << comboIdx)) {
+                // The current press is not in the queue yet, so it is consumed here.
+                return fire(comboIdx, pendingKeyCount - 1) ? NULL : keyState;
+            }
+            return keyState;
+        }
+        resolve();
+    }
+
+    if (mask) {
+        startPending(keyState, mask);
+    }
+    return keyState;
+}
+
+// Keeps the member presses postponed during the timeout window of the remaining candidates.
+void Combos_UpdatePending(void)
+{
+    if (CurrentTime - pendingStartTime >= pendingTimeout) {
+        resolve();
+    } else {
+        PostponerCore_PostponeNCycles(0);
+    }
+}
+
+bool Combos_Define(key_state_t* output, uint16_t timeout, key_state_t** keys, uint8_t keyCount)
+{
+    Combos_Remove(output);
+
+    if (ComboCount == COMBO_MAX_COUNT || keyCount < 2 || keyCount > COMBO_MAX_KEY_COUNT || keyIndex(output) == INDEXED_KEY_COUNT) {
+        return false;
+    }
+    for (uint8_t i = 0; i < keyCount; i++) {
+        if (keyIndex(keys[i]) == INDEXED_KEY_COUNT) {
+            return false;
+        }
+    }
+
+    combo_t* combo = &Combos[ComboCount++];
+    memcpy(combo->keys, keys, keyCount * sizeof(key_state_t*));
+    combo->keyCount = keyCount;
+    combo->output = output;
+    combo->timeout = timeout;
+
+    rebuildKeyCombos();
+    return true;
+}
+
+void Combos_Remove(key_state_t* output)
+{
+    // Combo indices may shift, so fired combos are forgotten and their outputs released right away.
+    for (uint8_t i = 0; i < ComboCount; i++) {
+        if (heldOutputs & (1 << i)) {
+            Combos[i].output->current = false;
+            KeyState_MarkActive(Combos[i].output);
+        }
+        heldMembers[i] = 0;
+    }
+    heldOutputs = 0;
+    clearPending();
+
+    for (uint8_t i = 0; i < ComboCount; i++) {
+        if (Combos[i].output == output) {
+            memmove(&Combos[i], &Combos[i+1], (ComboCount - i - 1) * sizeof(combo_t));
+            ComboCount--;
+            break;
+        }
+    }
+    rebuildKeyCombos();
+}
@@ -0,0 +1,40 @@
+#ifndef __COMBOS_H__
+#define __COMBOS_H__
+
+// Includes:
+
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include "key_states.h"
+
+// Macros:
+
+    #define COMBO_MAX_COUNT 16
+    #define COMBO_MAX_KEY_COUNT 4
+    #define COMBO_NONE 255
+
+// Typedefs:
+
+    // Pressing all keys of a combo within its timeout activates the output key instead of them.
+    // The output key is released as soon as the first of the keys gets released.
+    typedef struct {
+        key_state_t* keys[COMBO_MAX_KEY_COUNT];
+        key_state_t* output;
+        uint16_t timeout;
+        uint8_t keyCount;
+    } combo_t;
+
+// Variables:
+
+    extern combo_t Combos[COMBO_MAX_COUNT];
+    extern uint8_t ComboCount;
+    extern bool ComboPending;
+
+// Functions:
+
+    bool Combos_Define(key_state_t* output, uint16_t timeout, key_state_t** keys, uint8_t keyCount);
+    void Combos_Remove(key_state_t* output);
+    key_state_t* Combos_ProcessKeyEvent(key_state_t* keyState, bool active);
+    void Combos_UpdatePending(void);
+
+#endif
@@ -4,6 +4,8 @@
 #include "keymap.h"
 #include "config_globals.h"
 #include "macros.h"
+#include "macro_bytecode.h"
+#include "macro_events.h"
 #include "led_display.h"
 #include "slave_scheduler.h"
 #include "slave_drivers/is31fl3xxx_driver.h"
@@ -112,6 +114,11 @@ parser_error_t ParseConfig(config_buffer_t *buffer)
         return ParserError_InvalidMacroCount;
     }
 
+    if (!ParserRunDry) {
+        MacroBytecode_Reset();
+        InvalidateKeymapCache();
+    }
+
     for (uint8_t macroIdx = 0; macroIdx < macroCount; macroIdx++) {
         errorCode = ParseMacro(buffer, macroIdx);
         if (errorCode != ParserError_Success) {
@@ -166,6 +173,9 @@ parser_error_t ParseConfig(config_buffer_t *buffer)
 
         AllKeymapsCount = keymapCount;
         AllMacrosCount = macroCount;
+
+        IndexMacroNames();
+        MacroEvent_RegisterMacros();
     }
 
     return ParserError_Success;
@@ -2,6 +2,10 @@
 #include "config_globals.h"
 #include "str_utils.h"
 #include "macros.h"
+#include "macro_bytecode.h"
+
+// Open addressing hash table keyed by macro names. Holds macro index + 1, 0 marks an empty slot.
+static uint8_t macroNameIndex[MACRO_NAME_INDEX_SIZE];
 
 parser_error_t parseKeyMacroAction(config_buffer_t *buffer, macro_action_t *macroAction, serialized_macro_action_type_t macroActionType)
 {
@@ -143,15 +147,41 @@ void FindMacroName(const macro_reference_t* macro, const char** name, const char
     *nameEnd = *name + nameLen;
 }
 
-uint8_t FindMacroIndexByName(const char* name, const char* nameEnd, bool reportIfFailed)
+// Returns the index slot which holds the given name, or the empty slot where it belongs.
+static uint16_t findMacroNameSlot(const char* name, const char* nameEnd)
 {
-    for (int i = 0; i < AllMacrosCount; i++) {
+    uint16_t slot = StrHash(0, name, nameEnd) & (MACRO_NAME_INDEX_SIZE - 1);
+    while (macroNameIndex[slot] != 0) {
         const char *thisName, *thisNameEnd;
-        FindMacroName(&AllMacros[i], &thisName, &thisNameEnd);
-        if(StrEqual(name, nameEnd, thisName, thisNameEnd)) {
-            return i;
+        FindMacroName(&AllMacros[macroNameIndex[slot] - 1], &thisName, &thisNameEnd);
+        if (StrEqual(name, nameEnd, thisName, thisNameEnd)) {
+            break;
+        }
+        slot = (slot + 1) & (MACRO_NAME_INDEX_SIZE - 1);
+    }
+    return slot;
+}
+
+void IndexMacroNames(void)
+{
+    memset(macroNameIndex, 0, sizeof macroNameIndex);
+    for (uint8_t i = 0; i < AllMacrosCount; i++) {
+        const char *name, *nameEnd;
+        FindMacroName(&AllMacros[i], &name, &nameEnd);
+        uint16_t slot = findMacroNameSlot(name, nameEnd);
+        // In case of duplicate names, the first macro wins.
+        if (macroNameIndex[slot] == 0) {
+            macroNameIndex[slot] = i + 1;
         }
     }
+}
+
+uint8_t FindMacroIndexByName(const char* name, const char* nameEnd, bool reportIfFailed)
+{
+    uint8_t indexEntry = macroNameIndex[findMacroNameSlot(name, nameEnd)];
+    if (indexEntry != 0) {
+        return indexEntry - 1;
+    }
     if (reportIfFailed) {
         Macros_ReportError("Macro name not found", name, nameEnd);
     }
@@ -179,12 +209,20 @@ parser_error_t ParseMacro(config_buffer_t *buffer, uint8_t macroIdx)
         AllMacros[macroIdx].firstMacroActionOffset = firstMacroActionOffset;
         AllMacros[macroIdx].macroActionsCount = macroActionsCount;
         AllMacros[macroIdx].macroNameOffset = relativeNameOffset;
+        MacroBytecode_BeginMacro(macroIdx);
     }
     for (uint16_t i = 0; i < macroActionsCount; i++) {
+        uint16_t actionOffset = buffer->offset;
         errorCode = ParseMacroAction(buffer, &dummyMacroAction);
         if (errorCode != ParserError_Success) {
             return errorCode;
         }
+        if (!ParserRunDry) {
+            MacroBytecode_CompileAction(macroIdx, i, actionOffset, &dummyMacroAction);
+        }
+    }
+    if (!ParserRunDry) {
+        MacroBytecode_EndMacro(macroIdx);
     }
     return ParserError_Success;
 }
@@ -6,6 +6,10 @@
     #include "parse_config.h"
     #include "macros.h"
 
+// Macros:
+
+    #define MACRO_NAME_INDEX_SIZE 512 // power of two, at least twice MAX_MACRO_NUM
+
 // Typedefs:
 
     typedef enum {
@@ -25,6 +29,7 @@
     parser_error_t ParseMacroAction(config_buffer_t *buffer, macro_action_t *macroAction);
     parser_error_t ParseMacro(config_buffer_t *buffer, uint8_t macroIdx);
 
+    void IndexMacroNames(void);
     uint8_t FindMacroIndexByName(const char* name, const char* nameEnd, bool reportIfFailed);
     void FindMacroName(const macro_reference_t* macro, const char** name, const char** nameEnd);
 
@@ -17,8 +17,8 @@ static uint32_t watchInterval = 500;
 void AddReportToStatusBuffer(usb_basic_keyboard_report_t *report)
 {
     Macros_SetStatusNum(report->modifiers);
-    for (int i = 0; i < 6; i++) {
-        Macros_SetStatusNum(report->scancodes[i]);
+    for (uint8_t scancode = UsbBasicKeyboardNextScancode(report, 0); scancode != 0; scancode = UsbBasicKeyboardNextScancode(report, scancode)) {
+        Macros_SetStatusNum(scancode);
     }
     Macros_SetStatusString("\n", NULL);
 }
@@ -1,3 +1,4 @@
 #include "key_states.h"
 
 key_state_t KeyStates[SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
+key_state_bits_t KeyStateBits[SLOT_COUNT];
@@ -7,31 +7,53 @@
     #include "slot.h"
     #include "module.h"
 
+// Macros:
+
+    #if MAX_KEY_COUNT_PER_MODULE > 64
+        #error "Key state bitmaps assume at most 64 keys per module."
+    #endif
+
 // Typedefs:
 
-    // Next is used as an accumulator of the state - asynchronous state updates
-    // are stored there. The hardwareSwitchState always contains the most up-to-date
-    // information about hardware state of the switch.
+    // The most up-to-date hardware state of the switches is kept in the `hardware`
+    // bitmap of key_state_bits_t.
     //
-    // `Previous` and `current` are computed from `hardwareSwitchState` by "debouncing"
+    // `Previous` and `current` are computed from the hardware state by "debouncing"
     // algorithm.  Especially values (0, 1) signify that key has been pressed
     // right now and an action (e.g., start of a macro) should take place.
     //
-    // Debouncing flag & timestamp are used by debouncer to prevent the value
+    // Debouncing flags & timestamp are used by debouncer to prevent the value
     // of current from changing for next 50 ms whenever the key state changes.
+    // The debounced state and debouncing flags are kept packed in key_state_bits_t.
 
     typedef struct {
         uint8_t timestamp;
-        volatile bool hardwareSwitchState : 1;
-        bool debouncedSwitchState : 1;
         bool current : 1;
         bool previous : 1;
-        bool debouncing : 1;
     } key_state_t;
 
+    // Per-slot bitmaps, bit n belongs to KeyStates[slot][n].
+    //
+    // `hardware` is the state of the switches and is written as a whole by the producer
+    // of the slot (matrix scan or module driver, possibly from interrupt context).
+    // `debounced` and `debouncing` are the state of the debouncer, and `active` marks
+    // keys whose current or previous state is set. These are only touched from the main loop.
+    // A producer which loses its keys, e.g. a disconnected module, sets `resetRequested`,
+    // and the main loop clears the key states of the slot. `pressTime` is the time in us
+    // at which the producer last set a new bit of `hardware`.
+    typedef struct {
+        volatile uint64_t hardware;
+        volatile uint32_t pressTime;
+        uint64_t debounced;
+        uint64_t debouncing;
+        uint64_t active;
+        volatile bool resetRequested;
+    } key_state_bits_t;
+
 // Variables:
 
     extern key_state_t KeyStates[SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
+    extern key_state_bits_t KeyStateBits[SLOT_COUNT];
 
 // Inline functions
 
@@ -43,4 +65,17 @@
     static inline bool KeyState_DeactivatedEarlier(key_state_t* s) { return !s->previous && !s->current; };
     static inline bool KeyState_NonZero(key_state_t* s) { return s->previous || s->current; };
 
+    static inline bool KeyState_Debouncing(key_state_t* s) {
+        uint16_t idx = s - &KeyStates[0][0];
+        return (KeyStateBits[idx / MAX_KEY_COUNT_PER_MODULE].debouncing >> (idx % MAX_KEY_COUNT_PER_MODULE)) & 1;
+    };
+
+    // Call whenever `current` of a key is changed outside of the debouncer, e.g., by the postponer.
+    static inline void KeyState_MarkActive(key_state_t* s) {
+        ptrdiff_t idx = s - &KeyStates[0][0];
+        if (0 <= idx && idx < SLOT_COUNT * MAX_KEY_COUNT_PER_MODULE) {
+            KeyStateBits[idx / MAX_KEY_COUNT_PER_MODULE].active |= 1ULL << (idx % MAX_KEY_COUNT_PER_MODULE);
+        }
+    };
+
 #endif
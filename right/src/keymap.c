@@ -7,6 +7,7 @@
 #include "config_parser/config_globals.h"
 #include "macros.h"
 #include "macro_events.h"
+#include "timer.h"
 
 keymap_reference_t AllKeymaps[MAX_KEYMAP_NUM] = {
     {
@@ -19,12 +20,77 @@ keymap_reference_t AllKeymaps[MAX_KEYMAP_NUM] = {
 uint8_t AllKeymapsCount;
 uint8_t DefaultKeymapIndex;
 uint8_t CurrentKeymapIndex = 0;
+uint32_t KeymapSwitchLatencyMicros;
+
+static key_action_t factoryKeymap[LayerId_Count][SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
+static key_action_t ATTR_DATA2 keymapCacheSlots[KEYMAP_CACHE_SIZE - 1][LayerId_Count][SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
+static keymap_cache_entry_t keymapCache[KEYMAP_CACHE_SIZE];
+static uint32_t keymapCacheClock;
+static volatile uint32_t keymapCacheGeneration;
+
+key_action_t (*CurrentKeymap)[SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE] = factoryKeymap;
+
+// Parsed keymaps depend on both the validated config and the set of attached modules,
+// so this is called whenever either of them changes. It may be called from interrupt context.
+void InvalidateKeymapCache(void)
+{
+    keymapCacheGeneration++;
+}
+
+static keymap_cache_entry_t* findCachedKeymap(uint8_t index)
+{
+    for (uint8_t i = 0; i < KEYMAP_CACHE_SIZE; i++) {
+        keymap_cache_entry_t *entry = &keymapCache[i];
+        if (entry->valid && entry->keymapIdx == index && entry->generation == keymapCacheGeneration) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static keymap_cache_entry_t* allocateCachedKeymap(void)
+{
+    keymap_cache_entry_t *lru = NULL;
+    for (uint8_t i = 0; i < KEYMAP_CACHE_SIZE; i++) {
+        keymap_cache_entry_t *entry = &keymapCache[i];
+        if (entry->keymap == NULL) {
+            entry->keymap = i == 0 ? factoryKeymap : keymapCacheSlots[i-1];
+        }
+        // Never evict the active keymap as it may be still referenced by ongoing actions.
+        if (entry->keymap == CurrentKeymap) {
+            continue;
+        }
+        if (!entry->valid || entry->generation != keymapCacheGeneration) {
+            return entry;
+        }
+        if (lru == NULL || entry->lastUse < lru->lastUse) {
+            lru = entry;
+        }
+    }
+    return lru;
+}
 
 void SwitchKeymapById(uint8_t index)
 {
+    uint32_t switchStart = Timer_GetCurrentTimeMicros();
+    keymap_cache_entry_t *entry = findCachedKeymap(index);
+
+    if (entry == NULL) {
+        uint32_t generation = keymapCacheGeneration;
+        entry = allocateCachedKeymap();
+        entry->valid = false;
+        CurrentKeymap = entry->keymap;
+        ValidatedUserConfigBuffer.offset = AllKeymaps[index].offset;
+        ParseKeymap(&ValidatedUserConfigBuffer, index, AllKeymapsCount, AllMacrosCount);
+        entry->keymapIdx = index;
+        entry->generation = generation;
+        entry->valid = true;
+    }
+
+    entry->lastUse = ++keymapCacheClock;
+    CurrentKeymap = entry->keymap;
     CurrentKeymapIndex = index;
-    ValidatedUserConfigBuffer.offset = AllKeymaps[index].offset;
-    ParseKeymap(&ValidatedUserConfigBuffer, index, AllKeymapsCount, AllMacrosCount);
+    KeymapSwitchLatencyMicros = Timer_GetCurrentTimeMicros() - switchStart;
     LedDisplay_UpdateText();
     UpdateLayerLeds();
     MacroEvent_OnKeymapChange(index);
@@ -53,7 +119,8 @@ bool SwitchKeymapByAbbreviation(uint8_t length, const char *abbrev)
 }
 
 // The factory keymap is initialized before it gets overwritten by the default keymap of the EEPROM.
-key_action_t CurrentKeymap[LayerId_Count][SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE] = {
+// Its storage serves as the first slot of the keymap cache afterwards.
+static key_action_t factoryKeymap[LayerId_Count][SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE] = {
     // Base layer
     {
         // Right keyboard half
@@ -10,6 +10,11 @@
 
     #define MAX_KEYMAP_NUM 255
     #define KEYMAP_ABBREVIATION_LENGTH 3
+    // Number of parsed keymaps kept in RAM, at least 2. Every keymap but the first one, which
+    // reuses the storage of the factory keymap, takes LayerId_Count * SLOT_COUNT *
+    // MAX_KEY_COUNT_PER_MODULE packed 6 byte key actions, i.e. 6 KiB. Two keep switching
+    // back and forth between a pair of keymaps free of parsing.
+    #define KEYMAP_CACHE_SIZE 2
 
 // Typedefs:
 
@@ -19,18 +24,28 @@
         uint8_t abbreviationLen;
     } keymap_reference_t;
 
+    typedef struct {
+        key_action_t (*keymap)[SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
+        uint32_t lastUse;
+        uint8_t keymapIdx;
+        uint32_t generation;
+        bool valid;
+    } keymap_cache_entry_t;
+
 // Variables:
 
     extern keymap_reference_t AllKeymaps[MAX_KEYMAP_NUM];
     extern uint8_t AllKeymapsCount;
     extern uint8_t DefaultKeymapIndex;
     extern uint8_t CurrentKeymapIndex;
-    extern key_action_t CurrentKeymap[LayerId_Count][SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
+    extern key_action_t (*CurrentKeymap)[SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
+    extern uint32_t KeymapSwitchLatencyMicros;
 
 // Functions:
 
     void SwitchKeymapById(uint8_t index);
     bool SwitchKeymapByAbbreviation(uint8_t length, const char *abbrev);
     uint8_t FindKeymapByAbbreviation(uint8_t length, const char *abbrev);
+    void InvalidateKeymapCache(void);
 
 #endif
@@ -0,0 +1,506 @@
+#include "macro_bytecode.h"
+#include "str_utils.h"
+#include "eeprom.h"
+#include "config_parser/config_globals.h"
+
+/**
+ * Command actions are kept as text in the validated user config buffer.
+ * When a configuration is applied, every command token of every command
+ * action is decoded once and its opcode is stored in an arena which is
+ * sorted by the token's offset in the config buffer. The runtime then
+ * fetches opcodes by a binary search instead of matching the token against
+ * all known command names on every continuation of a macro action.
+ *
+ * Each instruction also keeps its first operands. Integer literals (delays,
+ * timeouts, key ids, register indices...) are parsed when compiling. Jump
+ * targets of goTo and repeatFor, labels and @ addresses alike, are resolved to
+ * action indices once the whole macro is compiled. Operands which depend on
+ * the runtime state (register values, pending keys...) are parsed from the
+ * text every time.
+ *
+ * Tokens which are not known at compile time (e.g., commands which follow
+ * the key list of ifShortcut) are decoded on the fly, by a binary search over
+ * the command names, which are kept in the lexicographic order.
+ *
+ * Alongside, every macro gets an index of its action offsets and of its
+ * labels, so that goTo and friends can jump without reparsing the macro.
+ * Macros which don't fit into the arenas are left unindexed and are served
+ * by the slow paths in macros.c.
+ */
+
+const macro_opcode_info_t MacroOpcodeInfo[MacroOpcode_Count] = {
+    [MacroOpcode_Unknown] = { "", false, 0 },
+    [MacroOpcode_ActivateKeyPostponed] = { "activateKeyPostponed", false, 0 },
+    [MacroOpcode_AddReg] = { "addReg", false, 0 },
+    [MacroOpcode_Break] = { "break", false, 0 },
+    [MacroOpcode_Call] = { "call", false, 0 },
+    [MacroOpcode_ClearStatus] = { "clearStatus", false, 0 },
+    [MacroOpcode_ConsumePending] = { "consumePending", false, 0 },
+    [MacroOpcode_DelayUntil] = { "delayUntil", false, 0 },
+    [MacroOpcode_DelayUntilRelease] = { "delayUntilRelease", false, 0 },
+    [MacroOpcode_DelayUntilReleaseMax] = { "delayUntilReleaseMax", false, 0 },
+    [MacroOpcode_Diagnose] = { "diagnose", false, 0 },
+    [MacroOpcode_Exec] = { "exec", false, 0 },
+    [MacroOpcode_Final] = { "final", true, 0 },
+    [MacroOpcode_GoTo] = { "goTo", false, 0 },
+    [MacroOpcode_HoldKey] = { "holdKey", false, 0 },
+    [MacroOpcode_HoldKeymapLayer] = { "holdKeymapLayer", false, 0 },
+    [MacroOpcode_HoldKeymapLayerMax] = { "holdKeymapLayerMax", false, 0 },
+    [MacroOpcode_HoldLayer] = { "holdLayer", false, 0 },
+    [MacroOpcode_HoldLayerMax] = { "holdLayerMax", false, 0 },
+    [MacroOpcode_IfAlt] = { "ifAlt", true, 0 },
+    [MacroOpcode_IfAnyMod] = { "ifAnyMod", true, 0 },
+    [MacroOpcode_IfCtrl] = { "ifCtrl", true, 0 },
+    [MacroOpcode_IfDoubletap] = { "ifDoubletap", true, 0 },
+    [MacroOpcode_IfGesture] = { "ifGesture", false, 0 },
+    [MacroOpcode_IfGui] = { "ifGui", true, 0 },
+    [MacroOpcode_IfInterrupted] = { "ifInterrupted", true, 0 },
+    [MacroOpcode_IfKeyActive] = { "ifKeyActive", true, 1 },
+    [MacroOpcode_IfKeyDefined] = { "ifKeyDefined", true, 1 },
+    [MacroOpcode_IfKeyPendingAt] = { "ifKeyPendingAt", true, 2 },
+    [MacroOpcode_IfNotAlt] = { "ifNotAlt", true, 0 },
+    [MacroOpcode_IfNotAnyMod] = { "ifNotAnyMod", true, 0 },
+    [MacroOpcode_IfNotCtrl] = { "ifNotCtrl", true, 0 },
+    [MacroOpcode_IfNotDoubletap] = { "ifNotDoubletap", true, 0 },
+    [MacroOpcode_IfNotGesture] = { "ifNotGesture", false, 0 },
+    [MacroOpcode_IfNotGui] = { "ifNotGui", true, 0 },
+    [MacroOpcode_IfNotInterrupted] = { "ifNotInterrupted", true, 0 },
+    [MacroOpcode_IfNotKeyActive] = { "ifNotKeyActive", true, 1 },
+    [MacroOpcode_IfNotKeyDefined] = { "ifNotKeyDefined", true, 1 },
+    [MacroOpcode_IfNotKeyPendingAt] = { "ifNotKeyPendingAt", true, 2 },
+    [MacroOpcode_IfNotPending] = { "ifNotPending", true, 1 },
+    [MacroOpcode_IfNotPendingKeyReleased] = { "ifNotPendingKeyReleased", true, 1 },
+    [MacroOpcode_IfNotPlaytime] = { "ifNotPlaytime", true, 1 },
+    [MacroOpcode_IfNotRecording] = { "ifNotRecording", true, 0 },
+    [MacroOpcode_IfNotRecordingId] = { "ifNotRecordingId", true, 1 },
+    [MacroOpcode_IfNotRegEq] = { "ifNotRegEq", true, 2 },
+    [MacroOpcode_IfNotReleased] = { "ifNotReleased", true, 0 },
+    [MacroOpcode_IfNotShift] = { "ifNotShift", true, 0 },
+    [MacroOpcode_IfNotShortcut] = { "ifNotShortcut", false, 0 },
+    [MacroOpcode_IfPending] = { "ifPending", true, 1 },
+    [MacroOpcode_IfPendingKeyReleased] = { "ifPendingKeyReleased", true, 1 },
+    [MacroOpcode_IfPlaytime] = { "ifPlaytime", true, 1 },
+    [MacroOpcode_IfPrimary] = { "ifPrimary", false, 0 },
+    [MacroOpcode_IfRecording] = { "ifRecording", true, 0 },
+    [MacroOpcode_IfRecordingId] = { "ifRecordingId", true, 1 },
+    [MacroOpcode_IfRegEq] = { "ifRegEq", true, 2 },
+    [MacroOpcode_IfReleased] = { "ifReleased", true, 0 },
+    [MacroOpcode_IfSecondary] = { "ifSecondary", false, 0 },
+    [MacroOpcode_IfShift] = { "ifShift", true, 0 },
+    [MacroOpcode_IfShortcut] = { "ifShortcut", false, 0 },
+    [MacroOpcode_MulReg] = { "mulReg", false, 0 },
+    [MacroOpcode_NoOp] = { "noOp", false, 0 },
+    [MacroOpcode_PlayMacro] = { "playMacro", false, 0 },
+    [MacroOpcode_PostponeKeys] = { "postponeKeys", true, 0 },
+    [MacroOpcode_PostponeNext] = { "postponeNext", false, 0 },
+    [MacroOpcode_PressKey] = { "pressKey", false, 0 },
+    [MacroOpcode_PrintStatus] = { "printStatus", false, 0 },
+    [MacroOpcode_RecordMacro] = { "recordMacro", false, 0 },
+    [MacroOpcode_RecordMacroBlind] = { "recordMacroBlind", false, 0 },
+    [MacroOpcode_RecordMacroDelay] = { "recordMacroDelay", false, 0 },
+    [MacroOpcode_ReleaseKey] = { "releaseKey", false, 0 },
+    [MacroOpcode_RepeatFor] = { "repeatFor", false, 0 },
+    [MacroOpcode_ResolveNextKeyEq] = { "resolveNextKeyEq", false, 0 },
+    [MacroOpcode_ResolveNextKeyId] = { "resolveNextKeyId", false, 0 },
+    [MacroOpcode_ResolveSecondary] = { "resolveSecondary", false, 0 },
+    [MacroOpcode_Set] = { "set", false, 0 },
+    [MacroOpcode_SetLedTxt] = { "setLedTxt", false, 0 },
+    [MacroOpcode_SetReg] = { "setReg", false, 0 },
+    [MacroOpcode_SetStatus] = { "setStatus", false, 0 },
+    [MacroOpcode_SetStatusPart] = { "setStatusPart", false, 0 },
+    [MacroOpcode_StartMouse] = { "startMouse", false, 0 },
+    [MacroOpcode_StartRecording] = { "startRecording", false, 0 },
+    [MacroOpcode_StartRecordingBlind] = { "startRecordingBlind", false, 0 },
+    [MacroOpcode_StatsActiveKeys] = { "statsActiveKeys", false, 0 },
+    [MacroOpcode_StatsActiveMacros] = { "statsActiveMacros", false, 0 },
+    [MacroOpcode_StatsLayerStack] = { "statsLayerStack", false, 0 },
+    [MacroOpcode_StatsPostponerStack] = { "statsPostponerStack", false, 0 },
+    [MacroOpcode_StatsRegs] = { "statsRegs", false, 0 },
+    [MacroOpcode_StatsRuntime] = { "statsRuntime", false, 0 },
+    [MacroOpcode_StopAllMacros] = { "stopAllMacros", false, 0 },
+    [MacroOpcode_StopMouse] = { "stopMouse", false, 0 },
+    [MacroOpcode_StopRecording] = { "stopRecording", false, 0 },
+    [MacroOpcode_StopRecordingBlind] = { "stopRecordingBlind", false, 0 },
+    [MacroOpcode_SubReg] = { "subReg", false, 0 },
+    [MacroOpcode_SuppressMods] = { "suppressMods", true, 0 },
+    [MacroOpcode_SwitchKeymap] = { "switchKeymap", false, 0 },
+    [MacroOpcode_SwitchKeymapLayer] = { "switchKeymapLayer", false, 0 },
+    [MacroOpcode_SwitchLayer] = { "switchLayer", false, 0 },
+    [MacroOpcode_TapKey] = { "tapKey", false, 0 },
+    [MacroOpcode_TapKeySeq] = { "tapKeySeq", false, 0 },
+    [MacroOpcode_ToggleKeymapLayer] = { "toggleKeymapLayer", false, 0 },
+    [MacroOpcode_ToggleLayer] = { "toggleLayer", false, 0 },
+    [MacroOpcode_UnToggleLayer] = { "unToggleLayer", false, 0 },
+    [MacroOpcode_Write] = { "write", false, 0 },
+    [MacroOpcode_WriteExpr] = { "writeExpr", false, 0 },
+};
+
+static macro_instruction_t instructions[MACRO_BYTECODE_MAX_INSTRUCTIONS];
+static uint16_t instructionCount;
+static const uint8_t *compiledBuffer;
+
+static uint16_t actionOffsets[MACRO_BYTECODE_MAX_ACTION_OFFSETS];
+static uint16_t actionOffsetCount;
+static macro_label_t labels[MACRO_BYTECODE_MAX_LABELS];
+static uint8_t labelCount;
+static macro_index_t macroIndices[MAX_MACRO_NUM];
+static uint8_t indexedMacroCount;
+
+static bool isIndexed(uint8_t macroIdx)
+{
+    return compiledBuffer == ValidatedUserConfigBuffer.buffer && macroIdx < indexedMacroCount;
+}
+
+// Compares the token with the name like strcmp, with the token ending at
+// whitespace or at a dot, as in TokenMatches.
+static int8_t compareToken(const char *cmd, const char *cmdEnd, const char *name)
+{
+    while (cmd < cmdEnd && *cmd > 32 && *cmd != '.' && *cmd == *name) {
+        cmd++;
+        name++;
+    }
+    uint8_t c = cmd < cmdEnd && *cmd > 32 && *cmd != '.' ? *cmd : '\0';
+    if (c == (uint8_t)*name) {
+        return 0;
+    }
+    return c < (uint8_t)*name ? -1 : 1;
+}
+
+macro_opcode_t MacroBytecode_Decode(const char *cmd, const char *cmdEnd)
+{
+    uint8_t lo = MacroOpcode_Unknown + 1;
+    uint8_t hi = MacroOpcode_Count;
+    while (lo < hi) {
+        uint8_t mid = (lo + hi) / 2;
+        int8_t cmp = compareToken(cmd, cmdEnd, MacroOpcodeInfo[mid].name);
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return MacroOpcode_Unknown;
+}
+
+// Returns the opcode of the command token. If the token has been compiled,
+// its instruction is returned too, otherwise the instruction is NULL.
+macro_opcode_t MacroBytecode_Fetch(const char *cmd, const char *cmdEnd, const macro_instruction_t **instruction)
+{
+    *instruction = NULL;
+
+    const uint8_t *bufferStart = ValidatedUserConfigBuffer.buffer;
+    const uint8_t *tok = (const uint8_t*)cmd;
+
+    if (compiledBuffer == bufferStart && bufferStart <= tok && tok < bufferStart + USER_CONFIG_SIZE) {
+        uint16_t offset = tok - bufferStart;
+        uint16_t lo = 0;
+        uint16_t hi = instructionCount;
+        while (lo < hi) {
+            uint16_t mid = (lo + hi) / 2;
+            if (instructions[mid].offset < offset) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo < instructionCount && instructions[lo].offset == offset) {
+            *instruction = &instructions[lo];
+            return instructions[lo].opcode;
+        }
+    }
+    return MacroBytecode_Decode(cmd, cmdEnd);
+}
+
+static int8_t findOperand(const macro_instruction_t *instruction, const char *arg)
+{
+    const char *cmd = (const char*)ValidatedUserConfigBuffer.buffer + instruction->offset;
+    if (arg <= cmd || arg - cmd > UINT8_MAX) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < MACRO_BYTECODE_MAX_OPERANDS; i++) {
+        if (instruction->operandOffsets[i] == arg - cmd) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Tells the pre-parsed value of the operand token at arg, if it is known.
+bool MacroBytecode_FetchOperand(const macro_instruction_t *instruction, const char *arg, int32_t *value)
+{
+    if (instruction == NULL || compiledBuffer != ValidatedUserConfigBuffer.buffer) {
+        return false;
+    }
+    int8_t i = findOperand(instruction, arg);
+    if (i < 0 || !(instruction->resolvedOperands & (1 << i))) {
+        return false;
+    }
+    *value = instruction->operands[i];
+    return true;
+}
+
+void MacroBytecode_Reset(void)
+{
+    instructionCount = 0;
+    actionOffsetCount = 0;
+    labelCount = 0;
+    indexedMacroCount = 0;
+    compiledBuffer = ValidatedUserConfigBuffer.buffer;
+}
+
+// Integer literals are exactly the operands which Macros_ParseInt parses
+// without looking at the runtime state.
+static bool parseLiteral(const char *arg, const char *argEnd, int32_t *value)
+{
+    const char *digits = *arg == '-' ? arg + 1 : arg;
+    if (digits >= argEnd || *digits < '0' || *digits > '9') {
+        return false;
+    }
+    *value = ParseInt32_2(arg, argEnd, NULL);
+    return true;
+}
+
+// Tells which operand of the instruction is a jump target, or -1.
+static int8_t addressOperand(macro_opcode_t opcode)
+{
+    switch (opcode) {
+        case MacroOpcode_GoTo:
+            return 0;
+        case MacroOpcode_RepeatFor:
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+static void emit(const char *cmd, const char *cmdEnd, macro_opcode_t opcode)
+{
+    uint16_t offset = (const uint8_t*)cmd - ValidatedUserConfigBuffer.buffer;
+
+    if (instructionCount >= MACRO_BYTECODE_MAX_INSTRUCTIONS) {
+        return;
+    }
+    if (instructionCount > 0 && instructions[instructionCount-1].offset >= offset) {
+        return;
+    }
+    macro_instruction_t *instruction = &instructions[instructionCount];
+    instruction->offset = offset;
+    instruction->opcode = opcode;
+    instruction->resolvedOperands = 0;
+
+    const char *arg = cmd;
+    for (uint8_t i = 0; i < MACRO_BYTECODE_MAX_OPERANDS; i++) {
+        arg = NextTok(arg, cmdEnd);
+        instruction->operandOffsets[i] = 0;
+        if (arg >= cmdEnd || arg - cmd > UINT8_MAX) {
+            continue;
+        }
+        int32_t value = 0;
+        instruction->operandOffsets[i] = arg - cmd;
+        if (parseLiteral(arg, cmdEnd, &value)) {
+            instruction->resolvedOperands |= 1 << i;
+        } else if (i == addressOperand(opcode)) {
+            // resolved by MacroBytecode_EndMacro, which needs to know where the label ends
+            value = TokEnd(arg, cmdEnd) - arg;
+        }
+        instruction->operands[i] = value;
+    }
+    instructionCount++;
+}
+
+static void compileLine(const char *cmd, const char *cmdEnd)
+{
+    if (*cmd == '$') {
+        cmd++;
+    }
+
+    const char* cmdTokEnd = TokEnd(cmd, cmdEnd);
+    if (cmdTokEnd > cmd && cmdTokEnd[-1] == ':') {
+        cmd = NextTok(cmd, cmdEnd);
+    }
+
+    while (cmd < cmdEnd && *cmd > 32) {
+        macro_opcode_t opcode = MacroBytecode_Decode(cmd, cmdEnd);
+        if (opcode == MacroOpcode_Unknown) {
+            return;
+        }
+        emit(cmd, cmdEnd, opcode);
+        if (!MacroOpcodeInfo[opcode].isPrefix) {
+            return;
+        }
+        cmd = NextTok(cmd, cmdEnd);
+        for (uint8_t i = 0; i < MacroOpcodeInfo[opcode].argCount; i++) {
+            cmd = NextTok(cmd, cmdEnd);
+        }
+    }
+}
+
+static void compileCommandAction(const char *text, const char *textEnd)
+{
+    const char *cmd = text;
+
+    while (cmd < textEnd) {
+        if (*cmd != '#' && !(cmd[0] == '/' && cmd[1] == '/')) {
+            compileLine(cmd, textEnd);
+        }
+        cmd = NextCmd(cmd, textEnd);
+    }
+}
+
+// Finds the label which a text action starting with $ or a command action begins with, e.g. "loop: ".
+bool MacroBytecode_ActionLabel(const macro_action_t *action, const char **label, const char **labelEnd)
+{
+    const char *cmd;
+    const char *cmdEnd;
+
+    if (action->type == MacroActionType_Text && action->text.textLen > 0 && *action->text.text == '$') {
+        cmd = action->text.text + 1;
+        cmdEnd = action->text.text + action->text.textLen;
+    } else if (action->type == MacroActionType_Command && action->cmd.textLen > 0) {
+        cmd = *action->cmd.text == '$' ? action->cmd.text + 1 : action->cmd.text;
+        cmdEnd = action->cmd.text + action->cmd.textLen;
+    } else {
+        return false;
+    }
+
+    const char* cmdTokEnd = TokEnd(cmd, cmdEnd);
+    if (cmdTokEnd == cmd || cmdTokEnd[-1] != ':') {
+        return false;
+    }
+    *label = cmd;
+    *labelEnd = cmdTokEnd - 1;
+    return true;
+}
+
+static void indexLabel(uint8_t macroIdx, uint8_t actionIdx, const macro_action_t *action)
+{
+    macro_index_t *index = &macroIndices[macroIdx];
+    const char *label;
+    const char *labelEnd;
+
+    if (!MacroBytecode_ActionLabel(action, &label, &labelEnd)) {
+        return;
+    }
+    if (labelCount >= MACRO_BYTECODE_MAX_LABELS) {
+        index->labelsIndexed = false;
+        return;
+    }
+    labels[labelCount].nameOffset = (const uint8_t*)label - ValidatedUserConfigBuffer.buffer;
+    labels[labelCount].nameLen = labelEnd - label;
+    labels[labelCount].actionIndex = actionIdx;
+    labelCount++;
+    index->labelCount++;
+}
+
+void MacroBytecode_BeginMacro(uint8_t macroIdx)
+{
+    macro_index_t *index = &macroIndices[macroIdx];
+
+    index->firstActionOffset = actionOffsetCount;
+    index->firstInstruction = instructionCount;
+    index->firstLabel = labelCount;
+    index->labelCount = 0;
+    index->actionsIndexed = true;
+    index->labelsIndexed = true;
+    indexedMacroCount = macroIdx + 1;
+}
+
+void MacroBytecode_CompileAction(uint8_t macroIdx, uint8_t actionIdx, uint16_t offset, const macro_action_t *action)
+{
+    macro_index_t *index = &macroIndices[macroIdx];
+
+    if (actionOffsetCount < MACRO_BYTECODE_MAX_ACTION_OFFSETS) {
+        actionOffsets[actionOffsetCount++] = offset;
+    } else {
+        index->actionsIndexed = false;
+    }
+
+    indexLabel(macroIdx, actionIdx, action);
+    if (action->type == MacroActionType_Command) {
+        compileCommandAction(action->cmd.text, action->cmd.text + action->cmd.textLen);
+    }
+}
+
+static bool resolveAddress(uint8_t macroIdx, uint8_t actionIdx, const char *arg, const char *argEnd, int32_t *address)
+{
+    uint8_t labelAdr;
+
+    if (*arg == '@') {
+        if (!parseLiteral(arg + 1, argEnd, address)) {
+            return false;
+        }
+        *address += actionIdx;
+        return true;
+    }
+    if (!MacroBytecode_FindLabel(macroIdx, actionIdx, arg, argEnd, &labelAdr) || labelAdr == 255) {
+        return false;
+    }
+    *address = labelAdr;
+    return true;
+}
+
+// Resolves the jump targets of the macro, now that all of its labels are known.
+// Targets which can't be resolved are left to the runtime, which reports them.
+void MacroBytecode_EndMacro(uint8_t macroIdx)
+{
+    macro_index_t *index = &macroIndices[macroIdx];
+    const uint16_t *macroActionOffsets = &actionOffsets[index->firstActionOffset];
+    uint8_t actionCount = AllMacros[macroIdx].macroActionsCount;
+    uint8_t actionIdx = 0;
+
+    if (!index->actionsIndexed) {
+        return;
+    }
+    for (uint16_t i = index->firstInstruction; i < instructionCount; i++) {
+        macro_instruction_t *instruction = &instructions[i];
+        int8_t operand = addressOperand(instruction->opcode);
+        if (operand < 0 || instruction->operandOffsets[operand] == 0 || (instruction->resolvedOperands & (1 << operand))) {
+            continue;
+        }
+        while (actionIdx + 1 < actionCount && macroActionOffsets[actionIdx + 1] <= instruction->offset) {
+            actionIdx++;
+        }
+        const char *arg = (const char*)ValidatedUserConfigBuffer.buffer + instruction->offset + instruction->operandOffsets[operand];
+        int32_t address;
+        if (resolveAddress(macroIdx, actionIdx, arg, arg + instruction->operands[operand], &address)) {
+            instruction->operands[operand] = address;
+            instruction->resolvedOperands |= 1 << operand;
+        }
+    }
+}
+
+bool MacroBytecode_FindActionOffset(uint8_t macroIdx, uint8_t actionIdx, uint16_t *offset)
+{
+    macro_index_t *index = &macroIndices[macroIdx];
+
+    if (!isIndexed(macroIdx) || !index->actionsIndexed || actionIdx >= AllMacros[macroIdx].macroActionsCount) {
+        return false;
+    }
+    *offset = actionOffsets[index->firstActionOffset + actionIdx];
+    return true;
+}
+
+bool MacroBytecode_FindLabel(uint8_t macroIdx, uint8_t currentAdr, const char *label, const char *labelEnd, uint8_t *address)
+{
+    macro_index_t *index = &macroIndices[macroIdx];
+
+    if (!isIndexed(macroIdx) || !index->labelsIndexed) {
+        return false;
+    }
+
+    uint8_t firstFoundAdr = 255;
+    for (uint8_t i = index->firstLabel; i < index->firstLabel + index->labelCount; i++) {
+        const char *name = (const char*)ValidatedUserConfigBuffer.buffer + labels[i].nameOffset;
+        if (TokenMatches2(name, name + labels[i].nameLen, label, labelEnd)) {
+            firstFoundAdr = firstFoundAdr == 255 ? labels[i].actionIndex : firstFoundAdr;
+            if (labels[i].actionIndex > currentAdr) {
+                firstFoundAdr = labels[i].actionIndex;
+                break;
+            }
+        }
+    }
+    *address = firstFoundAdr;
+    return true;
+}
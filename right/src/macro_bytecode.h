@@ -0,0 +1,176 @@
+#ifndef __MACRO_BYTECODE_H__
+#define __MACRO_BYTECODE_H__
+
+// Includes:
+
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include "attributes.h"
+    #include "macros.h"
+
+// Macros:
+
+    #define MACRO_BYTECODE_MAX_INSTRUCTIONS 512
+    #define MACRO_BYTECODE_MAX_ACTION_OFFSETS 1024
+    #define MACRO_BYTECODE_MAX_LABELS 128
+    #define MACRO_BYTECODE_MAX_OPERANDS 2
+
+// Typedefs:
+
+    typedef enum {
+        MacroOpcode_Unknown,
+        MacroOpcode_ActivateKeyPostponed,
+        MacroOpcode_AddReg,
+        MacroOpcode_Break,
+        MacroOpcode_Call,
+        MacroOpcode_ClearStatus,
+        MacroOpcode_ConsumePending,
+        MacroOpcode_DelayUntil,
+        MacroOpcode_DelayUntilRelease,
+        MacroOpcode_DelayUntilReleaseMax,
+        MacroOpcode_Diagnose,
+        MacroOpcode_Exec,
+        MacroOpcode_Final,
+        MacroOpcode_GoTo,
+        MacroOpcode_HoldKey,
+        MacroOpcode_HoldKeymapLayer,
+        MacroOpcode_HoldKeymapLayerMax,
+        MacroOpcode_HoldLayer,
+        MacroOpcode_HoldLayerMax,
+        MacroOpcode_IfAlt,
+        MacroOpcode_IfAnyMod,
+        MacroOpcode_IfCtrl,
+        MacroOpcode_IfDoubletap,
+        MacroOpcode_IfGesture,
+        MacroOpcode_IfGui,
+        MacroOpcode_IfInterrupted,
+        MacroOpcode_IfKeyActive,
+        MacroOpcode_IfKeyDefined,
+        MacroOpcode_IfKeyPendingAt,
+        MacroOpcode_IfNotAlt,
+        MacroOpcode_IfNotAnyMod,
+        MacroOpcode_IfNotCtrl,
+        MacroOpcode_IfNotDoubletap,
+        MacroOpcode_IfNotGesture,
+        MacroOpcode_IfNotGui,
+        MacroOpcode_IfNotInterrupted,
+        MacroOpcode_IfNotKeyActive,
+        MacroOpcode_IfNotKeyDefined,
+        MacroOpcode_IfNotKeyPendingAt,
+        MacroOpcode_IfNotPending,
+        MacroOpcode_IfNotPendingKeyReleased,
+        MacroOpcode_IfNotPlaytime,
+        MacroOpcode_IfNotRecording,
+        MacroOpcode_IfNotRecordingId,
+        MacroOpcode_IfNotRegEq,
+        MacroOpcode_IfNotReleased,
+        MacroOpcode_IfNotShift,
+        MacroOpcode_IfNotShortcut,
+        MacroOpcode_IfPending,
+        MacroOpcode_IfPendingKeyReleased,
+        MacroOpcode_IfPlaytime,
+        MacroOpcode_IfPrimary,
+        MacroOpcode_IfRecording,
+        MacroOpcode_IfRecordingId,
+        MacroOpcode_IfRegEq,
+        MacroOpcode_IfReleased,
+        MacroOpcode_IfSecondary,
+        MacroOpcode_IfShift,
+        MacroOpcode_IfShortcut,
+        MacroOpcode_MulReg,
+        MacroOpcode_NoOp,
+        MacroOpcode_PlayMacro,
+        MacroOpcode_PostponeKeys,
+        MacroOpcode_PostponeNext,
+        MacroOpcode_PressKey,
+        MacroOpcode_PrintStatus,
+        MacroOpcode_RecordMacro,
+        MacroOpcode_RecordMacroBlind,
+        MacroOpcode_RecordMacroDelay,
+        MacroOpcode_ReleaseKey,
+        MacroOpcode_RepeatFor,
+        MacroOpcode_ResolveNextKeyEq,
+        MacroOpcode_ResolveNextKeyId,
+        MacroOpcode_ResolveSecondary,
+        MacroOpcode_Set,
+        MacroOpcode_SetLedTxt,
+        MacroOpcode_SetReg,
+        MacroOpcode_SetStatus,
+        MacroOpcode_SetStatusPart,
+        MacroOpcode_StartMouse,
+        MacroOpcode_StartRecording,
+        MacroOpcode_StartRecordingBlind,
+        MacroOpcode_StatsActiveKeys,
+        MacroOpcode_StatsActiveMacros,
+        MacroOpcode_StatsLayerStack,
+        MacroOpcode_StatsPostponerStack,
+        MacroOpcode_StatsRegs,
+        MacroOpcode_StatsRuntime,
+        MacroOpcode_StopAllMacros,
+        MacroOpcode_StopMouse,
+        MacroOpcode_StopRecording,
+        MacroOpcode_StopRecordingBlind,
+        MacroOpcode_SubReg,
+        MacroOpcode_SuppressMods,
+        MacroOpcode_SwitchKeymap,
+        MacroOpcode_SwitchKeymapLayer,
+        MacroOpcode_SwitchLayer,
+        MacroOpcode_TapKey,
+        MacroOpcode_TapKeySeq,
+        MacroOpcode_ToggleKeymapLayer,
+        MacroOpcode_ToggleLayer,
+        MacroOpcode_UnToggleLayer,
+        MacroOpcode_Write,
+        MacroOpcode_WriteExpr,
+        MacroOpcode_Count
+    } macro_opcode_t;
+
+    typedef struct {
+        const char *name;
+        bool isPrefix; // condition or modifier which is followed by another command on the same line
+        uint8_t argCount; // number of arguments consumed by a prefix before the next command token
+    } macro_opcode_info_t;
+
+    // The first operands of a command are kept in a pre-parsed form, if they are
+    // integer literals.
+    typedef struct {
+        uint16_t offset; // offset of the command token within ValidatedUserConfigBuffer
+        uint8_t opcode;
+        uint8_t resolvedOperands; // bitmask of operands whose value is known
+        uint8_t operandOffsets[MACRO_BYTECODE_MAX_OPERANDS]; // relative to the command token, 0 if there is none
+        int32_t operands[MACRO_BYTECODE_MAX_OPERANDS];
+    } ATTR_PACKED macro_instruction_t;
+
+    typedef struct {
+        uint16_t nameOffset; // offset of the label name within ValidatedUserConfigBuffer
+        uint8_t nameLen;
+        uint8_t actionIndex;
+    } ATTR_PACKED macro_label_t;
+
+    typedef struct {
+        uint16_t firstActionOffset; // index into the action offset arena
+        uint16_t firstInstruction;
+        uint8_t firstLabel;
+        uint8_t labelCount;
+        bool actionsIndexed : 1;
+        bool labelsIndexed : 1;
+    } macro_index_t;
+
+// Variables:
+
+    extern const macro_opcode_info_t MacroOpcodeInfo[MacroOpcode_Count];
+
+// Functions:
+
+    macro_opcode_t MacroBytecode_Decode(const char *cmd, const char *cmdEnd);
+    macro_opcode_t MacroBytecode_Fetch(const char *cmd, const char *cmdEnd, const macro_instruction_t **instruction);
+    bool MacroBytecode_FetchOperand(const macro_instruction_t *instruction, const char *arg, int32_t *value);
+    void MacroBytecode_Reset(void);
+    void MacroBytecode_BeginMacro(uint8_t macroIdx);
+    void MacroBytecode_CompileAction(uint8_t macroIdx, uint8_t actionIdx, uint16_t offset, const macro_action_t *action);
+    void MacroBytecode_EndMacro(uint8_t macroIdx);
+    bool MacroBytecode_FindActionOffset(uint8_t macroIdx, uint8_t actionIdx, uint16_t *offset);
+    bool MacroBytecode_FindLabel(uint8_t macroIdx, uint8_t currentAdr, const char *label, const char *labelEnd, uint8_t *address);
+    bool MacroBytecode_ActionLabel(const macro_action_t *action, const char **label, const char **labelEnd);
+
+#endif
@@ -5,38 +5,140 @@
 #include "keymap.h"
 #include "led_display.h"
 #include "debug.h"
+#include "utils.h"
 
 /**
+ * Event macros are recognized by their names when a configuration is applied.
+ * Each one is resolved into an (event type, argument) pair and stored in a
+ * table sorted by these pairs, so that firing an event is a binary search
+ * instead of rereading the names of all macros. Callers of the frequent events
+ * check the *Registered flags first, so these cost nothing unless some macro
+ * listens to them.
+ *
  * Future possible extensions:
  * - generalize change to always handle "in" and "out" events
- * - add onKeymapLayerChange, onKeymapKeyPress, onKeyPress, onLayerChange events. These would be indexed when keymap is changed and kept at hand, so we could run them without any performance impact.
+ * - add onKeymapLayerChange and onKeymapKeyPress events.
  */
 
-void MacroEvent_OnInit()
+bool MacroEvent_LayerChangeRegistered = false;
+bool MacroEvent_KeyPressRegistered = false;
+
+static macro_event_t events[MACRO_EVENT_MAX_COUNT];
+static uint8_t eventCount = 0;
+
+static bool parseLayerArgument(const char* arg, const char* argEnd, uint16_t* layer)
 {
-    const char* s = "$onInit";
-    uint8_t idx = FindMacroIndexByName(s, s + strlen(s), false);
-    if (idx != 255) {
-        Macros_StartMacro(idx, NULL, 255);
+    static const char* const layerNames[LayerId_Count] = {
+        [LayerId_Base] = "base",
+        [LayerId_Mod] = "mod",
+        [LayerId_Fn] = "fn",
+        [LayerId_Mouse] = "mouse",
+    };
+    for (uint8_t i = 0; i < LayerId_Count; i++) {
+        if (TokenMatches(arg, argEnd, layerNames[i])) {
+            *layer = i;
+            return true;
+        }
     }
+    return false;
 }
 
-void MacroEvent_OnKeymapChange(uint8_t keymapIdx)
+static bool parseEvent(const char* name, const char* nameEnd, macro_event_t* event)
 {
-    keymap_reference_t *keymap = AllKeymaps + keymapIdx;
-    const char* curAbbrev = keymap->abbreviation;
-    const char* curAbbrevEnd = keymap->abbreviation + keymap->abbreviationLen;
+    const char* arg = NextTok(name, nameEnd);
+    const char* argEnd = TokEnd(arg, nameEnd);
+    event->argument = 0;
 
-    for (int i = 0; i < AllMacrosCount; i++) {
-        const char *thisName, *thisNameEnd;
-        FindMacroName(&AllMacros[i], &thisName, &thisNameEnd);
+    if (TokenMatches(name, nameEnd, "$onInit")) {
+        event->type = MacroEventType_Init;
+        return true;
+    }
+    else if (TokenMatches(name, nameEnd, "$onKeymapChange")) {
+        event->type = MacroEventType_KeymapChange;
+        event->argument = FindKeymapByAbbreviation(argEnd - arg, arg);
+        return event->argument != 0xFF;
+    }
+    else if (TokenMatches(name, nameEnd, "$onLayerChange")) {
+        event->type = MacroEventType_LayerChange;
+        return parseLayerArgument(arg, argEnd, &event->argument);
+    }
+    else if (TokenMatches(name, nameEnd, "$onKeyPress")) {
+        event->type = MacroEventType_KeyPress;
+        event->argument = ParseInt32(arg, argEnd);
+        return arg != argEnd;
+    }
+    return false;
+}
 
-        if (TokenMatches(thisName, thisNameEnd, "$onKeymapChange")) {
-            const char* macroArg = NextTok(thisName,thisNameEnd);
+static bool eventLess(const macro_event_t* a, uint8_t type, uint16_t argument)
+{
+    return a->type < type || (a->type == type && a->argument < argument);
+}
 
-            if (TokenMatches2(macroArg, thisNameEnd, curAbbrev, curAbbrevEnd)) {
-                Macros_StartMacro(i, NULL, 255);
-            }
+void MacroEvent_RegisterMacros(void)
+{
+    eventCount = 0;
+    for (uint8_t i = 0; i < AllMacrosCount; i++) {
+        const char *name, *nameEnd;
+        FindMacroName(&AllMacros[i], &name, &nameEnd);
+        macro_event_t event = { .macroIndex = i };
+        if (name == nameEnd || *name != '$' || !parseEvent(name, nameEnd, &event)) {
+            continue;
+        }
+        if (eventCount == MACRO_EVENT_MAX_COUNT) {
+            Macros_ReportWarning("Too many event macros, ignoring", name, nameEnd);
+            continue;
+        }
+        // insertion sort keeps macros of the same event in their config order
+        uint8_t pos = eventCount++;
+        while (pos > 0 && eventLess(&event, events[pos-1].type, events[pos-1].argument)) {
+            events[pos] = events[pos-1];
+            pos--;
         }
+        events[pos] = event;
     }
+
+    MacroEvent_LayerChangeRegistered = false;
+    MacroEvent_KeyPressRegistered = false;
+    for (uint8_t i = 0; i < eventCount; i++) {
+        MacroEvent_LayerChangeRegistered |= events[i].type == MacroEventType_LayerChange;
+        MacroEvent_KeyPressRegistered |= events[i].type == MacroEventType_KeyPress;
+    }
+}
+
+static void fireEvent(uint8_t type, uint16_t argument)
+{
+    uint8_t begin = 0;
+    uint8_t end = eventCount;
+    while (begin < end) {
+        uint8_t pivot = begin + (end - begin) / 2;
+        if (eventLess(&events[pivot], type, argument)) {
+            begin = pivot + 1;
+        } else {
+            end = pivot;
+        }
+    }
+    for (; begin < eventCount && events[begin].type == type && events[begin].argument == argument; begin++) {
+        Macros_StartMacro(events[begin].macroIndex, NULL, 255);
+    }
+}
+
+void MacroEvent_OnInit()
+{
+    fireEvent(MacroEventType_Init, 0);
+}
+
+void MacroEvent_OnKeymapChange(uint8_t keymapIdx)
+{
+    fireEvent(MacroEventType_KeymapChange, keymapIdx);
+}
+
+void MacroEvent_OnLayerChange(layer_id_t layer)
+{
+    fireEvent(MacroEventType_LayerChange, layer);
+}
+
+void MacroEvent_OnKeyPress(key_state_t *keyState)
+{
+    fireEvent(MacroEventType_KeyPress, Utils_KeyStateToKeyId(keyState));
 }
@@ -12,15 +12,35 @@
 
 // Macros:
 
+    #define MACRO_EVENT_MAX_COUNT 32
 
 // Typedefs:
 
+    typedef enum {
+        MacroEventType_Init,
+        MacroEventType_KeymapChange,
+        MacroEventType_LayerChange,
+        MacroEventType_KeyPress,
+        MacroEventType_Count
+    } macro_event_type_t;
+
+    typedef struct {
+        uint8_t type;
+        uint8_t macroIndex;
+        uint16_t argument; // keymap index, layer id or key id, depending on type
+    } macro_event_t;
+
 // Variables:
 
+    extern bool MacroEvent_LayerChangeRegistered;
+    extern bool MacroEvent_KeyPressRegistered;
 
 // Functions:
 
+    void MacroEvent_RegisterMacros(void);
     void MacroEvent_OnInit();
     void MacroEvent_OnKeymapChange(uint8_t keymapIdx);
+    void MacroEvent_OnLayerChange(layer_id_t layer);
+    void MacroEvent_OnKeyPress(key_state_t *keyState);
 
 #endif
@@ -154,7 +154,7 @@ static void playReport(usb_basic_keyboard_report_t *report)
         break;
     case BasicKeyboardSimple:
         memset(report, 0, sizeof *report);
-        report->scancodes[0] = readByte();
+        UsbBasicKeyboardAddScancode(report, readByte());
         break;
     case BasicKeyboard:
         memset(report, 0, sizeof *report);
@@ -162,7 +162,7 @@ static void playReport(usb_basic_keyboard_report_t *report)
             uint8_t size = readByte();
             report->modifiers = readByte();
             for (int i = 0; i < size; i++) {
-                report->scancodes[i] = readByte();
+                UsbBasicKeyboardAddScancode(report, readByte());
             }
         }
         break;
@@ -221,24 +221,26 @@ void MacroRecorder_RecordBasicReport(usb_basic_keyboard_report_t *report)
         discardLastHeaderSlot();
         return;
     }
-    if (report->modifiers == 0 && report->scancodes[0] == 0) {
+    // At most USB_BASIC_KEYBOARD_MAX_KEYS scancodes are recorded per report, which
+    // REPORT_BUFFER_SAFETY_MARGIN accounts for.
+    uint8_t size = UsbBasicKeyboardScancodeCount(report);
+    size = size < USB_BASIC_KEYBOARD_MAX_KEYS ? size : USB_BASIC_KEYBOARD_MAX_KEYS;
+    uint8_t scancode = UsbBasicKeyboardNextScancode(report, 0);
+    if (report->modifiers == 0 && size == 0) {
         writeByte(BasicKeyboardEmpty);
         return;
     }
-    if (report->modifiers == 0 && report->scancodes[1] == 0) {
+    if (report->modifiers == 0 && size == 1) {
         writeByte(BasicKeyboardSimple);
-        writeByte(report->scancodes[0]);
+        writeByte(scancode);
         return;
     }
     writeByte(BasicKeyboard);
-    uint8_t size = 0;
-    while( size < USB_BASIC_KEYBOARD_MAX_KEYS && report->scancodes[size] != 0) {
-        size++;
-    }
     writeByte(size);
     writeByte(report->modifiers);
     for (int i = 0; i < size; i++) {
-        writeByte(report->scancodes[i]);
+        writeByte(scancode);
+        scancode = UsbBasicKeyboardNextScancode(report, scancode);
     }
 }
 
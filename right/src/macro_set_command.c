@@ -12,6 +12,8 @@
 #include "layer_switcher.h"
 #include "mouse_controller.h"
 #include "debug.h"
+#include "combos.h"
+#include "slave_scheduler.h"
 
 
 static const char* proceedByDot(const char* cmd, const char *cmdEnd)
@@ -93,6 +95,33 @@ static void secondaryRoles(const char* arg1, const char *textEnd)
     //Todo when they are merged
 }
 
+static void macroEngine(const char* arg1, const char *textEnd)
+{
+    const char* arg2 = NextTok(arg1, textEnd);
+
+    if (TokenMatches(arg1, textEnd, "actionBudget")) {
+        MacroActionBudget = Macros_ParseInt(arg2, textEnd, NULL);
+    }
+    else if (TokenMatches(arg1, textEnd, "cycleBudget")) {
+        MacroCycleBudget = Macros_ParseInt(arg2, textEnd, NULL);
+    }
+    else {
+        Macros_ReportError("parameter not recognized:", arg1, textEnd);
+    }
+}
+
+static void i2cScheduler(const char* arg1, const char *textEnd)
+{
+    const char* arg2 = NextTok(arg1, textEnd);
+
+    if (TokenMatches(arg1, textEnd, "keySlaveWeight")) {
+        I2cSlaveScheduler_KeySlaveWeight = Macros_ParseInt(arg2, textEnd, NULL);
+    }
+    else {
+        Macros_ReportError("parameter not recognized:", arg1, textEnd);
+    }
+}
+
 static void mouseKeys(const char* arg1, const char *textEnd)
 {
     mouse_kinetic_state_t* state = &MouseMoveState;
@@ -147,6 +176,29 @@ static void stickyMods(const char* arg1, const char *textEnd)
     }
 }
 
+static void combo(const char* arg1, const char *textEnd)
+{
+    key_state_t* output = Utils_KeyIdToKeyState(Macros_ParseInt(arg1, textEnd, NULL));
+    const char* arg2 = NextTok(arg1, textEnd);
+    uint16_t timeout = Macros_ParseInt(arg2, textEnd, NULL);
+
+    key_state_t* keys[COMBO_MAX_KEY_COUNT];
+    uint8_t keyCount = 0;
+    for (const char* arg = NextTok(arg2, textEnd); arg < textEnd; arg = NextTok(arg, textEnd)) {
+        if (keyCount == COMBO_MAX_KEY_COUNT) {
+            Macros_ReportErrorNum("too many combo keys, maximum is", COMBO_MAX_KEY_COUNT);
+            return;
+        }
+        keys[keyCount++] = Utils_KeyIdToKeyState(Macros_ParseInt(arg, textEnd, NULL));
+    }
+
+    if (keyCount == 0) {
+        Combos_Remove(output);
+    } else if (!Combos_Define(output, timeout, keys, keyCount)) {
+        Macros_ReportErrorNum("invalid combo, or too many combos; maximum is", COMBO_MAX_COUNT);
+    }
+}
+
 bool MacroSetCommand(const char* arg1, const char *textEnd)
 {
     const char* arg2 = NextTok(arg1, textEnd);
@@ -160,6 +212,12 @@ bool MacroSetCommand(const char* arg1, const char *textEnd)
     else if (TokenMatches(arg1, textEnd, "mouseKeys")) {
         mouseKeys(proceedByDot(arg1, textEnd), textEnd);
     }
+    else if (TokenMatches(arg1, textEnd, "macroEngine")) {
+        macroEngine(proceedByDot(arg1, textEnd), textEnd);
+    }
+    else if (TokenMatches(arg1, textEnd, "i2cScheduler")) {
+        i2cScheduler(proceedByDot(arg1, textEnd), textEnd);
+    }
     else if (TokenMatches(arg1, textEnd, "compensateDiagonalSpeed")) {
         CompensateDiagonalSpeed = Macros_ParseInt(arg2, textEnd, NULL);
     }
@@ -172,9 +230,15 @@ bool MacroSetCommand(const char* arg1, const char *textEnd)
         DebounceTimePress = time;
         DebounceTimeRelease = time;
     }
+    else if (TokenMatches(arg1, textEnd, "eagerKeyPresses")) {
+        EagerKeyPresses = Macros_ParseInt(arg2, textEnd, NULL);
+    }
     else if (TokenMatches(arg1, textEnd, "keystrokeDelay")) {
         KeystrokeDelay = Macros_ParseInt(arg2, textEnd, NULL);
     }
+    else if (TokenMatches(arg1, textEnd, "combo")) {
+        combo(arg2, textEnd);
+    }
     else if (TokenMatches(arg1, textEnd, "chording")) {
         Chording = Macros_ParseInt(arg2, textEnd, NULL);
     }
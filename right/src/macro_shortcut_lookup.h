@@ -0,0 +1,21 @@
+// Please do not edit this file by hand!
+// It is to be regenerated by /scripts/generate-shortcut-lookup.js
+
+#ifndef __MACRO_SHORTCUT_LOOKUP_H__
+#define __MACRO_SHORTCUT_LOOKUP_H__
+
+// Includes:
+
+    #include "macro_shortcut_parser.h"
+
+// Macros:
+
+    #define SHORTCUT_LOOKUP_BUCKET_COUNT 55
+    #define SHORTCUT_LOOKUP_TABLE_SIZE 243
+
+// Variables:
+
+    extern const uint8_t ShortcutLookupSeeds[SHORTCUT_LOOKUP_BUCKET_COUNT];
+    extern const lookup_record_t ShortcutLookupTable[SHORTCUT_LOOKUP_TABLE_SIZE];
+
+#endif
@@ -25,8 +25,6 @@
 
     // Functions:
 
-    void ShortcutParser_initialize();
-
     macro_action_t MacroShortcutParser_Parse(const char* str, const char* strEnd, macro_sub_action_t type);
     uint8_t MacroShortcutParser_CharacterToScancode(char character);
     bool MacroShortcutParser_CharacterToShift(char character);
@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include "macros.h"
 #include "config_parser/parse_macro.h"
 #include "config_parser/config_globals.h"
@@ -15,6 +16,8 @@
 #include "mouse_controller.h"
 #include "debug.h"
 #include "macro_set_command.h"
+#include "macro_bytecode.h"
+#include "status_buffer.h"
 
 macro_reference_t AllMacros[MAX_MACRO_NUM];
 uint8_t AllMacrosCount;
@@ -27,10 +30,6 @@ uint8_t MacroSystemScancodeIndex = 0;
 layer_id_t Macros_ActiveLayer = LayerId_Base;
 bool Macros_ActiveLayerHeld = false;
 
-static char statusBuffer[STATUS_BUFFER_MAX_LENGTH];
-static uint16_t statusBufferLen;
-static bool statusBufferPrinting;
-
 static layerStackRecord layerIdxStack[LAYER_STACK_SIZE];
 static uint8_t layerIdxStackTop;
 static uint8_t layerIdxStackSize;
@@ -43,8 +42,24 @@ static int32_t regs[MAX_REG_COUNT];
 static bool initialized = false;
 
 macro_state_t MacroState[MACRO_STATE_POOL_SIZE];
+macro_reports_t MacroReports[MACRO_REPORT_POOL_SIZE];
+uint32_t MacroActiveSlots = 0; // slots that are playing or still hold a report to be flushed
+uint32_t MacroUsedReports = 0;
 static macro_state_t *s = MacroState;
 
+static uint8_t slotHighWaterMark = 0;
+static uint8_t reportHighWaterMark = 0;
+static bool reportPoolExhausted = false;
+
+uint16_t MacroActionBudget = MACRO_DEFAULT_ACTION_BUDGET;
+uint16_t MacroCycleBudget = MACRO_DEFAULT_CYCLE_BUDGET;
+static bool actionYielded = false;
+static bool inputPolled = false;
+static const macro_instruction_t *currentInstruction = NULL;
+static uint32_t actionBudgetOverruns = 0;
+static uint32_t cycleBudgetOverruns = 0;
+static uint32_t longestMacroPass = 0;
+
 
 static uint16_t doubletapConditionTimeout = 300;
 
@@ -56,12 +71,67 @@ static bool continueMacro(void);
 static bool execMacro(uint8_t macroIndex);
 static bool callMacro(uint8_t macroIndex);
 
+/**
+ * Returns the first active slot whose index is at least `from`. Slots are
+ * visited in the index order, which macro calls rely on.
+ */
+static uint8_t nextActiveSlot(uint8_t from)
+{
+    uint32_t slots = from < MACRO_STATE_POOL_SIZE ? MacroActiveSlots >> from : 0;
+    return slots ? from + __builtin_ctz(slots) : MACRO_STATE_POOL_SIZE;
+}
+
+static bool areReportsEmpty(const macro_reports_t *reports)
+{
+    static const macro_reports_t emptyReports;
+    return memcmp(reports, &emptyReports, offsetof(macro_reports_t, ownerSlot)) == 0;
+}
+
+/**
+ * Every macro emits into its own buffer, so that a called macro can't clear
+ * the keys which its caller holds. Callers can't starve their callees of
+ * buffers though: a caller which holds nothing returns its buffer while it
+ * sleeps, and the last free buffer is reserved for called macros.
+ */
 bool Macros_ClaimReports()
 {
-    s->ms.reportsUsed = true;
+    actionYielded = true;
+    if (s->ms.reports != NULL) {
+        return true;
+    }
+    uint32_t freeReports = ~MacroUsedReports & ((1UL << MACRO_REPORT_POOL_SIZE) - 1);
+    bool isCalled = s->ms.parentMacroSlot != 255;
+    if (freeReports == 0 || (!isCalled && __builtin_popcount(freeReports) == 1)) {
+        //wait until some other macro finishes
+        if (!reportPoolExhausted) {
+            reportPoolExhausted = true;
+            Macros_ReportWarning("Macro report pool exhausted, waiting for a free buffer", NULL, NULL);
+        }
+        return false;
+    }
+    reportPoolExhausted = false;
+    uint8_t reportIdx = __builtin_ctz(freeReports);
+    MacroUsedReports |= 1UL << reportIdx;
+    s->ms.reports = &MacroReports[reportIdx];
+    memset(s->ms.reports, 0, sizeof *s->ms.reports);
+    s->ms.reports->ownerSlot = s - MacroState;
+
+    uint8_t usedCount = __builtin_popcount(MacroUsedReports);
+    reportHighWaterMark = usedCount > reportHighWaterMark ? usedCount : reportHighWaterMark;
     return true;
 }
 
+void Macros_ReleaseReports(macro_state_t *state)
+{
+    if (state->ms.reports != NULL) {
+        MacroUsedReports &= ~(1UL << (state->ms.reports - MacroReports));
+        state->ms.reports = NULL;
+    }
+    if (!state->ms.macroPlaying) {
+        MacroActiveSlots &= ~(1UL << (state - MacroState));
+    }
+}
+
 /**
  * This ensures integration/interface between macro layer mechanism
  * and official layer mechanism - we expose our layer via
@@ -77,7 +147,7 @@ static void activateLayer(layer_id_t layer)
 
 void Macros_SignalInterrupt()
 {
-    for (uint8_t i = 0; i < MACRO_STATE_POOL_SIZE; i++) {
+    for (uint8_t i = nextActiveSlot(0); i < MACRO_STATE_POOL_SIZE; i = nextActiveSlot(i + 1)) {
         if (MacroState[i].ms.macroPlaying) {
             MacroState[i].ms.macroInterrupted = true;
         }
@@ -86,43 +156,22 @@ void Macros_SignalInterrupt()
 
 static void addBasicScancode(uint8_t scancode)
 {
-    if (!scancode) {
-        return;
-    }
-    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
-        if (s->ms.macroBasicKeyboardReport.scancodes[i] == scancode) {
-            return;
-        }
-    }
-    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
-        if (!s->ms.macroBasicKeyboardReport.scancodes[i]) {
-            s->ms.macroBasicKeyboardReport.scancodes[i] = scancode;
-            break;
-        }
-    }
+    UsbBasicKeyboardAddScancode(&s->ms.reports->basicKeyboardReport, scancode);
 }
 
 static void deleteBasicScancode(uint8_t scancode)
 {
-    if (!scancode) {
-        return;
-    }
-    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
-        if (s->ms.macroBasicKeyboardReport.scancodes[i] == scancode) {
-            s->ms.macroBasicKeyboardReport.scancodes[i] = 0;
-            return;
-        }
-    }
+    UsbBasicKeyboardRemoveScancode(&s->ms.reports->basicKeyboardReport, scancode);
 }
 
 static void addModifiers(uint8_t modifiers)
 {
-    s->ms.macroBasicKeyboardReport.modifiers |= modifiers;
+    s->ms.reports->basicKeyboardReport.modifiers |= modifiers;
 }
 
 static void deleteModifiers(uint8_t modifiers)
 {
-    s->ms.macroBasicKeyboardReport.modifiers &= ~modifiers;
+    s->ms.reports->basicKeyboardReport.modifiers &= ~modifiers;
 }
 
 static void addMediaScancode(uint16_t scancode)
@@ -131,13 +180,13 @@ static void addMediaScancode(uint16_t scancode)
         return;
     }
     for (uint8_t i = 0; i < USB_MEDIA_KEYBOARD_MAX_KEYS; i++) {
-        if (s->ms.macroMediaKeyboardReport.scancodes[i] == scancode) {
+        if (s->ms.reports->mediaKeyboardReport.scancodes[i] == scancode) {
             return;
         }
     }
     for (uint8_t i = 0; i < USB_MEDIA_KEYBOARD_MAX_KEYS; i++) {
-        if (!s->ms.macroMediaKeyboardReport.scancodes[i]) {
-            s->ms.macroMediaKeyboardReport.scancodes[i] = scancode;
+        if (!s->ms.reports->mediaKeyboardReport.scancodes[i]) {
+            s->ms.reports->mediaKeyboardReport.scancodes[i] = scancode;
             break;
         }
     }
@@ -149,8 +198,8 @@ static void deleteMediaScancode(uint16_t scancode)
         return;
     }
     for (uint8_t i = 0; i < USB_MEDIA_KEYBOARD_MAX_KEYS; i++) {
-        if (s->ms.macroMediaKeyboardReport.scancodes[i] == scancode) {
-            s->ms.macroMediaKeyboardReport.scancodes[i] = 0;
+        if (s->ms.reports->mediaKeyboardReport.scancodes[i] == scancode) {
+            s->ms.reports->mediaKeyboardReport.scancodes[i] = 0;
             return;
         }
     }
@@ -162,13 +211,13 @@ static void addSystemScancode(uint8_t scancode)
         return;
     }
     for (uint8_t i = 0; i < USB_SYSTEM_KEYBOARD_MAX_KEYS; i++) {
-        if (s->ms.macroSystemKeyboardReport.scancodes[i] == scancode) {
+        if (s->ms.reports->systemKeyboardReport.scancodes[i] == scancode) {
             return;
         }
     }
     for (uint8_t i = 0; i < USB_SYSTEM_KEYBOARD_MAX_KEYS; i++) {
-        if (!s->ms.macroSystemKeyboardReport.scancodes[i]) {
-            s->ms.macroSystemKeyboardReport.scancodes[i] = scancode;
+        if (!s->ms.reports->systemKeyboardReport.scancodes[i]) {
+            s->ms.reports->systemKeyboardReport.scancodes[i] = scancode;
             break;
         }
     }
@@ -180,8 +229,8 @@ static void deleteSystemScancode(uint8_t scancode)
         return;
     }
     for (uint8_t i = 0; i < USB_SYSTEM_KEYBOARD_MAX_KEYS; i++) {
-        if (s->ms.macroSystemKeyboardReport.scancodes[i] == scancode) {
-            s->ms.macroSystemKeyboardReport.scancodes[i] = 0;
+        if (s->ms.reports->systemKeyboardReport.scancodes[i] == scancode) {
+            s->ms.reports->systemKeyboardReport.scancodes[i] = 0;
             return;
         }
     }
@@ -238,6 +287,7 @@ static bool processDelayAction()
 
 static void postponeNextN(uint8_t count)
 {
+    actionYielded = true;
     s->ms.postponeNextNCommands = count + 1;
     s->as.weInitiatedPostponing = true;
     PostponerCore_PostponeNCycles(MACRO_CYCLES_TO_POSTPONE);
@@ -245,6 +295,7 @@ static void postponeNextN(uint8_t count)
 
 static void postponeCurrentCycle()
 {
+    actionYielded = true;
     PostponerCore_PostponeNCycles(MACRO_CYCLES_TO_POSTPONE);
     s->as.weInitiatedPostponing = true;
 }
@@ -357,25 +408,25 @@ static bool processMouseButton(macro_action_t macro_action)
         case MacroSubAction_Tap:
             switch(s->as.actionPhase) {
             case 1:
-                s->ms.macroMouseReport.buttons |= mouseButtonMask;
+                s->ms.reports->mouseReport.buttons |= mouseButtonMask;
                 return true;
             case 2:
                 if (currentMacroKeyIsActive() && action == MacroSubAction_Hold) {
                     s->as.actionPhase--;
                     return true;
                 }
-                s->ms.macroMouseReport.buttons &= ~mouseButtonMask;
+                s->ms.reports->mouseReport.buttons &= ~mouseButtonMask;
                 s->as.actionPhase = 0;
                 break;
 
             }
             break;
         case MacroSubAction_Release:
-            s->ms.macroMouseReport.buttons &= ~mouseButtonMask;
+            s->ms.reports->mouseReport.buttons &= ~mouseButtonMask;
             s->as.actionPhase = 0;
             break;
         case MacroSubAction_Press:
-            s->ms.macroMouseReport.buttons |= mouseButtonMask;
+            s->ms.reports->mouseReport.buttons |= mouseButtonMask;
             s->as.actionPhase = 0;
             break;
     }
@@ -393,12 +444,12 @@ static bool processMoveMouseAction(void)
         return true;
     }
     if (s->as.actionActive) {
-        s->ms.macroMouseReport.x = 0;
-        s->ms.macroMouseReport.y = 0;
+        s->ms.reports->mouseReport.x = 0;
+        s->ms.reports->mouseReport.y = 0;
         s->as.actionActive = false;
     } else {
-        s->ms.macroMouseReport.x = s->ms.currentMacroAction.moveMouse.x;
-        s->ms.macroMouseReport.y = s->ms.currentMacroAction.moveMouse.y;
+        s->ms.reports->mouseReport.x = s->ms.currentMacroAction.moveMouse.x;
+        s->ms.reports->mouseReport.y = s->ms.currentMacroAction.moveMouse.y;
         s->as.actionActive = true;
     }
     return s->as.actionActive;
@@ -410,12 +461,12 @@ static bool processScrollMouseAction(void)
         return true;
     }
     if (s->as.actionActive) {
-        s->ms.macroMouseReport.wheelX = 0;
-        s->ms.macroMouseReport.wheelY = 0;
+        s->ms.reports->mouseReport.wheelX = 0;
+        s->ms.reports->mouseReport.wheelY = 0;
         s->as.actionActive = false;
     } else {
-        s->ms.macroMouseReport.wheelX = s->ms.currentMacroAction.scrollMouse.x;
-        s->ms.macroMouseReport.wheelY = s->ms.currentMacroAction.scrollMouse.y;
+        s->ms.reports->mouseReport.wheelX = s->ms.currentMacroAction.scrollMouse.x;
+        s->ms.reports->mouseReport.wheelY = s->ms.currentMacroAction.scrollMouse.y;
         s->as.actionActive = true;
     }
     return s->as.actionActive;
@@ -423,25 +474,21 @@ static bool processScrollMouseAction(void)
 
 static bool processClearStatusCommand()
 {
-    statusBufferLen = 0;
+    StatusBuffer_Clear();
     return false;
 }
 
 //textEnd is allowed to be null if text is null-terminated
 static void setStatusStringInterpolated(const char* text, const char *textEnd, bool interpolated)
 {
-    if (statusBufferPrinting) {
-        return;
-    }
-    while(*text && statusBufferLen < STATUS_BUFFER_MAX_LENGTH && (text < textEnd || textEnd == NULL)) {
+    while(*text && (text < textEnd || textEnd == NULL)) {
         if (*text == '#' && interpolated) {
             int32_t parsed = Macros_ParseInt(text, textEnd, &text);
             //text should be now set to next character after a number, even if it was e.g., "'#3'"
             Macros_SetStatusNumSpaced(parsed, false);
         } else {
-            statusBuffer[statusBufferLen] = *text;
+            StatusBuffer_Append(*text);
             text++;
-            statusBufferLen++;
         }
     }
 }
@@ -504,6 +551,7 @@ static void reportErrorHeader()
 void Macros_ReportError(const char* err, const char* arg, const char *argEnd)
 {
     LedDisplay_SetText(3, "ERR");
+    StatusBuffer_BeginEntry(StatusSeverity_Error);
     reportErrorHeader();
     Macros_SetStatusString(err, NULL);
     if (arg != NULL) {
@@ -513,22 +561,46 @@ void Macros_ReportError(const char* err, const char* arg, const char *argEnd)
     Macros_SetStatusString("\n", NULL);
 }
 
+void Macros_ReportWarning(const char* warn, const char* arg, const char *argEnd)
+{
+    StatusBuffer_BeginEntry(StatusSeverity_Warning);
+    reportErrorHeader();
+    Macros_SetStatusString(warn, NULL);
+    if (arg != NULL) {
+        Macros_SetStatusString(": ", NULL);
+        Macros_SetStatusString(arg, argEnd);
+    }
+    Macros_SetStatusString("\n", NULL);
+}
+
 void Macros_ReportErrorNum(const char* err, uint32_t num)
 {
     LedDisplay_SetText(3, "ERR");
+    StatusBuffer_BeginEntry(StatusSeverity_Error);
     reportErrorHeader();
     Macros_SetStatusString(err, NULL);
     Macros_SetStatusNum(num);
     Macros_SetStatusString("\n", NULL);
 }
 
-static void clearScancodes()
+static uint8_t characterToMods(char character)
 {
-    uint8_t oldMods = s->ms.macroBasicKeyboardReport.modifiers;
-    memset(&s->ms.macroBasicKeyboardReport, 0, sizeof s->ms.macroBasicKeyboardReport);
-    s->ms.macroBasicKeyboardReport.modifiers = oldMods;
+    return MacroShortcutParser_CharacterToShift(character) ? HID_KEYBOARD_MODIFIER_LEFTSHIFT : 0;
 }
 
+/**
+ * Each call plans one report, which adds at most one new key. The key of the
+ * previous character is released in the same report in which the next one is
+ * pressed, so the host never sees more than one new key at a time and can't
+ * reorder them. Only if the next character needs other modifiers or the same
+ * key, a releasing report (which also switches modifiers) is sent in between.
+ * Report pace is given by KeystrokeDelay of the report updater.
+ *
+ * Filling the 6KRO report with a run of new keys is deliberately not done:
+ * keys which go down in the same report carry no order, and hosts handle them
+ * in array or usage order (the NKRO bitfield has no other), so "ba" could be
+ * typed as "ab". See traces/text.trace for the resulting rate.
+ */
 static bool dispatchText(const char* text, uint16_t textLen)
 {
     if (!Macros_ClaimReports()) {
@@ -540,62 +612,37 @@ static bool dispatchText(const char* text, uint16_t textLen)
     } else {
         dispatchMutex = s;
     }
-    uint8_t max_keys = USB_BASIC_KEYBOARD_MAX_KEYS/2;
-    char character = 0;
-    uint8_t scancode = 0;
-    uint8_t mods = 0;
-
-    // Precompute modifiers and scancode.
-    if (s->as.dispatchData.textIdx != textLen) {
-        character = text[s->as.dispatchData.textIdx];
-        scancode = MacroShortcutParser_CharacterToScancode(character);
-        mods = MacroShortcutParser_CharacterToShift(character) ? HID_KEYBOARD_MODIFIER_LEFTSHIFT : 0;
-    }
-
-    // If required modifiers differ, first clear scancodes and send empty report
-    // containing only old modifiers. Then set new modifiers and send that new report.
-    // Just then continue.
-    if (mods != s->ms.macroBasicKeyboardReport.modifiers) {
-        if (s->as.dispatchData.reportIdx != 0) {
-            s->as.dispatchData.reportIdx = 0;
-            clearScancodes();
-            return true;
-        } else {
-            s->ms.macroBasicKeyboardReport.modifiers = mods;
-            return true;
-        }
+    usb_basic_keyboard_report_t *report = &s->ms.reports->basicKeyboardReport;
+    uint16_t textIdx = s->as.dispatchData.textIdx;
+
+    // Characters without a scancode cannot be typed, skip them.
+    while (textIdx < textLen && MacroShortcutParser_CharacterToScancode(text[textIdx]) == 0) {
+        textIdx++;
     }
 
-    // If all characters have been sent, finish.
-    if (s->as.dispatchData.textIdx == textLen) {
+    // If all characters have been sent, release everything and finish.
+    if (textIdx >= textLen) {
         s->as.dispatchData.textIdx = 0;
-        s->as.dispatchData.reportIdx = max_keys;
-        memset(&s->ms.macroBasicKeyboardReport, 0, sizeof s->ms.macroBasicKeyboardReport);
+        memset(report, 0, sizeof *report);
         dispatchMutex = NULL;
         return false;
     }
 
-    // Whenever the report is full, we clear the report and send it empty before continuing.
-    if (s->as.dispatchData.reportIdx == max_keys) {
-        s->as.dispatchData.reportIdx = 0;
-
-        memset(&s->ms.macroBasicKeyboardReport, 0, sizeof s->ms.macroBasicKeyboardReport);
+    // If the next character needs different modifiers or the key that is
+    // still held, release the held key and set the new modifiers first.
+    uint8_t mods = characterToMods(text[textIdx]);
+    uint8_t scancode = MacroShortcutParser_CharacterToScancode(text[textIdx]);
+    if (mods != report->modifiers || UsbBasicKeyboardContainsScancode(report, scancode)) {
+        memset(report->bitfield, 0, sizeof report->bitfield);
+        report->modifiers = mods;
+        s->as.dispatchData.textIdx = textIdx;
         return true;
     }
 
-    // If current character is already contained in the report, we need to
-    // release it first. We do so by artificially marking the report
-    // full. Next call will do rest of the work for us.
-    for (uint8_t i = 0; i < s->as.dispatchData.reportIdx; i++) {
-        if (s->ms.macroBasicKeyboardReport.scancodes[i] == scancode) {
-            s->as.dispatchData.reportIdx = max_keys;
-            return true;
-        }
-    }
-
-    // Send the scancode.
-    s->ms.macroBasicKeyboardReport.scancodes[s->as.dispatchData.reportIdx++] = scancode;
-    ++s->as.dispatchData.textIdx;
+    // Release the previous key and press the next one in the same report.
+    memset(report->bitfield, 0, sizeof report->bitfield);
+    UsbBasicKeyboardAddScancode(report, scancode);
+    s->as.dispatchData.textIdx = textIdx + 1;
     return true;
 }
 
@@ -693,38 +740,44 @@ int32_t Macros_ParseInt(const char *a, const char *aEnd, const char* *parsedTill
 
 static int32_t parseNUM(const char *a, const char *aEnd)
 {
+    int32_t value;
+    if (MacroBytecode_FetchOperand(currentInstruction, a, &value)) {
+        return value;
+    }
     return Macros_ParseInt(a, aEnd, NULL);
 }
 
 static uint8_t parseAddress(const char* arg, const char* argEnd)
 {
-    /**
-     * TODO: fix this to work with macro commands instead of text actions
-     * TODO: make this compatible with multilines
-     */
-    if (isNUM(arg, argEnd)) {
+    int32_t resolvedAdr;
+    if (MacroBytecode_FetchOperand(currentInstruction, arg, &resolvedAdr)) {
+        return resolvedAdr;
+    } else if (isNUM(arg, argEnd)) {
         return parseNUM(arg, argEnd);
     } else {
         uint8_t currentAdr = s->ms.currentMacroActionIndex;
+        uint8_t indexedAdr;
+        if (MacroBytecode_FindLabel(s->ms.currentMacroIndex, currentAdr, arg, argEnd, &indexedAdr)) {
+            if (indexedAdr == 255) {
+                Macros_ReportError("label not found", arg, argEnd);
+            }
+            return indexedAdr;
+        }
+        //slow path for macros whose labels didn't fit into the index
         uint8_t actionCount = AllMacros[s->ms.currentMacroIndex].macroActionsCount;
         config_buffer_t buffer = ValidatedUserConfigBuffer;
         buffer.offset = AllMacros[s->ms.currentMacroIndex].firstMacroActionOffset;
         uint8_t firstFoundAdr = 255;
         macro_action_t action;
         for (int i = 0; i < actionCount; i++) {
+            const char* label;
+            const char* labelEnd;
             ParseMacroAction(&buffer, &action);
-            if (action.type == MacroActionType_Text) {
-                const char* cmd = action.text.text;
-                const char* cmdEnd = action.text.text + action.text.textLen;
-                const char* cmdTokEnd = TokEnd(cmd, cmdEnd);
-                if (cmd < cmdEnd && *cmd == '$' && cmdTokEnd[-1] == ':') {
-                    if (TokenMatches2(cmd+1, cmdTokEnd-1, arg, argEnd)) {
-                        firstFoundAdr = firstFoundAdr == 255 ? i : firstFoundAdr;
-                        if (i > currentAdr)
-                        {
-                            return i;
-                        }
-                    }
+            if (MacroBytecode_ActionLabel(&action, &label, &labelEnd) && TokenMatches2(label, labelEnd, arg, argEnd)) {
+                firstFoundAdr = firstFoundAdr == 255 ? i : firstFoundAdr;
+                if (i > currentAdr)
+                {
+                    return i;
                 }
             }
         }
@@ -812,7 +865,7 @@ static bool processStatsActiveKeysCommand()
                 Macros_SetStatusString("/", NULL);
                 Macros_SetStatusNum(keyState->current);
                 Macros_SetStatusString("/", NULL);
-                Macros_SetStatusNum(keyState->debouncing);
+                Macros_SetStatusNum(KeyState_Debouncing(keyState));
                 Macros_SetStatusString("/", NULL);
             }
         }
@@ -829,7 +882,7 @@ static bool processStatsPostponerStackCommand()
 static bool processStatsActiveMacrosCommand()
 {
     Macros_SetStatusString("macro/adr\n", NULL);
-    for (int i = 0; i < MACRO_STATE_POOL_SIZE; i++) {
+    for (uint8_t i = nextActiveSlot(0); i < MACRO_STATE_POOL_SIZE; i = nextActiveSlot(i + 1)) {
         if (MacroState[i].ms.macroPlaying) {
             const char *name, *nameEnd;
             FindMacroName(&AllMacros[MacroState[i].ms.currentMacroIndex], &name, &nameEnd);
@@ -858,7 +911,7 @@ static bool processStatsRegs()
 
 static bool stopAllMacrosCommand()
 {
-    for (uint8_t i = 0; i < MACRO_STATE_POOL_SIZE; i++) {
+    for (uint8_t i = nextActiveSlot(0); i < MACRO_STATE_POOL_SIZE; i = nextActiveSlot(i + 1)) {
         if (&MacroState[i] != s) {
             MacroState[i].ms.macroBroken = true;
         }
@@ -1180,16 +1233,19 @@ static bool processIfDoubletapCommand(bool negate)
 
 static bool processIfModifierCommand(bool negate, uint8_t modmask)
 {
+    inputPolled = true;
     return ((HardwareModifierStatePrevious & modmask) > 0) != negate;
 }
 
 static bool processIfRecordingCommand(bool negate)
 {
+    inputPolled = true;
     return MacroRecorder_IsRecording() != negate;
 }
 
 static bool processIfRecordingIdCommand(bool negate, const char* arg, const char *argEnd)
 {
+    inputPolled = true;
     uint16_t id = parseRuntimeMacroSlotId(arg, argEnd);
     bool res = MacroRecorder_RecordingId() == id;
     return res != negate;
@@ -1197,6 +1253,7 @@ static bool processIfRecordingIdCommand(bool negate, const char* arg, const char
 
 static bool processIfPendingCommand(bool negate, const char* arg, const char *argEnd)
 {
+    inputPolled = true;
     uint32_t cnt = parseNUM(arg, argEnd);
 
     return (PostponerQuery_PendingKeypressCount() >= cnt) != negate;
@@ -1204,6 +1261,7 @@ static bool processIfPendingCommand(bool negate, const char* arg, const char *ar
 
 static bool processIfPlaytimeCommand(bool negate, const char* arg, const char *argEnd)
 {
+    inputPolled = true;
     uint32_t timeout = parseNUM(arg, argEnd);
     uint32_t delay = Timer_GetElapsedTime(&s->ms.currentMacroStartTime);
     return (delay > timeout) != negate;
@@ -1211,11 +1269,13 @@ static bool processIfPlaytimeCommand(bool negate, const char* arg, const char *a
 
 static bool processIfInterruptedCommand(bool negate)
 {
+    inputPolled = true;
    return s->ms.macroInterrupted != negate;
 }
 
 static bool processIfReleasedCommand(bool negate)
 {
+    inputPolled = true;
    return (!currentMacroKeyIsActive()) != negate;
 }
 
@@ -1237,13 +1297,19 @@ static bool processBreakCommand()
     return false;
 }
 
+// The ring may hold the text in two pieces, which are typed one after another.
 static bool processPrintStatusCommand()
 {
-    statusBufferPrinting = true;
-    bool res = dispatchText(statusBuffer, statusBufferLen);
+    const char *text;
+    StatusBuffer_SetPrinting(true);
+    uint16_t textLen = StatusBuffer_ContiguousLength(StatusBuffer_Tail, &text);
+    bool res = dispatchText(text, textLen);
     if (!res) {
-        statusBufferLen = 0;
-        statusBufferPrinting = false;
+        StatusBuffer_Consume(StatusBuffer_Tail + textLen);
+        res = StatusBuffer_Tail != StatusBuffer_Head;
+    }
+    if (!res) {
+        StatusBuffer_SetPrinting(false);
     }
     LedDisplay_UpdateText();
     return res;
@@ -1307,7 +1373,16 @@ static bool processRegMulCommand(const char* arg1, const char *argEnd)
 
 static bool goTo(uint8_t address)
 {
+    uint16_t offset;
+    if (inputPolled && address <= s->ms.currentMacroActionIndex) {
+        //a polling loop, see runMacro
+        actionYielded = true;
+    }
     s->ms.currentMacroActionIndex = address - 1;
+    if (MacroBytecode_FindActionOffset(s->ms.currentMacroIndex, address, &offset)) {
+        s->ms.bufferOffset = offset;
+        return false;
+    }
     ValidatedUserConfigBuffer.offset = AllMacros[s->ms.currentMacroIndex].firstMacroActionOffset;
     for (uint8_t i = 0; i < address; i++) {
         ParseMacroAction(&ValidatedUserConfigBuffer, &s->ms.currentMacroAction);
@@ -1392,7 +1467,10 @@ static bool processStartRecordingCommand(const char* arg, const char *argEnd, bo
 static bool processPlayMacroCommand(const char* arg, const char *argEnd)
 {
     uint16_t id = parseRuntimeMacroSlotId(arg, argEnd);
-    return MacroRecorder_PlayRuntimeMacroSmart(id, &s->ms.macroBasicKeyboardReport);
+    if (!Macros_ClaimReports()) {
+        return true;
+    }
+    return MacroRecorder_PlayRuntimeMacroSmart(id, &s->ms.reports->basicKeyboardReport);
 }
 
 static bool processWriteCommand(const char* arg, const char *argEnd)
@@ -1425,6 +1503,27 @@ static bool processStatsRuntimeCommand()
     Macros_SetStatusString("macro runtime is: ", NULL);
     Macros_SetStatusNum(ms);
     Macros_SetStatusString(" ms\n", NULL);
+    Macros_SetStatusString("macro slots used/peak/max: ", NULL);
+    Macros_SetStatusNum(__builtin_popcount(MacroActiveSlots));
+    Macros_SetStatusString("/", NULL);
+    Macros_SetStatusNum(slotHighWaterMark);
+    Macros_SetStatusString("/", NULL);
+    Macros_SetStatusNum(MACRO_STATE_POOL_SIZE);
+    Macros_SetStatusString("\nreport buffers used/peak/max: ", NULL);
+    Macros_SetStatusNum(__builtin_popcount(MacroUsedReports));
+    Macros_SetStatusString("/", NULL);
+    Macros_SetStatusNum(reportHighWaterMark);
+    Macros_SetStatusString("/", NULL);
+    Macros_SetStatusNum(MACRO_REPORT_POOL_SIZE);
+    Macros_SetStatusString("\nmacro pool ram: ", NULL);
+    Macros_SetStatusNum(sizeof MacroState + sizeof MacroReports);
+    Macros_SetStatusString(" B\nbudget overruns action/cycle: ", NULL);
+    Macros_SetStatusNum(actionBudgetOverruns);
+    Macros_SetStatusString("/", NULL);
+    Macros_SetStatusNum(cycleBudgetOverruns);
+    Macros_SetStatusString("\nlongest macro pass: ", NULL);
+    Macros_SetStatusNum(longestMacroPass);
+    Macros_SetStatusString(" us\n", NULL);
     return false;
 }
 
@@ -1746,6 +1845,7 @@ conditionPassed:
 
 static bool processifKeyPendingAtCommand(bool negate, const char* arg1, const char* argEnd)
 {
+    inputPolled = true;
     const char* arg2 = NextTok(arg1, argEnd);
     uint16_t idx = parseNUM(arg1, argEnd);
     uint16_t key = parseNUM(arg2, argEnd);
@@ -1755,6 +1855,7 @@ static bool processifKeyPendingAtCommand(bool negate, const char* arg1, const ch
 
 static bool processifKeyActiveCommand(bool negate, const char* arg1, const char* argEnd)
 {
+    inputPolled = true;
     uint16_t keyid = parseNUM(arg1, argEnd);
     key_state_t* key = Utils_KeyIdToKeyState(keyid);
     return KeyState_Active(key) != negate;
@@ -1762,6 +1863,7 @@ static bool processifKeyActiveCommand(bool negate, const char* arg1, const char*
 
 static bool processifPendingKeyReleasedCommand(bool negate, const char* arg1, const char* argEnd)
 {
+    inputPolled = true;
     uint16_t idx = parseNUM(arg1, argEnd);
     return PostponerExtended_IsPendingKeyReleased(idx) != negate;
 }
@@ -1849,516 +1951,364 @@ static bool processCommand(const char* cmd, const char* cmdEnd)
     }
     while(*cmd && cmd < cmdEnd) {
         const char* arg1 = NextTok(cmd, cmdEnd);
-        switch(*cmd) {
-        case 'a':
-            if (TokenMatches(cmd, cmdEnd, "addReg")) {
-                return processRegAddCommand(arg1, cmdEnd, false);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "activateKeyPostponed")) {
-                return processActivateKeyPostponedCommand(arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        switch (MacroBytecode_Fetch(cmd, cmdEnd, &currentInstruction)) {
+        case MacroOpcode_AddReg:
+            return processRegAddCommand(arg1, cmdEnd, false);
+        case MacroOpcode_ActivateKeyPostponed:
+            return processActivateKeyPostponedCommand(arg1, cmdEnd);
+        case MacroOpcode_Break:
+            return processBreakCommand();
+        case MacroOpcode_ConsumePending:
+            return processConsumePendingCommand(arg1, cmdEnd);
+        case MacroOpcode_ClearStatus:
+            return processClearStatusCommand();
+        case MacroOpcode_Call:
+            return processCallCommand(arg1, cmdEnd);
+        case MacroOpcode_DelayUntilRelease:
+            return processDelayUntilReleaseCommand();
+        case MacroOpcode_DelayUntilReleaseMax:
+            return processDelayUntilReleaseMaxCommand(arg1, cmdEnd);
+        case MacroOpcode_DelayUntil:
+            return processDelayUntilCommand(arg1, cmdEnd);
+        case MacroOpcode_Diagnose:
+            return processDiagnoseCommand();
+        case MacroOpcode_Exec:
+            return processExecCommand(arg1, cmdEnd);
+        case MacroOpcode_Final:
+            if (processCommand(NextTok(cmd, cmdEnd), cmdEnd)) {
+                return true;
+            } else {
+                s->ms.macroBroken = true;
+                return false;
             }
             break;
-        case 'b':
-            if (TokenMatches(cmd, cmdEnd, "break")) {
-                return processBreakCommand();
-            }
-            else {
-                goto failed;
+        case MacroOpcode_GoTo:
+            return processGoToCommand(arg1, cmdEnd);
+        case MacroOpcode_HoldLayer:
+            return processHoldLayerCommand(arg1, cmdEnd);
+        case MacroOpcode_HoldLayerMax:
+            return processHoldLayerMaxCommand(arg1, cmdEnd);
+        case MacroOpcode_HoldKeymapLayer:
+            return processHoldKeymapLayerCommand(arg1, cmdEnd);
+        case MacroOpcode_HoldKeymapLayerMax:
+            return processHoldKeymapLayerMaxCommand(arg1, cmdEnd);
+        case MacroOpcode_HoldKey:
+            return processKeyCommand(MacroSubAction_Hold, arg1, cmdEnd);
+        case MacroOpcode_IfDoubletap:
+            if (!processIfDoubletapCommand(false) && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 'c':
-            if (TokenMatches(cmd, cmdEnd, "consumePending")) {
-                return processConsumePendingCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "clearStatus")) {
-                return processClearStatusCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "call")) {
-                return processCallCommand(arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfNotDoubletap:
+            if (!processIfDoubletapCommand(true) && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 'd':
-            if (TokenMatches(cmd, cmdEnd, "delayUntilRelease")) {
-                return processDelayUntilReleaseCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "delayUntilReleaseMax")) {
-                return processDelayUntilReleaseMaxCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "delayUntil")) {
-                return processDelayUntilCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "diagnose")) {
-                return processDiagnoseCommand();
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfInterrupted:
+            if (!processIfInterruptedCommand(false) && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 'e':
-            if (TokenMatches(cmd, cmdEnd, "exec")) {
-                return processExecCommand(arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfNotInterrupted:
+            if (!processIfInterruptedCommand(true) && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 'f':
-            if (TokenMatches(cmd, cmdEnd, "final")) {
-                if (processCommand(NextTok(cmd, cmdEnd), cmdEnd)) {
-                    return true;
-                } else {
-                    s->ms.macroBroken = true;
-                    return false;
-                }
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfReleased:
+            if (!processIfReleasedCommand(false) && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 'g':
-            if (TokenMatches(cmd, cmdEnd, "goTo")) {
-                return processGoToCommand(arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfNotReleased:
+            if (!processIfReleasedCommand(true) && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 'h':
-            if (TokenMatches(cmd, cmdEnd, "holdLayer")) {
-                return processHoldLayerCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "holdLayerMax")) {
-                return processHoldLayerMaxCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "holdKeymapLayer")) {
-                return processHoldKeymapLayerCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "holdKeymapLayerMax")) {
-                return processHoldKeymapLayerMaxCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "holdKey")) {
-                return processKeyCommand(MacroSubAction_Hold, arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfRegEq:
+            if (!processIfRegEqCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
+            cmd = NextTok(arg1, cmdEnd); //shift by 2
+            arg1 = NextTok(cmd, cmdEnd);
             break;
-        case 'i':
-            if (TokenMatches(cmd, cmdEnd, "ifDoubletap")) {
-                if (!processIfDoubletapCommand(false) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotDoubletap")) {
-                if (!processIfDoubletapCommand(true) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifInterrupted")) {
-                if (!processIfInterruptedCommand(false) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotInterrupted")) {
-                if (!processIfInterruptedCommand(true) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifReleased")) {
-                if (!processIfReleasedCommand(false) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotReleased")) {
-                if (!processIfReleasedCommand(true) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifRegEq")) {
-                if (!processIfRegEqCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = NextTok(arg1, cmdEnd); //shift by 2
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotRegEq")) {
-                if (!processIfRegEqCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = NextTok(arg1, cmdEnd); //shift by 2
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifPlaytime")) {
-                if (!processIfPlaytimeCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;  //shift by 1
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotPlaytime")) {
-                if (!processIfPlaytimeCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifAnyMod")) {
-                if (!processIfModifierCommand(false, 0xFF)  && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotAnyMod")) {
-                if (!processIfModifierCommand(true, 0xFF)  && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifShift")) {
-                if (!processIfModifierCommand(false, SHIFTMASK)  && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotShift")) {
-                if (!processIfModifierCommand(true, SHIFTMASK) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifCtrl")) {
-                if (!processIfModifierCommand(false, CTRLMASK) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotCtrl")) {
-                if (!processIfModifierCommand(true, CTRLMASK) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifAlt")) {
-                if (!processIfModifierCommand(false, ALTMASK) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotAlt")) {
-                if (!processIfModifierCommand(true, ALTMASK) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifGui")) {
-                if (!processIfModifierCommand(false, GUIMASK)  && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotGui")) {
-                if (!processIfModifierCommand(true, GUIMASK) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifRecording")) {
-                if (!processIfRecordingCommand(false) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotRecording")) {
-                if (!processIfRecordingCommand(true) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifRecordingId")) {
-                if (!processIfRecordingIdCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotRecordingId")) {
-                if (!processIfRecordingIdCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotPending")) {
-                if (!processIfPendingCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifPending")) {
-                if (!processIfPendingCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifKeyPendingAt")) {
-                if (!processifKeyPendingAtCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                //shift by two
-                cmd = NextTok(arg1, cmdEnd);
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotKeyPendingAt")) {
-                if (!processifKeyPendingAtCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                //shift by two
-                cmd = NextTok(arg1, cmdEnd);
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifKeyActive")) {
-                if (!processifKeyActiveCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotKeyActive")) {
-                if (!processifKeyActiveCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifPendingKeyReleased")) {
-                if (!processifPendingKeyReleasedCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotPendingKeyReleased")) {
-                if (!processifPendingKeyReleasedCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifKeyDefined")) {
-                if (!processifKeyDefinedCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotKeyDefined")) {
-                if (!processifKeyDefinedCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
-                    return false;
-                }
-                cmd = arg1;
-                arg1 = NextTok(cmd, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifSecondary")) {
-                return processIfSecondaryCommand(false, arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifPrimary")) {
-                return processIfSecondaryCommand(true, arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifShortcut")) {
-                return processIfShortcutCommand(false, arg1, cmdEnd, true);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotShortcut")) {
-                return processIfShortcutCommand(true, arg1, cmdEnd, true);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifGesture")) {
-                return processIfShortcutCommand(false, arg1, cmdEnd, false);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "ifNotGesture")) {
-                return processIfShortcutCommand(true, arg1, cmdEnd, false);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfNotRegEq:
+            if (!processIfRegEqCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
+            cmd = NextTok(arg1, cmdEnd); //shift by 2
+            arg1 = NextTok(cmd, cmdEnd);
             break;
-        case 'm':
-            if (TokenMatches(cmd, cmdEnd, "mulReg")) {
-                return processRegMulCommand(arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfPlaytime:
+            if (!processIfPlaytimeCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
+            cmd = arg1;  //shift by 1
+            arg1 = NextTok(cmd, cmdEnd);
             break;
-        case 'n':
-            if (TokenMatches(cmd, cmdEnd, "noOp")) {
-                return processNoOpCommand();
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfNotPlaytime:
+            if (!processIfPlaytimeCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
             break;
-        case 'p':
-            if (TokenMatches(cmd, cmdEnd, "printStatus")) {
-                return processPrintStatusCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "playMacro")) {
-                return processPlayMacroCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "pressKey")) {
-                return processKeyCommand(MacroSubAction_Press, arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "postponeKeys")) {
-                processPostponeKeysCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "postponeNext")) {
-                return processPostponeNextNCommand(arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfAnyMod:
+            if (!processIfModifierCommand(false, 0xFF)  && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 'r':
-            if (TokenMatches(cmd, cmdEnd, "recordMacro")) {
-                return processRecordMacroCommand(arg1, cmdEnd, false);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "recordMacroBlind")) {
-                return processRecordMacroCommand(arg1, cmdEnd, true);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "recordMacroDelay")) {
-                return processRecordMacroDelayCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "resolveSecondary")) {
-                return processResolveSecondaryCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "resolveNextKeyId")) {
-                return processResolveNextKeyIdCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "resolveNextKeyEq")) {
-                return processResolveNextKeyEqCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "releaseKey")) {
-                return processKeyCommand(MacroSubAction_Release, arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "repeatFor")) {
-                return processRepeatForCommand(arg1, cmdEnd);
-            }
-            else {
-                goto failed;
+        case MacroOpcode_IfNotAnyMod:
+            if (!processIfModifierCommand(true, 0xFF)  && !s->as.currentConditionPassed) {
+                return false;
             }
             break;
-        case 's':
-            if (TokenMatches(cmd, cmdEnd, "setStatusPart")) {
-                return processSetStatusCommand(arg1, cmdEnd, false);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "set")) {
-                MacroSetCommand(arg1, cmdEnd);
-                cmd = NextCmd(cmd, cmdEnd);
-                //TODO: get rid of this hack! Here and in CommandAction Too!
-                if (cmd != cmdEnd) {
-                   return processCommand(cmd, cmdEnd);
-                }
+        case MacroOpcode_IfShift:
+            if (!processIfModifierCommand(false, SHIFTMASK)  && !s->as.currentConditionPassed) {
                 return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "setStatus")) {
-                return processSetStatusCommand(arg1, cmdEnd, true);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "startRecording")) {
-                return processStartRecordingCommand(arg1, cmdEnd, false);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "startRecordingBlind")) {
-                return processStartRecordingCommand(arg1, cmdEnd, true);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "setLedTxt")) {
-                return processSetLedTxtCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "setReg")) {
-                return processSetRegCommand(arg1, cmdEnd);
-            }
-            else if (TokenMatches(cmd, cmdEnd, "statsRuntime")) {
-                return processStatsRuntimeCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "statsLayerStack")) {
-                return processStatsLayerStackCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "statsActiveKeys")) {
-                return processStatsActiveKeysCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "statsActiveMacros")) {
-                return processStatsActiveMacrosCommand();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "statsRegs")) {
-                return processStatsRegs();
-            }
-            else if (TokenMatches(cmd, cmdEnd, "statsPostponerStack")) {
-                return processStatsPostponerStackCommand();
+            break;
+        case MacroOpcode_IfNotShift:
+            if (!processIfModifierCommand(true, SHIFTMASK) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "subReg")) {
-                return processRegAddCommand(arg1, cmdEnd, true);
+            break;
+        case MacroOpcode_IfCtrl:
+            if (!processIfModifierCommand(false, CTRLMASK) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "switchKeymap")) {
-                return processSwitchKeymapCommand(arg1, cmdEnd);
+            break;
+        case MacroOpcode_IfNotCtrl:
+            if (!processIfModifierCommand(true, CTRLMASK) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "switchKeymapLayer")) {
-                return processSwitchKeymapLayerCommand(arg1, cmdEnd);
+            break;
+        case MacroOpcode_IfAlt:
+            if (!processIfModifierCommand(false, ALTMASK) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "switchLayer")) {
-                return processSwitchLayerCommand(arg1, cmdEnd);
+            break;
+        case MacroOpcode_IfNotAlt:
+            if (!processIfModifierCommand(true, ALTMASK) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "startMouse")) {
-                return processMouseCommand(true, arg1, cmdEnd);
+            break;
+        case MacroOpcode_IfGui:
+            if (!processIfModifierCommand(false, GUIMASK)  && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "stopMouse")) {
-                return processMouseCommand(false, arg1, cmdEnd);
+            break;
+        case MacroOpcode_IfNotGui:
+            if (!processIfModifierCommand(true, GUIMASK) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "stopRecording")) {
-                return processStopRecordingCommand();
+            break;
+        case MacroOpcode_IfRecording:
+            if (!processIfRecordingCommand(false) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "stopAllMacros")) {
-                return stopAllMacrosCommand();
+            break;
+        case MacroOpcode_IfNotRecording:
+            if (!processIfRecordingCommand(true) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "stopRecordingBlind")) {
-                return processStopRecordingCommand();
+            break;
+        case MacroOpcode_IfRecordingId:
+            if (!processIfRecordingIdCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "suppressMods")) {
-                processSuppressModsCommand();
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfNotRecordingId:
+            if (!processIfRecordingIdCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else {
-                goto failed;
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfNotPending:
+            if (!processIfPendingCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
             break;
-        case 't':
-            if (TokenMatches(cmd, cmdEnd, "toggleKeymapLayer")) {
-                return processToggleKeymapLayerCommand(arg1, cmdEnd);
+        case MacroOpcode_IfPending:
+            if (!processIfPendingCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "toggleLayer")) {
-                return processToggleLayerCommand(arg1, cmdEnd);
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfKeyPendingAt:
+            if (!processifKeyPendingAtCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "tapKey")) {
-                return processKeyCommand(MacroSubAction_Tap, arg1, cmdEnd);
+            //shift by two
+            cmd = NextTok(arg1, cmdEnd);
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfNotKeyPendingAt:
+            if (!processifKeyPendingAtCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "tapKeySeq")) {
-                return processTapKeySeqCommand(arg1, cmdEnd);
+            //shift by two
+            cmd = NextTok(arg1, cmdEnd);
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfKeyActive:
+            if (!processifKeyActiveCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else {
-                goto failed;
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfNotKeyActive:
+            if (!processifKeyActiveCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
             break;
-        case 'u':
-            if (TokenMatches(cmd, cmdEnd, "unToggleLayer")) {
-                return processUnToggleLayerCommand();
+        case MacroOpcode_IfPendingKeyReleased:
+            if (!processifPendingKeyReleasedCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else {
-                goto failed;
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfNotPendingKeyReleased:
+            if (!processifPendingKeyReleasedCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
             break;
-        case 'w':
-            if (TokenMatches(cmd, cmdEnd, "write")) {
-                return processWriteCommand(arg1, cmdEnd);
+        case MacroOpcode_IfKeyDefined:
+            if (!processifKeyDefinedCommand(false, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else if (TokenMatches(cmd, cmdEnd, "writeExpr")) {
-                return processWriteExprCommand(arg1, cmdEnd);
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfNotKeyDefined:
+            if (!processifKeyDefinedCommand(true, arg1, cmdEnd) && !s->as.currentConditionPassed) {
+                return false;
             }
-            else {
-                goto failed;
+            cmd = arg1;
+            arg1 = NextTok(cmd, cmdEnd);
+            break;
+        case MacroOpcode_IfSecondary:
+            return processIfSecondaryCommand(false, arg1, cmdEnd);
+        case MacroOpcode_IfPrimary:
+            return processIfSecondaryCommand(true, arg1, cmdEnd);
+        case MacroOpcode_IfShortcut:
+            return processIfShortcutCommand(false, arg1, cmdEnd, true);
+        case MacroOpcode_IfNotShortcut:
+            return processIfShortcutCommand(true, arg1, cmdEnd, true);
+        case MacroOpcode_IfGesture:
+            return processIfShortcutCommand(false, arg1, cmdEnd, false);
+        case MacroOpcode_IfNotGesture:
+            return processIfShortcutCommand(true, arg1, cmdEnd, false);
+        case MacroOpcode_MulReg:
+            return processRegMulCommand(arg1, cmdEnd);
+        case MacroOpcode_NoOp:
+            return processNoOpCommand();
+        case MacroOpcode_PrintStatus:
+            return processPrintStatusCommand();
+        case MacroOpcode_PlayMacro:
+            return processPlayMacroCommand(arg1, cmdEnd);
+        case MacroOpcode_PressKey:
+            return processKeyCommand(MacroSubAction_Press, arg1, cmdEnd);
+        case MacroOpcode_PostponeKeys:
+            processPostponeKeysCommand();
+            break;
+        case MacroOpcode_PostponeNext:
+            return processPostponeNextNCommand(arg1, cmdEnd);
+        case MacroOpcode_RecordMacro:
+            return processRecordMacroCommand(arg1, cmdEnd, false);
+        case MacroOpcode_RecordMacroBlind:
+            return processRecordMacroCommand(arg1, cmdEnd, true);
+        case MacroOpcode_RecordMacroDelay:
+            return processRecordMacroDelayCommand();
+        case MacroOpcode_ResolveSecondary:
+            return processResolveSecondaryCommand(arg1, cmdEnd);
+        case MacroOpcode_ResolveNextKeyId:
+            return processResolveNextKeyIdCommand();
+        case MacroOpcode_ResolveNextKeyEq:
+            return processResolveNextKeyEqCommand(arg1, cmdEnd);
+        case MacroOpcode_ReleaseKey:
+            return processKeyCommand(MacroSubAction_Release, arg1, cmdEnd);
+        case MacroOpcode_RepeatFor:
+            return processRepeatForCommand(arg1, cmdEnd);
+        case MacroOpcode_SetStatusPart:
+            return processSetStatusCommand(arg1, cmdEnd, false);
+        case MacroOpcode_Set:
+            MacroSetCommand(arg1, cmdEnd);
+            cmd = NextCmd(cmd, cmdEnd);
+            //TODO: get rid of this hack! Here and in CommandAction Too!
+            if (cmd != cmdEnd) {
+               return processCommand(cmd, cmdEnd);
             }
+            return false;
+        case MacroOpcode_SetStatus:
+            return processSetStatusCommand(arg1, cmdEnd, true);
+        case MacroOpcode_StartRecording:
+            return processStartRecordingCommand(arg1, cmdEnd, false);
+        case MacroOpcode_StartRecordingBlind:
+            return processStartRecordingCommand(arg1, cmdEnd, true);
+        case MacroOpcode_SetLedTxt:
+            return processSetLedTxtCommand(arg1, cmdEnd);
+        case MacroOpcode_SetReg:
+            return processSetRegCommand(arg1, cmdEnd);
+        case MacroOpcode_StatsRuntime:
+            return processStatsRuntimeCommand();
+        case MacroOpcode_StatsLayerStack:
+            return processStatsLayerStackCommand();
+        case MacroOpcode_StatsActiveKeys:
+            return processStatsActiveKeysCommand();
+        case MacroOpcode_StatsActiveMacros:
+            return processStatsActiveMacrosCommand();
+        case MacroOpcode_StatsRegs:
+            return processStatsRegs();
+        case MacroOpcode_StatsPostponerStack:
+            return processStatsPostponerStackCommand();
+        case MacroOpcode_SubReg:
+            return processRegAddCommand(arg1, cmdEnd, true);
+        case MacroOpcode_SwitchKeymap:
+            return processSwitchKeymapCommand(arg1, cmdEnd);
+        case MacroOpcode_SwitchKeymapLayer:
+            return processSwitchKeymapLayerCommand(arg1, cmdEnd);
+        case MacroOpcode_SwitchLayer:
+            return processSwitchLayerCommand(arg1, cmdEnd);
+        case MacroOpcode_StartMouse:
+            return processMouseCommand(true, arg1, cmdEnd);
+        case MacroOpcode_StopMouse:
+            return processMouseCommand(false, arg1, cmdEnd);
+        case MacroOpcode_StopRecording:
+            return processStopRecordingCommand();
+        case MacroOpcode_StopAllMacros:
+            return stopAllMacrosCommand();
+        case MacroOpcode_StopRecordingBlind:
+            return processStopRecordingCommand();
+        case MacroOpcode_SuppressMods:
+            processSuppressModsCommand();
             break;
+        case MacroOpcode_ToggleKeymapLayer:
+            return processToggleKeymapLayerCommand(arg1, cmdEnd);
+        case MacroOpcode_ToggleLayer:
+            return processToggleLayerCommand(arg1, cmdEnd);
+        case MacroOpcode_TapKey:
+            return processKeyCommand(MacroSubAction_Tap, arg1, cmdEnd);
+        case MacroOpcode_TapKeySeq:
+            return processTapKeySeqCommand(arg1, cmdEnd);
+        case MacroOpcode_UnToggleLayer:
+            return processUnToggleLayerCommand();
+        case MacroOpcode_Write:
+            return processWriteCommand(arg1, cmdEnd);
+        case MacroOpcode_WriteExpr:
+            return processWriteExprCommand(arg1, cmdEnd);
         default:
-        failed:
             Macros_ReportError("unrecognized command", cmd, cmdEnd);
             return false;
             break;
@@ -2459,11 +2409,10 @@ static bool processCurrentMacroAction(void)
 
 static bool findFreeStateSlot()
 {
-    for (uint8_t i = 0; i < MACRO_STATE_POOL_SIZE; i++) {
-        if (!MacroState[i].ms.macroPlaying) {
-            s = &MacroState[i];
-            return true;
-        }
+    uint32_t freeSlots = ~MacroActiveSlots & ((1UL << MACRO_STATE_POOL_SIZE) - 1);
+    if (freeSlots != 0) {
+        s = &MacroState[__builtin_ctz(freeSlots)];
+        return true;
     }
     Macros_ReportError("Too many macros running at one time", "", NULL);
     return false;
@@ -2513,6 +2462,10 @@ static bool execMacro(uint8_t index)
 static bool callMacro(uint8_t macroIndex)
 {
     s->ms.macroSleeping = true;
+    if (s->ms.reports != NULL && areReportsEmpty(s->ms.reports)) {
+        //claimed again once the caller emits something after the call
+        Macros_ReleaseReports(s);
+    }
     uint32_t ptr1 = (uint32_t)(macro_state_t*)s;
     uint32_t ptr2 = (uint32_t)(macro_state_t*)&(MacroState[0]);
     uint32_t slotIndex = (ptr1 - ptr2) / sizeof(macro_state_t);
@@ -2538,6 +2491,11 @@ void Macros_StartMacro(uint8_t index, key_state_t *keyState, uint8_t parentMacro
 
     s->ms.macroPlaying = true;
     s->ms.currentMacroIndex = index;
+
+    MacroActiveSlots |= 1UL << (s - MacroState);
+    uint8_t activeCount = __builtin_popcount(MacroActiveSlots);
+    slotHighWaterMark = activeCount > slotHighWaterMark ? activeCount : slotHighWaterMark;
+
     s->ms.currentMacroKey = keyState;
     s->ms.currentMacroStartTime = CurrentTime;
     s->ms.parentMacroSlot = parentMacroSlot;
@@ -2575,6 +2533,10 @@ bool continueMacro(void)
             //resume our calee, if this macro was called by another macro
             MacroState[s->ms.parentMacroSlot].ms.macroSleeping = false;
         }
+        if (s->ms.reports == NULL) {
+            //otherwise the slot is released once its last report gets merged
+            Macros_ReleaseReports(s);
+        }
         return false;
     }
     loadNextAction();
@@ -2582,16 +2544,55 @@ bool continueMacro(void)
 }
 
 
+/**
+ * Every playing macro runs at least one action per cycle. Actions which
+ * finish instantly (register arithmetics, conditions, jumps...) are followed
+ * by the next action right away, until the macro spends its MacroActionBudget
+ * or all macros together spend MacroCycleBudget. Actions which touch reports
+ * or postpone keys yield, since their effect has to reach the next report.
+ * Jumps back after a condition on keys, modifiers or the playtime yield as
+ * well: keys are scanned once per cycle and time counts in milliseconds, so
+ * such a polling loop would just spin until the budget runs out.
+ */
+static void runMacro(uint32_t cycleStart)
+{
+    if (MacroActionBudget == 0) {
+        continueMacro();
+        return;
+    }
+    uint32_t macroStart = Timer_GetCurrentTimeMicros();
+    inputPolled = false;
+    while (true) {
+        actionYielded = false;
+        if (continueMacro() || actionYielded || !s->ms.macroPlaying || s->ms.macroSleeping || s->ms.postponeNextNCommands > 0) {
+            return;
+        }
+        uint32_t now = Timer_GetCurrentTimeMicros();
+        if (now - macroStart >= MacroActionBudget) {
+            actionBudgetOverruns++;
+            return;
+        }
+        if (now - cycleStart >= MacroCycleBudget) {
+            cycleBudgetOverruns++;
+            return;
+        }
+    }
+}
+
 void Macros_ContinueMacro(void)
 {
     bool someonePlaying = false;
-    for (uint8_t i = 0; i < MACRO_STATE_POOL_SIZE; i++) {
+    uint32_t cycleStart = Timer_GetCurrentTimeMicros();
+    for (uint8_t i = nextActiveSlot(0); i < MACRO_STATE_POOL_SIZE; i = nextActiveSlot(i + 1)) {
         if (MacroState[i].ms.macroPlaying && !MacroState[i].ms.macroSleeping) {
             someonePlaying = true;
             s = &MacroState[i];
-            continueMacro();
+            runMacro(cycleStart);
         }
     }
     s = NULL;
     MacroPlaying &= someonePlaying;
+
+    uint32_t passDuration = Timer_GetCurrentTimeMicros() - cycleStart;
+    longestMacroPass = passDuration > longestMacroPass ? passDuration : longestMacroPass;
 }
@@ -13,16 +13,23 @@
     #define MACRO_CYCLES_TO_POSTPONE 4
 
     #define MAX_MACRO_NUM 255
-    #define STATUS_BUFFER_MAX_LENGTH 1024
     #define LAYER_STACK_SIZE 10
     #define MACRO_STATE_POOL_SIZE 20
+    #define MACRO_REPORT_POOL_SIZE 8
     #define MAX_REG_COUNT 32
 
+    #define MACRO_DEFAULT_ACTION_BUDGET 100 // us one macro may spend on instant actions per cycle
+    #define MACRO_DEFAULT_CYCLE_BUDGET 250 // us all macros together may spend on them per cycle
+
     #define ALTMASK (HID_KEYBOARD_MODIFIER_LEFTALT | HID_KEYBOARD_MODIFIER_RIGHTALT)
     #define CTRLMASK (HID_KEYBOARD_MODIFIER_LEFTCTRL | HID_KEYBOARD_MODIFIER_RIGHTCTRL)
     #define SHIFTMASK (HID_KEYBOARD_MODIFIER_LEFTSHIFT | HID_KEYBOARD_MODIFIER_RIGHTSHIFT)
     #define GUIMASK (HID_KEYBOARD_MODIFIER_LEFTGUI | HID_KEYBOARD_MODIFIER_RIGHTGUI)
 
+    #if MACRO_STATE_POOL_SIZE > 31 || MACRO_REPORT_POOL_SIZE > 31
+    #error Macro slots and report buffers are tracked in 32-bit masks.
+    #endif
+
 // Typedefs:
 
     typedef struct {
@@ -92,6 +99,17 @@
         macro_action_type_t type;
     } ATTR_PACKED macro_action_t;
 
+    // Report buffers are only allocated to macros that actually emit something,
+    // see Macros_ClaimReports. They are returned to the pool once the final
+    // report of an ended macro has been merged.
+    typedef struct {
+        usb_mouse_report_t mouseReport;
+        usb_basic_keyboard_report_t basicKeyboardReport;
+        usb_media_keyboard_report_t mediaKeyboardReport;
+        usb_system_keyboard_report_t systemKeyboardReport;
+        uint8_t ownerSlot;
+    } macro_reports_t;
+
     typedef struct {
         // persistent scope data
         // these need to live in between macro calls
@@ -105,6 +123,7 @@
         struct {
             macro_action_t currentMacroAction;
             key_state_t *currentMacroKey;
+            macro_reports_t *reports;
             uint32_t currentMacroStartTime;
             uint16_t currentMacroActionIndex;
             uint16_t bufferOffset;
@@ -115,12 +134,6 @@
             bool macroSleeping : 1;
             bool macroBroken : 1;
             bool macroPlaying : 1;
-            bool reportsUsed : 1;
-
-            usb_mouse_report_t macroMouseReport;
-            usb_basic_keyboard_report_t macroBasicKeyboardReport;
-            usb_media_keyboard_report_t macroMediaKeyboardReport;
-            usb_system_keyboard_report_t macroSystemKeyboardReport;
         } ms;
 
         // action scope data
@@ -129,7 +142,6 @@
             union {
                 struct {
                     uint16_t textIdx;
-                    uint8_t reportIdx;
                 } dispatchData;
 
                 struct {
@@ -165,9 +177,14 @@
     extern macro_reference_t AllMacros[MAX_MACRO_NUM];
     extern uint8_t AllMacrosCount;
     extern macro_state_t MacroState[MACRO_STATE_POOL_SIZE];
+    extern macro_reports_t MacroReports[MACRO_REPORT_POOL_SIZE];
+    extern uint32_t MacroActiveSlots;
+    extern uint32_t MacroUsedReports;
     extern bool MacroPlaying;
     extern layer_id_t Macros_ActiveLayer;
     extern bool Macros_ActiveLayerHeld;
+    extern uint16_t MacroActionBudget;
+    extern uint16_t MacroCycleBudget;
 
 // Functions:
 
@@ -175,7 +192,9 @@
     void Macros_ContinueMacro(void);
     void Macros_SignalInterrupt(void);
     bool Macros_ClaimReports(void);
+    void Macros_ReleaseReports(macro_state_t *state);
     void Macros_ReportError(const char* err, const char* arg, const char *argEnd);
+    void Macros_ReportWarning(const char* warn, const char* arg, const char *argEnd);
     void Macros_ReportErrorNum(const char* err, uint32_t num);
     void Macros_SetStatusString(const char* text, const char *textEnd);
     void Macros_SetStatusStringInterpolated(const char* text, const char *textEnd);
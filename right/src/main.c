@@ -13,6 +13,7 @@
 #include "usb_report_updater.h"
 #include "macro_events.h"
 #include "macro_shortcut_parser.h"
+#include "perf_probes.h"
 
 static bool IsEepromInitialized = false;
 static bool IsConfigInitialized = false;
@@ -52,10 +53,11 @@ int main(void)
             if (!IsConfigInitialized && IsEepromInitialized) {
                 UsbCommand_ApplyConfig();
                 MacroEvent_OnInit();
-                ShortcutParser_initialize();
                 IsConfigInitialized = true;
             }
+            PERF_PROBE_BEGIN(MatrixScan);
             KeyMatrix_ScanRow(&RightKeyMatrix);
+            PERF_PROBE_END(MatrixScan);
             ++MatrixScanCounter;
             UpdateUsbReports();
             __WFI();
@@ -69,7 +69,7 @@ module_kinetic_state_t moduleKineticState = {
 
     .caretAxis = CaretAxis_None,
     .caretFakeKeystate = {},
-    .caretAction = &CurrentKeymap[0][0][0],
+    .caretAction = NULL,
     .xFractionRemainder = 0.0f,
     .yFractionRemainder = 0.0f,
     .lastUpdate = 0,
@@ -528,3 +528,41 @@ void ToggleMouseState(serialized_mouse_action_t action, bool activate)
         ToggledMouseStates[action] -= ToggledMouseStates[action] > 0 ? 1 : 0;
     }
 }
+
+// Returns true if a call to MouseController_ProcessMouseActions would neither produce a non-zero
+// report nor advance any kinetic or caret state.
+bool MouseController_IsIdle(void)
+{
+    for (uint8_t i = 0; i < ACTIVE_MOUSE_STATES_COUNT; i++) {
+        if (ToggledMouseStates[i] || ActiveMouseStates[i]) {
+            return false;
+        }
+    }
+
+    if (MouseMoveState.wasMoveAction || MouseScrollState.wasMoveAction) {
+        return false;
+    }
+
+    if (TouchpadEvents.x || TouchpadEvents.y || TouchpadEvents.singleTap || TouchpadEvents.twoFingerTap || TouchpadEvents.tapAndHold) {
+        return false;
+    }
+
+    for (uint8_t moduleSlotId=0; moduleSlotId<UHK_MODULE_MAX_SLOT_COUNT; moduleSlotId++) {
+        uhk_module_state_t *moduleState = UhkModuleStates + moduleSlotId;
+        if (moduleState->pointerDelta.x || moduleState->pointerDelta.y) {
+            return false;
+        }
+    }
+
+    if (moduleKineticState.caretFakeKeystate.current || moduleKineticState.caretFakeKeystate.previous) {
+        return false;
+    }
+
+    return fabsf(moduleKineticState.xFractionRemainder) < 1.0f && fabsf(moduleKineticState.yFractionRemainder) < 1.0f;
+}
+
+// Keeps the elapsed time of the kinetic states short while the report updater skips mouse processing.
+void MouseController_SkipMouseActions(void)
+{
+    mouseUsbReportUpdateTime = CurrentTime;
+}
@@ -68,5 +68,7 @@
 // Functions:
     void MouseController_ActivateDirectionSigns(uint8_t state);
     void MouseController_ProcessMouseActions();
+    bool MouseController_IsIdle(void);
+    void MouseController_SkipMouseActions(void);
 
 #endif
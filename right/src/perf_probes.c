@@ -0,0 +1,31 @@
+#include <string.h>
+#include "perf_probes.h"
+
+perf_probe_t PerfProbes[PerfProbeId_Count];
+
+void PerfProbe_Record(perf_probe_id_t probeId, uint32_t durationMicros)
+{
+    perf_probe_t *probe = PerfProbes + probeId;
+
+    if (probe->count == 0 || durationMicros < probe->min) {
+        probe->min = durationMicros;
+    }
+    if (durationMicros > probe->max) {
+        probe->max = durationMicros;
+    }
+    probe->total += durationMicros;
+    probe->count++;
+
+    uint8_t bucket = durationMicros ? 31 - __builtin_clz(durationMicros) : 0;
+    if (bucket >= PERF_PROBE_BUCKET_COUNT) {
+        bucket = PERF_PROBE_BUCKET_COUNT - 1;
+    }
+    if (probe->buckets[bucket] < UINT16_MAX) {
+        probe->buckets[bucket]++;
+    }
+}
+
+void PerfProbe_Reset(perf_probe_id_t probeId)
+{
+    memset(PerfProbes + probeId, 0, sizeof(perf_probe_t));
+}
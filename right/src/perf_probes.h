@@ -0,0 +1,58 @@
+#ifndef __PERF_PROBES_H__
+#define __PERF_PROBES_H__
+
+// Includes:
+
+    #include <stdint.h>
+    #include "timer.h"
+
+// Macros:
+
+    // Comment this out to compile all probes away.
+    #define PERF_PROBES
+
+    #define PERF_PROBE_BUCKET_COUNT 12 // bucket n holds durations in [2^n, 2^(n+1)) us, the last one everything above
+
+#ifdef PERF_PROBES
+    // Starts a measurement in the current scope.
+    #define PERF_PROBE_BEGIN(NAME) uint32_t perfProbeStart_##NAME = Timer_GetCurrentTimeMicros();
+
+    // Ends a measurement started by PERF_PROBE_BEGIN in the same scope.
+    #define PERF_PROBE_END(NAME) PerfProbe_Record(PerfProbeId_##NAME, Timer_GetCurrentTimeMicros() - perfProbeStart_##NAME);
+#else
+    #define PERF_PROBE_BEGIN(NAME)
+    #define PERF_PROBE_END(NAME)
+#endif
+
+// Typedefs:
+
+    typedef enum {
+        PerfProbeId_MatrixScan,
+        PerfProbeId_I2cRoundTrip,
+        PerfProbeId_UpdateReports,
+        PerfProbeId_ContinueMacro,
+        PerfProbeId_RunPostponedEvents,
+        PerfProbeId_UsbSend,
+        PerfProbeId_Count,
+    } perf_probe_id_t;
+
+    // Every probe has a single writer - either the main loop or a single interrupt handler -
+    // so no locking is needed. A reader may observe a sample half-recorded.
+    typedef struct {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t total;
+        uint16_t buckets[PERF_PROBE_BUCKET_COUNT];
+    } perf_probe_t;
+
+// Variables:
+
+    extern perf_probe_t PerfProbes[PerfProbeId_Count];
+
+// Functions:
+
+    void PerfProbe_Record(perf_probe_id_t probeId, uint32_t durationMicros);
+    void PerfProbe_Reset(perf_probe_id_t probeId);
+
+#endif
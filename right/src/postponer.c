@@ -15,7 +15,20 @@ uint8_t cyclesUntilActivation = 0;
 key_state_t* Postponer_NextEventKey;
 uint32_t lastPressTime;
 
-#define POS(idx) ((bufferPosition + (idx)) % POSTPONER_BUFFER_SIZE)
+#define POS(idx) ((bufferPosition + (idx)) & (POSTPONER_BUFFER_SIZE - 1))
+
+// Index of the queue contents, which turns the query functions into lookups.
+// Keys are indexed by their offset in KeyStates; anything else shares the last entry.
+#define INDEXED_KEY_COUNT (SLOT_COUNT*MAX_KEY_COUNT_PER_MODULE)
+
+static uint8_t keyEventCount[INDEXED_KEY_COUNT+1];
+static uint8_t keyReleaseCount[INDEXED_KEY_COUNT+1];
+static bool keyLastActive[INDEXED_KEY_COUNT+1];
+
+// Buffer positions of pending keypresses in queue order, a ring of pendingKeypressCount entries starting at pressHead.
+static uint8_t pressPositions[POSTPONER_BUFFER_SIZE];
+static uint8_t pressHead = 0;
+static uint8_t pendingKeypressCount = 0;
 
 bool Chording = false;
 static void chording();
@@ -25,18 +38,63 @@ static void chording();
 //### Implementation Helpers ###
 //##############################
 
+static uint16_t keyIndex(key_state_t* key)
+{
+    key_state_t* first = &KeyStates[0][0];
+    return first <= key && key < first + INDEXED_KEY_COUNT ? key - first : INDEXED_KEY_COUNT;
+}
+
+// Adds the record at buffer position pos, which has to be the last one in the queue.
+static void indexEvent(uint8_t pos)
+{
+    uint16_t idx = keyIndex(buffer[pos].key);
+    keyEventCount[idx]++;
+    keyLastActive[idx] = buffer[pos].active;
+    if (buffer[pos].active) {
+        pressPositions[(pressHead + pendingKeypressCount++) & (POSTPONER_BUFFER_SIZE - 1)] = pos;
+    } else {
+        keyReleaseCount[idx]++;
+    }
+}
+
+// Removes the record at buffer position pos, which has to be the first one in the queue.
+static void unindexFirstEvent(uint8_t pos)
+{
+    uint16_t idx = keyIndex(buffer[pos].key);
+    keyEventCount[idx]--;
+    if (buffer[pos].active) {
+        pressHead = (pressHead + 1) & (POSTPONER_BUFFER_SIZE - 1);
+        pendingKeypressCount--;
+    } else {
+        keyReleaseCount[idx]--;
+    }
+}
+
+// Whenever the queue is modified other than at its ends, the index is dropped before and rebuilt after the modification.
+static void unindexAll(void)
+{
+    for (uint8_t i = 0; i < bufferSize; i++) {
+        uint16_t idx = keyIndex(buffer[POS(i)].key);
+        keyEventCount[idx] = 0;
+        keyReleaseCount[idx] = 0;
+    }
+    pressHead = 0;
+    pendingKeypressCount = 0;
+}
+
+static void indexAll(void)
+{
+    for (uint8_t i = 0; i < bufferSize; i++) {
+        indexEvent(POS(i));
+    }
+}
+
 static uint8_t getPendingKeypressIdx(uint8_t n)
 {
-    for ( int i = 0; i < bufferSize; i++ ) {
-        if (buffer[POS(i)].active) {
-            if (n == 0) {
-                return i;
-            } else {
-                n--;
-            }
-        }
+    if (n >= pendingKeypressCount) {
+        return 255;
     }
-    return 255;
+    return (pressPositions[(pressHead + n) & (POSTPONER_BUFFER_SIZE - 1)] - bufferPosition) & (POSTPONER_BUFFER_SIZE - 1);
 }
 
 static key_state_t* getPendingKeypress(uint8_t n)
@@ -51,6 +109,9 @@ static key_state_t* getPendingKeypress(uint8_t n)
 
 static void consumeEvent(uint8_t count)
 {
+    for (uint8_t i = 0; i < count && i < bufferSize; i++) {
+        unindexFirstEvent(POS(i));
+    }
     bufferPosition = POS(count);
     bufferSize = count > bufferSize ? 0 : bufferSize - count;
     Postponer_NextEventKey = bufferSize == 0 ? NULL : buffer[bufferPosition].key;
@@ -93,6 +154,7 @@ void PostponerCore_TrackKeyEvent(key_state_t *keyState, bool active)
     //if the buffer is totally filled, at least make sure the key doesn't get stuck
     if (bufferSize == POSTPONER_BUFFER_SIZE) {
         buffer[pos].key->current = buffer[bufferPosition].active;
+        KeyState_MarkActive(buffer[pos].key);
         consumeEvent(1);
     }
 
@@ -102,18 +164,95 @@ void PostponerCore_TrackKeyEvent(key_state_t *keyState, bool active)
             .active = active,
     };
     bufferSize = bufferSize < POSTPONER_BUFFER_SIZE ? bufferSize + 1 : bufferSize;
+    indexEvent(pos);
     lastPressTime = active ? CurrentTime : lastPressTime;
 }
 
+// A plain keystroke event only adds or removes scancodes and modifiers from the report. Its action
+// (the active layer one for a press, the cached one for a release) is a keystroke without a secondary
+// role, and its base layer action doesn't hold a layer.
+static key_action_t* eventAction(key_state_t *key, bool active)
+{
+    return active ? &CurrentKeymap[ActiveLayer][0][0] + keyIndex(key) : GetCachedKeyAction(key);
+}
+
+static bool isPlainKeystrokeEvent(key_state_t *key, bool active)
+{
+    uint16_t idx = keyIndex(key);
+    if (idx == INDEXED_KEY_COUNT) {
+        return false;
+    }
+
+    key_action_t* action = eventAction(key, active);
+    key_action_t* actionBase = &CurrentKeymap[LayerId_Base][0][0] + idx;
+
+    return action->type == KeyActionType_Keystroke && !action->keystroke.secondaryRole &&
+        actionBase->type != KeyActionType_SwitchLayer &&
+        !(actionBase->type == KeyActionType_Keystroke && actionBase->keystroke.secondaryRole);
+}
+
+static void replayEvent(void)
+{
+    buffer[bufferPosition].key->current = buffer[bufferPosition].active;
+    KeyState_MarkActive(buffer[bufferPosition].key);
+    consumeEvent(1);
+}
+
+// Replays the first event, followed by events of other keys as long as all of them are plain keystrokes
+// whose relative order can't be told apart within a single report: releases before at most one press, and
+// after it only releases which don't drop modifiers. Each scancode appears at most once in a batch, since
+// a release and a re-press of the same scancode (e.g., by two keys which send it) would cancel out.
+static void replayEvents(void)
+{
+    bool batch = !Chording && cyclesUntilActivation == 0 && isPlainKeystrokeEvent(buffer[bufferPosition].key, buffer[bufferPosition].active);
+    uint64_t replayedKeys[SLOT_COUNT] = {};
+    uint32_t replayedScancodes[256 / 32] = {}; // media and system scancodes are folded into the low byte
+    bool pressReplayed = false;
+
+    do {
+        struct postponer_buffer_record_type_t* event = &buffer[bufferPosition];
+        uint16_t idx = keyIndex(event->key);
+
+        if (idx < INDEXED_KEY_COUNT) {
+            replayedKeys[idx / MAX_KEY_COUNT_PER_MODULE] |= 1ULL << (idx % MAX_KEY_COUNT_PER_MODULE);
+        }
+        if (batch) {
+            uint8_t scancode = eventAction(event->key, event->active)->keystroke.scancode;
+            replayedScancodes[scancode / 32] |= 1UL << (scancode % 32);
+        }
+        pressReplayed |= event->active;
+        replayEvent();
+
+        if (!batch || bufferSize == 0) {
+            break;
+        }
+
+        event = &buffer[bufferPosition];
+        idx = keyIndex(event->key);
+        if (!isPlainKeystrokeEvent(event->key, event->active)) {
+            break;
+        }
+        if ((replayedKeys[idx / MAX_KEY_COUNT_PER_MODULE] >> (idx % MAX_KEY_COUNT_PER_MODULE)) & 1) {
+            break;
+        }
+        uint8_t scancode = eventAction(event->key, event->active)->keystroke.scancode;
+        if ((replayedScancodes[scancode / 32] >> (scancode % 32)) & 1) {
+            break;
+        }
+        if (pressReplayed && (event->active || GetCachedKeyAction(event->key)->keystroke.modifiers)) {
+            break;
+        }
+    } while (true);
+}
+
 void PostponerCore_RunPostponedEvents(void)
 {
     if (Chording) {
         chording();
     }
-    // Process one event every two cycles. (Unless someone keeps Postponer active by touching cycles_until_activation.)
+    // Process one event every two cycles, or a batch of plain keystrokes. (Unless someone keeps Postponer active by touching cycles_until_activation.)
     if (bufferSize != 0 && (cyclesUntilActivation == 0 || bufferSize > POSTPONER_BUFFER_MAX_FILL)) {
-        buffer[bufferPosition].key->current = buffer[bufferPosition].active;
-        consumeEvent(1);
+        replayEvents();
         // This gives the key two ticks (this and next) to get properly processed before execution of next queued event.
         PostponerCore_PostponeNCycles(1);
     }
@@ -131,13 +270,7 @@ void PostponerCore_FinishCycle(void)
 
 uint8_t PostponerQuery_PendingKeypressCount()
 {
-    uint8_t cnt = 0;
-    for ( uint8_t i = 0; i < bufferSize; i++ ) {
-        if (buffer[POS(i)].active) {
-            cnt++;
-        }
-    }
-    return cnt;
+    return pendingKeypressCount;
 }
 
 
@@ -146,12 +279,7 @@ bool PostponerQuery_IsKeyReleased(key_state_t* key)
     if (key == NULL) {
         return false;
     }
-    for ( uint8_t i = 0; i < bufferSize; i++ ) {
-        if (buffer[POS(i)].key == key && !buffer[POS(i)].active) {
-            return true;
-        }
-    }
-    return false;
+    return keyReleaseCount[keyIndex(key)] > 0;
 }
 
 bool PostponerQuery_IsActiveEventually(key_state_t* key)
@@ -159,12 +287,8 @@ bool PostponerQuery_IsActiveEventually(key_state_t* key)
     if (key == NULL) {
         return false;
     }
-    for ( int8_t i = bufferSize - 1; i >= 0; i-- ) {
-        if (buffer[POS(i)].key == key) {
-            return buffer[POS(i)].active;
-        }
-    }
-    return KeyState_Active(key);
+    uint16_t idx = keyIndex(key);
+    return keyEventCount[idx] > 0 ? keyLastActive[idx] : KeyState_Active(key);
 }
 
 //##########################
@@ -176,6 +300,7 @@ static void consumeOneKeypress()
     uint8_t shifting_by = 0;
     key_state_t* removedKeypress = NULL;
     bool releaseFound = false;
+    unindexAll();
     for (int i = 0; i < bufferSize; i++) {
         buffer[POS(i-shifting_by)] = buffer[POS(i)];
         if (releaseFound) {
@@ -190,15 +315,60 @@ static void consumeOneKeypress()
         }
     }
     bufferSize -= shifting_by;
+    indexAll();
     Postponer_NextEventKey = bufferSize == 0 ? NULL : buffer[bufferPosition].key;
 }
 
 void PostponerExtended_ResetPostponer(void)
 {
     cyclesUntilActivation = 0;
+    unindexAll();
     bufferSize = 0;
 }
 
+// Replaces the first queued press of the first of the keys by a press of the replacement key and removes
+// the first queued presses of the other keys. Does nothing unless presses of all the keys are queued.
+bool PostponerExtended_ReplaceKeypresses(key_state_t** keys, uint8_t count, key_state_t* replacement)
+{
+    uint8_t positions[POSTPONER_BUFFER_SIZE];
+    uint8_t first = 255;
+
+    if (count == 0 || count > POSTPONER_BUFFER_SIZE) {
+        return false;
+    }
+
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t i = 0;
+        while (i < bufferSize && !(buffer[POS(i)].key == keys[k] && buffer[POS(i)].active)) {
+            i++;
+        }
+        if (i == bufferSize) {
+            return false;
+        }
+        positions[k] = i;
+        first = MIN(first, i);
+    }
+
+    unindexAll();
+    buffer[POS(first)].key = replacement;
+    uint8_t removed = 0;
+    for (uint8_t i = 0; i < bufferSize; i++) {
+        bool remove = false;
+        for (uint8_t k = 0; k < count; k++) {
+            remove |= positions[k] == i && i != first;
+        }
+        if (remove) {
+            removed++;
+        } else {
+            buffer[POS(i-removed)] = buffer[POS(i)];
+        }
+    }
+    bufferSize -= removed;
+    indexAll();
+    Postponer_NextEventKey = bufferSize == 0 ? NULL : buffer[bufferPosition].key;
+    return true;
+}
+
 uint16_t PostponerExtended_PendingId(uint16_t idx)
 {
     return Utils_KeyStateToKeyId(getPendingKeypress(idx));
@@ -250,12 +420,7 @@ bool PostponerQuery_ContainsKeyId(uint8_t keyid)
     if (key == NULL) {
         return false;
     }
-    for ( uint8_t i = 0; i < bufferSize; i++ ) {
-        if (buffer[POS(i)].key == key) {
-            return true;
-        }
-    }
-    return false;
+    return keyEventCount[keyIndex(key)] > 0;
 }
 
 
@@ -287,6 +452,10 @@ static uint8_t priority(key_state_t *key, bool active)
     return 0;
 }
 
+// Chording stays next to combos (combos.c) on purpose. A combo replaces presses of a fixed set of keys by
+// an output key, while chording keeps every key's own action and only reorders presses of any keys by
+// the type of their actions. Expressed as combos, it would need a combo per ordered pair of keys, far
+// beyond COMBO_MAX_COUNT, and each would have to bind the pair's actions to an output key.
 static void chording()
 {
     const uint16_t limit = 50;
@@ -294,6 +463,7 @@ static void chording()
         PostponerCore_PostponeNCycles(0);
     } else {
         bool activated = false;
+        unindexAll();
         for ( uint8_t i = 0; i < bufferSize - 1; i++ ) {
             struct postponer_buffer_record_type_t* a = &buffer[POS(i)];
             struct postponer_buffer_record_type_t* b = &buffer[POS(i+1)];
@@ -308,6 +478,7 @@ static void chording()
                 }
             }
         }
+        indexAll();
         if (activated) {
             PostponerCore_PostponeNCycles(0);
         }
@@ -25,10 +25,17 @@
 // Macros:
 
     //Both 5 and 32 are quite arbitrary. 5 suffices for two keystrokes and one more event just to be sure.
+    //The buffer size can be overridden at build time, but has to remain a power of two.
     #define POSTPONER_BUFFER_SAFETY_GAP 5
+    #ifndef POSTPONER_BUFFER_SIZE
     #define POSTPONER_BUFFER_SIZE 32
+    #endif
     #define POSTPONER_BUFFER_MAX_FILL (POSTPONER_BUFFER_SIZE-POSTPONER_BUFFER_SAFETY_GAP)
 
+    #if POSTPONER_BUFFER_SIZE & (POSTPONER_BUFFER_SIZE-1) || POSTPONER_BUFFER_SIZE < 8 || POSTPONER_BUFFER_SIZE > 128
+    #error POSTPONER_BUFFER_SIZE has to be a power of two between 8 and 128.
+    #endif
+
 // Typedefs:
 
     struct postponer_buffer_record_type_t {
@@ -64,6 +71,7 @@
     bool PostponerQuery_ContainsKeyId(uint8_t keyid);
     void PostponerExtended_ConsumePendingKeypresses(int count, bool suppress);
     void PostponerExtended_ResetPostponer(void);
+    bool PostponerExtended_ReplaceKeypresses(key_state_t** keys, uint8_t count, key_state_t* replacement);
 
     void PostponerExtended_PrintContent();
 
@@ -21,5 +21,5 @@ key_matrix_t RightKeyMatrix = {
         {PORTC, GPIOC, kCLOCK_PortC, 0},
         {PORTD, GPIOD, kCLOCK_PortD, 5}
     },
-    .keyStates = {0}
+    .keyStates = 0
 };
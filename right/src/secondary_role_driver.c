@@ -10,6 +10,7 @@ static void activatePrimary()
     // Activate the key "again", but now in "SecondaryRoleState_Primary".
     resolutionKey->current = true;
     resolutionKey->previous = false;
+    KeyState_MarkActive(resolutionKey);
     // Give the key two cycles (this and next) of activity before allowing postponer to replay any events (esp., the key's own release).
     PostponerCore_PostponeNCycles(1);
 }
@@ -19,6 +20,7 @@ static void activateSecondary()
     // Activate the key "again", but now in "SecondaryRoleState_Secondary".
     resolutionKey->current = true;
     resolutionKey->previous = false;
+    KeyState_MarkActive(resolutionKey);
     // Let the secondary role take place before allowing the affected key to execute. Postponing rest of this cycle should suffice.
     PostponerCore_PostponeNCycles(0); //just for aesthetics - we are already postponed for this cycle so this is no-op
 }
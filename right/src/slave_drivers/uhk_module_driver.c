@@ -7,7 +7,9 @@
 #include "bool_array_converter.h"
 #include "crc16.h"
 #include "key_states.h"
+#include "timer.h"
 #include "usb_report_updater.h"
+#include "keymap.h"
 
 uhk_module_state_t UhkModuleStates[UHK_MODULE_MAX_SLOT_COUNT];
 
@@ -21,7 +23,6 @@ uint8_t UhkModuleSlaveDriver_DriverIdToSlotId(uint8_t uhkModuleDriverId)
     return uhkModuleDriverId+1;
 }
 
-static uint8_t keyStatesBuffer[MAX_KEY_COUNT_PER_MODULE];
 static i2c_message_t txMessage;
 
 static uhk_module_i2c_addresses_t moduleIdsToI2cAddresses[] = {
@@ -49,6 +50,57 @@ static status_t rx(i2c_message_t *rxMessage, uint8_t i2cAddress)
     return I2cAsyncReadMessage(i2cAddress, rxMessage);
 }
 
+static bool isModuleProtocolAtLeast(version_t *moduleProtocolVersion, uint16_t major, uint16_t minor)
+{
+    return moduleProtocolVersion->major > major || (moduleProtocolVersion->major == major && moduleProtocolVersion->minor >= minor);
+}
+
+static uint8_t keyStatesMessageLength(uhk_module_state_t *uhkModuleState)
+{
+    return BOOL_BYTES_TO_BITS_COUNT(uhkModuleState->keyCount) + (uhkModuleState->pointerCount ? sizeof(pointer_delta_t) : 0);
+}
+
+static void applyKeyStates(uint8_t uhkModuleDriverId, uint8_t *data)
+{
+    uhk_module_state_t *uhkModuleState = UhkModuleStates + uhkModuleDriverId;
+    uint8_t slotId = UhkModuleSlaveDriver_DriverIdToSlotId(uhkModuleDriverId);
+    uint8_t keyStatesLength = BOOL_BYTES_TO_BITS_COUNT(uhkModuleState->keyCount);
+    uint64_t hardwareBits = 0;
+    memcpy(&hardwareBits, data, keyStatesLength);
+    if (uhkModuleState->keyCount < MAX_KEY_COUNT_PER_MODULE) {
+        hardwareBits &= (1ULL << uhkModuleState->keyCount) - 1;
+    }
+    if (hardwareBits & ~KeyStateBits[slotId].hardware) {
+        KeyStateBits[slotId].pressTime = Timer_GetCurrentTimeMicros();
+    }
+    KeyStateBits[slotId].hardware = hardwareBits;
+    if (uhkModuleState->pointerCount) {
+        pointer_delta_t *pointerDelta = (pointer_delta_t*)(data + keyStatesLength);
+        uhkModuleState->pointerDelta.x += pointerDelta->x;
+        uhkModuleState->pointerDelta.y += pointerDelta->y;
+    }
+}
+
+// The module sends a full message whenever something changes and assumes that the master got it.
+// If a message gets lost, the next "unchanged" message carries a sequence number unknown to the
+// master. It is ignored, and the next request acks the last sequence number the master knows,
+// which makes the module answer in full.
+static void processDeltaKeyStates(uint8_t uhkModuleDriverId)
+{
+    uhk_module_state_t *uhkModuleState = UhkModuleStates + uhkModuleDriverId;
+    i2c_message_t *rxMessage = &uhkModuleState->rxMessage;
+    uint8_t messageType = rxMessage->data[0];
+    uint8_t sequence = rxMessage->data[1];
+
+    if (!CRC16_IsMessageValid(rxMessage)) {
+        return;
+    }
+    if (messageType == KeyStatesMessage_Full && rxMessage->length == KEY_STATES_DELTA_HEADER_LENGTH + keyStatesMessageLength(uhkModuleState)) {
+        applyKeyStates(uhkModuleDriverId, rxMessage->data + KEY_STATES_DELTA_HEADER_LENGTH);
+        uhkModuleState->keyStatesSequence = sequence;
+    }
+}
+
 void UhkModuleSlaveDriver_Init(uint8_t uhkModuleDriverId)
 {
     uhk_module_state_t *uhkModuleState = UhkModuleStates + uhkModuleDriverId;
@@ -70,6 +122,9 @@ void UhkModuleSlaveDriver_Init(uint8_t uhkModuleDriverId)
 
     uhkModuleState->pointerDelta.x = 0;
     uhkModuleState->pointerDelta.y = 0;
+
+    uhkModuleState->deltaKeyStates = false;
+    uhkModuleState->keyStatesSequence = KEY_STATES_UNKNOWN_SEQUENCE;
 }
 
 status_t UhkModuleSlaveDriver_Update(uint8_t uhkModuleDriverId)
@@ -129,6 +184,8 @@ status_t UhkModuleSlaveDriver_Update(uint8_t uhkModuleDriverId)
             bool isMessageValid = CRC16_IsMessageValid(rxMessage);
             if (isMessageValid) {
                 memcpy(&uhkModuleState->moduleProtocolVersion, rxMessage->data, sizeof(version_t));
+                // Since module protocol 4.2.0, modules send just a short message while keys and pointer stay still.
+                uhkModuleState->deltaKeyStates = isModuleProtocolAtLeast(&uhkModuleState->moduleProtocolVersion, 4, 2);
             }
             status = kStatus_Uhk_IdleCycle;
             *uhkModulePhase = isMessageValid ? UhkModulePhase_RequestFirmwareVersion : UhkModulePhase_RequestModuleProtocolVersion;
@@ -172,6 +229,9 @@ status_t UhkModuleSlaveDriver_Update(uint8_t uhkModuleDriverId)
         case UhkModulePhase_ProcessModuleId: {
             bool isMessageValid = CRC16_IsMessageValid(rxMessage);
             if (isMessageValid) {
+                if (uhkModuleState->moduleId != rxMessage->data[0]) {
+                    InvalidateKeymapCache();
+                }
                 uhkModuleState->moduleId = rxMessage->data[0];
             }
             status = kStatus_Uhk_IdleCycle;
@@ -194,7 +254,7 @@ status_t UhkModuleSlaveDriver_Update(uint8_t uhkModuleDriverId)
         case UhkModulePhase_ProcessModuleKeyCount: {
             bool isMessageValid = CRC16_IsMessageValid(rxMessage);
             if (isMessageValid) {
-                uhkModuleState->keyCount = rxMessage->data[0];
+                uhkModuleState->keyCount = MIN(rxMessage->data[0], MAX_KEY_COUNT_PER_MODULE);
             }
             status = kStatus_Uhk_IdleCycle;
             *uhkModulePhase = isMessageValid ? UhkModulePhase_RequestModulePointerCount : UhkModulePhase_RequestModuleKeyCount;
@@ -226,7 +286,8 @@ status_t UhkModuleSlaveDriver_Update(uint8_t uhkModuleDriverId)
         // Get key states
         case UhkModulePhase_RequestKeyStates:
             txMessage.data[0] = SlaveCommand_RequestKeyStates;
-            txMessage.length = 1;
+            txMessage.data[1] = uhkModuleState->keyStatesSequence;
+            txMessage.length = uhkModuleState->deltaKeyStates ? 2 : 1;
             status = tx(i2cAddress);
             *uhkModulePhase = UhkModulePhase_ReceiveKeystates;
             break;
@@ -235,18 +296,10 @@ status_t UhkModuleSlaveDriver_Update(uint8_t uhkModuleDriverId)
             *uhkModulePhase = UhkModulePhase_ProcessKeystates;
             break;
         case UhkModulePhase_ProcessKeystates:
-            if (CRC16_IsMessageValid(rxMessage)) {
-                uint8_t slotId = UhkModuleSlaveDriver_DriverIdToSlotId(uhkModuleDriverId);
-                BoolBitsToBytes(rxMessage->data, keyStatesBuffer, uhkModuleState->keyCount);
-                for (uint8_t keyId=0; keyId < uhkModuleState->keyCount; keyId++) {
-                    KeyStates[slotId][keyId].hardwareSwitchState = keyStatesBuffer[keyId];
-                }
-                if (uhkModuleState->pointerCount) {
-                    uint8_t keyStatesLength = BOOL_BYTES_TO_BITS_COUNT(uhkModuleState->keyCount);
-                    pointer_delta_t *pointerDelta = (pointer_delta_t*)(rxMessage->data + keyStatesLength);
-                    uhkModuleState->pointerDelta.x += pointerDelta->x;
-                    uhkModuleState->pointerDelta.y += pointerDelta->y;
-                }
+            if (uhkModuleState->deltaKeyStates) {
+                processDeltaKeyStates(uhkModuleDriverId);
+            } else if (CRC16_IsMessageValid(rxMessage)) {
+                applyKeyStates(uhkModuleDriverId, rxMessage->data);
             }
             status = kStatus_Uhk_IdleCycle;
             *uhkModulePhase = UhkModulePhase_SetTestLed;
@@ -295,6 +348,7 @@ void UhkModuleSlaveDriver_Disconnect(uint8_t uhkModuleDriverId)
     uint8_t slotId = UhkModuleSlaveDriver_DriverIdToSlotId(uhkModuleDriverId);
 
     if (IS_VALID_MODULE_SLOT(slotId)) {
-        memset(KeyStates[slotId], 0, MAX_KEY_COUNT_PER_MODULE * sizeof(key_state_t));
+        KeyStateBits[slotId].hardware = 0;
+        KeyStateBits[slotId].resetRequested = true;
     }
 }
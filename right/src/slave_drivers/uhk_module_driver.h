@@ -84,6 +84,8 @@
         uint8_t keyCount;
         uint8_t pointerCount;
         pointer_delta_t pointerDelta;
+        bool deltaKeyStates;
+        uint8_t keyStatesSequence;
     } uhk_module_state_t;
 
     typedef struct {
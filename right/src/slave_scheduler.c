@@ -9,11 +9,20 @@
 #include "i2c_addresses.h"
 #include "config.h"
 #include "i2c_error_logger.h"
+#include "keymap.h"
+#include "perf_probes.h"
+#include "timer.h"
 
 uint32_t I2cSlaveScheduler_Counter;
+uint8_t I2cSlaveScheduler_KeySlaveWeight = SLAVE_DEFAULT_KEY_SLAVE_WEIGHT;
 
 static uint8_t previousSlaveId;
 static uint8_t currentSlaveId;
+static uint8_t rotation;
+
+#ifdef PERF_PROBES
+static uint32_t transferStartTime;
+#endif
 
 uhk_slave_t Slaves[SLAVE_COUNT] = {
     {
@@ -21,24 +30,28 @@ uhk_slave_t Slaves[SLAVE_COUNT] = {
         .update = UhkModuleSlaveDriver_Update,
         .disconnect = UhkModuleSlaveDriver_Disconnect,
         .perDriverId = UhkModuleDriverId_LeftKeyboardHalf,
+        .isKeySlave = true,
     },
     {
         .init = UhkModuleSlaveDriver_Init,
         .update = UhkModuleSlaveDriver_Update,
         .disconnect = UhkModuleSlaveDriver_Disconnect,
         .perDriverId = UhkModuleDriverId_LeftModule,
+        .isKeySlave = true,
     },
     {
         .init = UhkModuleSlaveDriver_Init,
         .update = UhkModuleSlaveDriver_Update,
         .disconnect = UhkModuleSlaveDriver_Disconnect,
         .perDriverId = UhkModuleDriverId_RightModule,
+        .isKeySlave = true,
     },
     {
         .init = TouchpadDriver_Init,
         .update = TouchpadDriver_Update,
         .disconnect = TouchpadDriver_Disconnect,
         .perDriverId = TouchpadDriverId_Singleton,
+        .isKeySlave = true,
     },
     {
         .init = LedSlaveDriver_Init,
@@ -62,12 +75,58 @@ uhk_slave_t Slaves[SLAVE_COUNT] = {
     },
 };
 
+/**
+ * Slaves which are not key slaves only get their turn in every
+ * I2cSlaveScheduler_KeySlaveWeight-th rotation, and disconnected slaves are
+ * probed with an exponential backoff. Both are ignored once a whole rotation
+ * passes without a transfer, so that the scheduler never stalls.
+ */
+static bool shouldSkipSlave(uhk_slave_t *slave, uint8_t visitedSlaveCount)
+{
+    if (visitedSlaveCount >= SLAVE_COUNT) {
+        return false;
+    }
+    if (!slave->isKeySlave && I2cSlaveScheduler_KeySlaveWeight > 1 && rotation % I2cSlaveScheduler_KeySlaveWeight != 0) {
+        return true;
+    }
+    return !slave->isConnected && (int32_t)(CurrentTime - slave->nextReconnectTime) < 0;
+}
+
+static void recordTransfer(uhk_slave_t *slave)
+{
+    uint32_t now = Timer_GetCurrentTimeMicros();
+    if (slave->transferCount > 0) {
+        slave->turnLatencySum += now - slave->lastTransferTime;
+    }
+    slave->lastTransferTime = now;
+    slave->transferCount++;
+}
+
+static void updateReconnectBackoff(uhk_slave_t *slave)
+{
+    if (slave->isConnected) {
+        slave->reconnectBackoff = 0;
+        return;
+    }
+    slave->reconnectBackoff = slave->reconnectBackoff == 0
+        ? SLAVE_RECONNECT_MIN_BACKOFF
+        : MIN(slave->reconnectBackoff * 2, SLAVE_RECONNECT_MAX_BACKOFF);
+    slave->nextReconnectTime = CurrentTime + slave->reconnectBackoff;
+}
+
 static void slaveSchedulerCallback(I2C_Type *base, i2c_master_handle_t *handle, status_t previousStatus, void *userData)
 {
     bool isFirstCycle = true;
     bool isTransferScheduled = false;
+    uint8_t visitedSlaveCount = 0;
     I2cSlaveScheduler_Counter++;
 
+#ifdef PERF_PROBES
+    if (transferStartTime) {
+        PerfProbe_Record(PerfProbeId_I2cRoundTrip, Timer_GetCurrentTimeMicros() - transferStartTime);
+    }
+#endif
+
     do {
         uhk_slave_t *currentSlave = Slaves + currentSlaveId;
 
@@ -80,6 +139,10 @@ static void slaveSchedulerCallback(I2C_Type *base, i2c_master_handle_t *handle,
 
             bool wasPreviousSlaveConnected = previousSlave->isConnected;
             previousSlave->isConnected = previousStatus == kStatus_Success;
+            updateReconnectBackoff(previousSlave);
+            if (wasPreviousSlaveConnected != previousSlave->isConnected) {
+                InvalidateKeymapCache();
+            }
             if (wasPreviousSlaveConnected && !previousSlave->isConnected && previousSlave->disconnect) {
                 previousSlave->disconnect(previousSlaveId);
             }
@@ -87,6 +150,15 @@ static void slaveSchedulerCallback(I2C_Type *base, i2c_master_handle_t *handle,
             isFirstCycle = false;
         }
 
+        if (shouldSkipSlave(currentSlave, visitedSlaveCount)) {
+            visitedSlaveCount++;
+            if (++currentSlaveId >= SLAVE_COUNT) {
+                currentSlaveId = 0;
+                rotation++;
+            }
+            continue;
+        }
+
         if (!currentSlave->isConnected) {
             currentSlave->init(currentSlave->perDriverId);
         }
@@ -96,15 +168,24 @@ static void slaveSchedulerCallback(I2C_Type *base, i2c_master_handle_t *handle,
             LogI2cError(currentSlaveId, currentStatus);
         }
         isTransferScheduled = currentStatus != kStatus_Uhk_IdleSlave && currentStatus != kStatus_Uhk_IdleCycle;
+        if (isTransferScheduled) {
+            recordTransfer(currentSlave);
+        }
 
         if (currentStatus != kStatus_Uhk_IdleCycle) {
+            visitedSlaveCount++;
             previousSlaveId = currentSlaveId++;
             if (currentSlaveId >= SLAVE_COUNT) {
                 currentSlaveId = 0;
+                rotation++;
             }
         }
 
     } while (!isTransferScheduled);
+
+#ifdef PERF_PROBES
+    transferStartTime = Timer_GetCurrentTimeMicros();
+#endif
 }
 
 void InitSlaveScheduler(void)
@@ -115,6 +196,9 @@ void InitSlaveScheduler(void)
     for (uint8_t i=0; i<SLAVE_COUNT; i++) {
         uhk_slave_t *currentSlave = Slaves + i;
         currentSlave->isConnected = false;
+        currentSlave->reconnectBackoff = 0;
+        currentSlave->nextReconnectTime = 0;
+        SlaveScheduler_ResetStats(i);
     }
 
     I2C_MasterTransferCreateHandle(I2C_MAIN_BUS_BASEADDR, &I2cMasterHandle, slaveSchedulerCallback, NULL);
@@ -122,3 +206,10 @@ void InitSlaveScheduler(void)
     // Kickstart the scheduler by triggering the first transfer.
     slaveSchedulerCallback(I2C_MAIN_BUS_BASEADDR, &I2cMasterHandle, kStatus_Fail, NULL);
 }
+
+void SlaveScheduler_ResetStats(uint8_t slaveId)
+{
+    uhk_slave_t *slave = Slaves + slaveId;
+    slave->transferCount = 0;
+    slave->turnLatencySum = 0;
+}
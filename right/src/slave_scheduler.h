@@ -12,6 +12,10 @@
     #define IS_VALID_SLAVE_ID(slaveId) (0 <= slaveId && slaveId < SLAVE_COUNT)
     #define IS_STATUS_I2C_ERROR(status) (kStatus_I2C_Busy <= status && status <= kStatus_I2C_Timeout)
 
+    #define SLAVE_DEFAULT_KEY_SLAVE_WEIGHT 2
+    #define SLAVE_RECONNECT_MIN_BACKOFF 1 // ms
+    #define SLAVE_RECONNECT_MAX_BACKOFF 256 // ms
+
 // Typedefs:
 
     typedef enum { // Slaves[] is meant to be indexed with these values
@@ -34,8 +38,14 @@
         slave_init_t *init;
         slave_update_t *update;
         slave_disconnect_t *disconnect;
+        bool isKeySlave; // gets I2cSlaveScheduler_KeySlaveWeight turns per turn of the other slaves
         bool isConnected;
         status_t previousStatus;
+        uint16_t reconnectBackoff; // ms
+        uint32_t nextReconnectTime;
+        uint32_t transferCount;
+        uint32_t lastTransferTime; // us
+        uint64_t turnLatencySum; // us between consecutive transfers
     } uhk_slave_t;
 
     typedef enum {
@@ -51,9 +61,11 @@
 
     extern uhk_slave_t Slaves[SLAVE_COUNT];
     extern uint32_t I2cSlaveScheduler_Counter;
+    extern uint8_t I2cSlaveScheduler_KeySlaveWeight;
 
 // Functions:
 
     void InitSlaveScheduler(void);
+    void SlaveScheduler_ResetStats(uint8_t slaveId);
 
 #endif
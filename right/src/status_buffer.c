@@ -0,0 +1,117 @@
+#include "status_buffer.h"
+#include "timer.h"
+
+/**
+ * The status buffer is a ring log. Writers append at the head and overwrite
+ * the oldest text once the ring is full. Text between the tail and the head
+ * is readable - by printStatus, which types it out and consumes it, and by the
+ * GetStatusBuffer usb command, which streams it out without consuming it.
+ *
+ * Warnings and errors start a new entry, which is tagged with its severity
+ * and a timestamp, e.g., "[E 123456] ". Plain status text is left untagged,
+ * so that `setStatus` + `printStatus` types exactly what was set.
+ */
+
+static char buffer[STATUS_BUFFER_SIZE];
+
+volatile uint32_t StatusBuffer_Head = 0;
+volatile uint32_t StatusBuffer_Tail = 0;
+
+// While printStatus types the ring, new text is dropped. Otherwise printing
+// would never catch up with the head, and an overwrite could move the tail
+// under the text which is being typed.
+static bool printing = false;
+
+// Tells whether the position lies within the readable text.
+static bool isReadable(uint32_t position, uint32_t tail, uint32_t head)
+{
+    return position - tail <= head - tail;
+}
+
+// The tail is moved before the oldest character gets overwritten, so that
+// text between the tail and the head is valid at any time, even for the
+// usb interrupt which may preempt this.
+void StatusBuffer_Append(char c)
+{
+    if (printing) {
+        return;
+    }
+    if (StatusBuffer_Head - StatusBuffer_Tail == STATUS_BUFFER_SIZE) {
+        StatusBuffer_Tail++;
+    }
+    buffer[StatusBuffer_Head & (STATUS_BUFFER_SIZE-1)] = c;
+    StatusBuffer_Head++;
+}
+
+static void appendNum(uint32_t n)
+{
+    char digits[10];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + n % 10;
+        n /= 10;
+    } while (n > 0);
+    while (count > 0) {
+        StatusBuffer_Append(digits[--count]);
+    }
+}
+
+void StatusBuffer_BeginEntry(status_severity_t severity)
+{
+    if (StatusBuffer_Head != StatusBuffer_Tail && buffer[(StatusBuffer_Head-1) & (STATUS_BUFFER_SIZE-1)] != '\n') {
+        StatusBuffer_Append('\n');
+    }
+    StatusBuffer_Append('[');
+    StatusBuffer_Append(severity == StatusSeverity_Error ? 'E' : 'W');
+    StatusBuffer_Append(' ');
+    appendNum(CurrentTime);
+    StatusBuffer_Append(']');
+    StatusBuffer_Append(' ');
+}
+
+void StatusBuffer_Clear(void)
+{
+    StatusBuffer_Tail = StatusBuffer_Head;
+}
+
+void StatusBuffer_SetPrinting(bool isPrinting)
+{
+    printing = isPrinting;
+}
+
+void StatusBuffer_Consume(uint32_t position)
+{
+    if (isReadable(position, StatusBuffer_Tail, StatusBuffer_Head)) {
+        StatusBuffer_Tail = position;
+    }
+}
+
+// Returns the length of text which is stored contiguously from the given
+// position, which has to be readable. Meant for the main loop only.
+uint16_t StatusBuffer_ContiguousLength(uint32_t position, const char **text)
+{
+    uint32_t head = StatusBuffer_Head;
+    uint32_t offset = position & (STATUS_BUFFER_SIZE-1);
+    uint32_t length = head - position;
+    if (length > STATUS_BUFFER_SIZE - offset) {
+        length = STATUS_BUFFER_SIZE - offset;
+    }
+    *text = buffer + offset;
+    return length;
+}
+
+// Copies up to maxLength characters starting at *position, which is moved
+// forward to the oldest readable text if the requested one is gone.
+uint16_t StatusBuffer_Read(uint32_t *position, char *dst, uint16_t maxLength)
+{
+    uint32_t tail = StatusBuffer_Tail;
+    uint32_t head = StatusBuffer_Head;
+    if (!isReadable(*position, tail, head)) {
+        *position = tail;
+    }
+    uint16_t length = head - *position < maxLength ? head - *position : maxLength;
+    for (uint16_t i = 0; i < length; i++) {
+        dst[i] = buffer[(*position + i) & (STATUS_BUFFER_SIZE-1)];
+    }
+    return length;
+}
@@ -0,0 +1,41 @@
+#ifndef __STATUS_BUFFER_H__
+#define __STATUS_BUFFER_H__
+
+// Includes:
+
+    #include <stdint.h>
+    #include <stdbool.h>
+
+// Macros:
+
+    #define STATUS_BUFFER_SIZE 1024
+
+    #if STATUS_BUFFER_SIZE & (STATUS_BUFFER_SIZE-1)
+    #error STATUS_BUFFER_SIZE has to be a power of two.
+    #endif
+
+// Typedefs:
+
+    typedef enum {
+        StatusSeverity_Warning,
+        StatusSeverity_Error,
+    } status_severity_t;
+
+// Variables:
+
+    // Positions count every character ever written, so a reader can tell
+    // whether the text it wants has been overwritten in the meantime.
+    extern volatile uint32_t StatusBuffer_Head;
+    extern volatile uint32_t StatusBuffer_Tail;
+
+// Functions:
+
+    void StatusBuffer_Append(char c);
+    void StatusBuffer_BeginEntry(status_severity_t severity);
+    void StatusBuffer_Clear(void);
+    void StatusBuffer_SetPrinting(bool isPrinting);
+    void StatusBuffer_Consume(uint32_t position);
+    uint16_t StatusBuffer_Read(uint32_t *position, char *dst, uint16_t maxLength);
+    uint16_t StatusBuffer_ContiguousLength(uint32_t position, const char **text);
+
+#endif
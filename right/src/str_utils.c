@@ -98,6 +98,17 @@ bool StrLessOrEqual(const char* a, const char* aEnd, const char* b, const char*
 }
 
 
+// 32-bit FNV-1a with the offset basis perturbed by the seed.
+uint32_t StrHash(uint8_t seed, const char* str, const char* strEnd)
+{
+    uint32_t hash = 2166136261UL ^ seed;
+    for (; str < strEnd; str++) {
+        hash ^= (uint8_t)*str;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 bool StrEqual(const char* a, const char* aEnd, const char* b, const char* bEnd)
 {
     while(true) {
@@ -15,6 +15,7 @@
     int32_t ParseInt32_2(const char *a, const char *aEnd, const char* *parsedTill);
     bool StrLessOrEqual(const char* a, const char* aEnd, const char* b, const char* bEnd);
     bool StrEqual(const char* a, const char* aEnd, const char* b, const char* bEnd);
+    uint32_t StrHash(uint8_t seed, const char* str, const char* strEnd);
     const char* FindChar(char c, const char* str, const char* strEnd);
     bool TokenMatches(const char *a, const char *aEnd, const char *b);
     bool TokenMatches2(const char *a, const char *aEnd, const char *b, const char *bEnd);
@@ -108,6 +108,7 @@ static const key_action_t TestKeymap[1][2][MAX_KEY_COUNT_PER_MODULE] = {
 
 void TestSwitches_Activate(void)
 {
-    memcpy(&CurrentKeymap, &TestKeymap, sizeof TestKeymap);
+    memcpy(CurrentKeymap, &TestKeymap, sizeof TestKeymap);
+    InvalidateKeymapCache();
     LedDisplay_SetText(3, "TES");
 }
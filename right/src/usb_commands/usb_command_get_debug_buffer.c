@@ -7,6 +7,7 @@
 #include "timer.h"
 #include "right_key_matrix.h"
 #include "usb_report_updater.h"
+#include "keymap.h"
 #include "usb_interfaces/usb_interface_basic_keyboard.h"
 #include "usb_interfaces/usb_interface_media_keyboard.h"
 #include "usb_interfaces/usb_interface_system_keyboard.h"
@@ -28,6 +29,8 @@ void UsbCommand_GetDebugBuffer(void)
     SetDebugBufferUint32(37, UsbMediaKeyboardActionCounter);
     SetDebugBufferUint32(41, UsbSystemKeyboardActionCounter);
     SetDebugBufferUint32(45, UsbMouseActionCounter);
+    SetDebugBufferUint32(49, KeymapSwitchLatencyMicros);
+    SetDebugBufferUint32(53, UsbReportUpdateFastPathCounter);
 
     memcpy(GenericHidInBuffer, DebugBuffer, USB_GENERIC_HID_IN_BUFFER_LENGTH);
 }
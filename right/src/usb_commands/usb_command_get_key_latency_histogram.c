@@ -0,0 +1,18 @@
+#include "usb_commands/usb_command_get_key_latency_histogram.h"
+#include "usb_protocol_handler.h"
+#include "usb_report_updater.h"
+
+void UsbCommand_GetKeyLatencyHistogram(void)
+{
+    bool reset = GetUsbRxBufferUint8(1);
+
+    SetUsbTxBufferUint8(1, KEY_LATENCY_HISTOGRAM_BUCKET_COUNT);
+    SetUsbTxBufferUint16(2, KEY_LATENCY_HISTOGRAM_BUCKET_WIDTH);
+    for (uint8_t i = 0; i < KEY_LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+        SetUsbTxBufferUint32(4 + i*sizeof(uint32_t), KeyLatencyHistogram[i]);
+    }
+
+    if (reset) {
+        memset(KeyLatencyHistogram, 0, sizeof KeyLatencyHistogram);
+    }
+}
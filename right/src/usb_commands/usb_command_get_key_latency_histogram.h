@@ -0,0 +1,8 @@
+#ifndef __USB_COMMAND_GET_KEY_LATENCY_HISTOGRAM_H__
+#define __USB_COMMAND_GET_KEY_LATENCY_HISTOGRAM_H__
+
+// Functions:
+
+    void UsbCommand_GetKeyLatencyHistogram(void);
+
+#endif
@@ -0,0 +1,30 @@
+#include "usb_commands/usb_command_get_perf_stats.h"
+#include "usb_protocol_handler.h"
+#include "perf_probes.h"
+
+void UsbCommand_GetPerfStats(void)
+{
+    uint8_t probeId = GetUsbRxBufferUint8(1);
+    bool reset = GetUsbRxBufferUint8(2);
+
+    if (probeId >= PerfProbeId_Count) {
+        SetUsbTxBufferUint8(0, UsbStatusCode_GetPerfStats_InvalidProbeId);
+        return;
+    }
+
+    perf_probe_t *probe = PerfProbes + probeId;
+
+    SetUsbTxBufferUint8(1, PerfProbeId_Count);
+    SetUsbTxBufferUint8(2, PERF_PROBE_BUCKET_COUNT);
+    SetUsbTxBufferUint32(3, probe->count);
+    SetUsbTxBufferUint32(7, probe->min);
+    SetUsbTxBufferUint32(11, probe->max);
+    SetUsbTxBufferUint32(15, probe->count ? probe->total / probe->count : 0);
+    for (uint8_t i = 0; i < PERF_PROBE_BUCKET_COUNT; i++) {
+        SetUsbTxBufferUint16(19 + i*sizeof(uint16_t), probe->buckets[i]);
+    }
+
+    if (reset) {
+        PerfProbe_Reset(probeId);
+    }
+}
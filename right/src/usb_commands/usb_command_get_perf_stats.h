@@ -0,0 +1,14 @@
+#ifndef __USB_COMMAND_GET_PERF_STATS_H__
+#define __USB_COMMAND_GET_PERF_STATS_H__
+
+// Functions:
+
+    void UsbCommand_GetPerfStats(void);
+
+// Typedefs:
+
+    typedef enum {
+        UsbStatusCode_GetPerfStats_InvalidProbeId = 2,
+    } usb_status_code_get_perf_stats_t;
+
+#endif
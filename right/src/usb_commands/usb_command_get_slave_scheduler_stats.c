@@ -0,0 +1,30 @@
+#include "usb_commands/usb_command_get_slave_scheduler_stats.h"
+#include "usb_protocol_handler.h"
+#include "slave_scheduler.h"
+
+void UsbCommand_GetSlaveSchedulerStats(void)
+{
+    uint8_t slaveId = GetUsbRxBufferUint8(1);
+    bool reset = GetUsbRxBufferUint8(2);
+
+    if (!IS_VALID_SLAVE_ID(slaveId)) {
+        SetUsbTxBufferUint8(0, UsbStatusCode_GetSlaveSchedulerStats_InvalidSlaveId);
+        return;
+    }
+
+    uhk_slave_t *slave = Slaves + slaveId;
+    uint32_t transferCount = slave->transferCount;
+    uint32_t averageTurnLatency = transferCount > 1 ? slave->turnLatencySum / (transferCount - 1) : 0;
+
+    SetUsbTxBufferUint8(1, SLAVE_COUNT);
+    SetUsbTxBufferUint8(2, slave->isConnected);
+    SetUsbTxBufferUint8(3, slave->isKeySlave);
+    SetUsbTxBufferUint32(4, transferCount);
+    SetUsbTxBufferUint32(8, averageTurnLatency);
+    SetUsbTxBufferUint16(12, slave->reconnectBackoff);
+    SetUsbTxBufferUint8(14, I2cSlaveScheduler_KeySlaveWeight);
+
+    if (reset) {
+        SlaveScheduler_ResetStats(slaveId);
+    }
+}
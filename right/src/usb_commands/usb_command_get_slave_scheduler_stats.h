@@ -0,0 +1,14 @@
+#ifndef __USB_COMMAND_GET_SLAVE_SCHEDULER_STATS_H__
+#define __USB_COMMAND_GET_SLAVE_SCHEDULER_STATS_H__
+
+// Functions:
+
+    void UsbCommand_GetSlaveSchedulerStats(void);
+
+// Typedefs:
+
+    typedef enum {
+        UsbStatusCode_GetSlaveSchedulerStats_InvalidSlaveId = 2,
+    } usb_status_code_get_slave_scheduler_stats_t;
+
+#endif
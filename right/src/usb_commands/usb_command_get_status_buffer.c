@@ -0,0 +1,21 @@
+#include "usb_commands/usb_command_get_status_buffer.h"
+#include "usb_protocol_handler.h"
+#include "usb_interfaces/usb_interface_generic_hid.h"
+#include "status_buffer.h"
+
+// Streams the status buffer out without consuming it. The host passes the
+// position it wants to continue from and gets back where the returned chunk
+// really starts, which is later if the text in between has been overwritten.
+void UsbCommand_GetStatusBuffer(void)
+{
+    uint32_t position = GetUsbRxBufferUint32(1);
+    uint16_t length = StatusBuffer_Read(
+        &position,
+        (char*)GenericHidInBuffer + USB_STATUS_BUFFER_CHUNK_OFFSET,
+        USB_GENERIC_HID_IN_BUFFER_LENGTH - USB_STATUS_BUFFER_CHUNK_OFFSET
+    );
+
+    SetUsbTxBufferUint32(1, StatusBuffer_Head);
+    SetUsbTxBufferUint32(5, position);
+    SetUsbTxBufferUint8(9, length);
+}
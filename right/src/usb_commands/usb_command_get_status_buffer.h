@@ -0,0 +1,12 @@
+#ifndef __USB_COMMAND_GET_STATUS_BUFFER_H__
+#define __USB_COMMAND_GET_STATUS_BUFFER_H__
+
+// Macros:
+
+    #define USB_STATUS_BUFFER_CHUNK_OFFSET 10
+
+// Functions:
+
+    void UsbCommand_GetStatusBuffer(void);
+
+#endif
@@ -24,5 +24,8 @@ void UsbCommand_GetVariable(void)
         case UsbVariable_UsbReportSemaphore:
             SetUsbTxBufferUint8(1, UsbReportUpdateSemaphore);
             break;
+        case UsbVariable_EagerKeyPresses:
+            SetUsbTxBufferUint8(1, EagerKeyPresses);
+            break;
     }
 }
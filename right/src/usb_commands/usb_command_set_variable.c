@@ -27,5 +27,8 @@ void UsbCommand_SetVariable(void)
         case UsbVariable_UsbReportSemaphore:
             UsbReportUpdateSemaphore = GetUsbRxBufferUint8(2);
             break;
+        case UsbVariable_EagerKeyPresses:
+            EagerKeyPresses = GetUsbRxBufferUint8(2);
+            break;
     }
 }
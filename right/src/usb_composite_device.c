@@ -160,6 +160,34 @@ static usb_device_class_config_list_struct_t UsbDeviceCompositeConfigList = {
                 }}
             }}
         }}
+    },
+    {
+        .classCallback = UsbNkroKeyboardCallback,
+        .classInfomation = (usb_device_class_struct_t[]) {{
+            .type = kUSB_DeviceClassTypeHid,
+            .configurations = USB_DEVICE_CONFIGURATION_COUNT,
+            .interfaceList = (usb_device_interface_list_t[USB_DEVICE_CONFIGURATION_COUNT]) {{
+                .count = USB_NKRO_KEYBOARD_INTERFACE_COUNT,
+                .interfaces = (usb_device_interfaces_struct_t[USB_NKRO_KEYBOARD_INTERFACE_COUNT]) {{
+                    .classCode = USB_CLASS_HID,
+                    .subclassCode = USB_HID_SUBCLASS_NONE,
+                    .protocolCode = USB_HID_PROTOCOL_NONE,
+                    .interfaceNumber = USB_NKRO_KEYBOARD_INTERFACE_INDEX,
+                    .count = 1,
+                    .interface = (usb_device_interface_struct_t[]) {{
+                        .alternateSetting = USB_INTERFACE_ALTERNATE_SETTING_NONE,
+                        .endpointList = {
+                            USB_NKRO_KEYBOARD_ENDPOINT_COUNT,
+                            (usb_device_endpoint_struct_t[USB_NKRO_KEYBOARD_ENDPOINT_COUNT]) {{
+                                .endpointAddress = USB_NKRO_KEYBOARD_ENDPOINT_INDEX | (USB_IN << USB_DESCRIPTOR_ENDPOINT_ADDRESS_DIRECTION_SHIFT),
+                                .transferType = USB_ENDPOINT_INTERRUPT,
+                                .maxPacketSize = USB_NKRO_KEYBOARD_INTERRUPT_IN_PACKET_SIZE,
+                            }}
+                        }
+                    }}
+                }}
+            }}
+        }}
     }
 }};
 
@@ -221,6 +249,7 @@ static usb_status_t usbDeviceCallback(usb_device_handle handle, uint32_t event,
             UsbMediaKeyboardSetConfiguration(UsbCompositeDevice.mediaKeyboardHandle, *temp8);
             UsbSystemKeyboardSetConfiguration(UsbCompositeDevice.systemKeyboardHandle, *temp8);
             UsbMouseSetConfiguration(UsbCompositeDevice.mouseHandle, *temp8);
+            UsbNkroKeyboardSetConfiguration(UsbCompositeDevice.nkroKeyboardHandle, *temp8);
             status = kStatus_USB_Success;
             break;
         case kUSB_DeviceEventGetConfiguration:
@@ -238,6 +267,7 @@ static usb_status_t usbDeviceCallback(usb_device_handle handle, uint32_t event,
                     UsbMediaKeyboardSetInterface(UsbCompositeDevice.mediaKeyboardHandle, interface, alternateSetting);
                     UsbSystemKeyboardSetInterface(UsbCompositeDevice.systemKeyboardHandle, interface, alternateSetting);
                     UsbMouseSetInterface(UsbCompositeDevice.mouseHandle, interface, alternateSetting);
+                    UsbNkroKeyboardSetInterface(UsbCompositeDevice.nkroKeyboardHandle, interface, alternateSetting);
                     status = kStatus_USB_Success;
                 }
             }
@@ -302,6 +332,7 @@ void InitUsb(void)
     UsbCompositeDevice.mediaKeyboardHandle = UsbDeviceCompositeConfigList.config[USB_MEDIA_KEYBOARD_INTERFACE_INDEX].classHandle;
     UsbCompositeDevice.systemKeyboardHandle = UsbDeviceCompositeConfigList.config[USB_SYSTEM_KEYBOARD_INTERFACE_INDEX].classHandle;
     UsbCompositeDevice.mouseHandle = UsbDeviceCompositeConfigList.config[USB_MOUSE_INTERFACE_INDEX].classHandle;
+    UsbCompositeDevice.nkroKeyboardHandle = UsbDeviceCompositeConfigList.config[USB_NKRO_KEYBOARD_INTERFACE_INDEX].classHandle;
 
     uint8_t usbDeviceKhciIrq[] = USB_IRQS;
     uint8_t irqNumber = usbDeviceKhciIrq[CONTROLLER_ID - kUSB_ControllerKhci0];
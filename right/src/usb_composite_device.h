@@ -21,6 +21,7 @@
         class_handle_t genericHidHandle;
         class_handle_t mediaKeyboardHandle;
         class_handle_t systemKeyboardHandle;
+        class_handle_t nkroKeyboardHandle;
         uint8_t attach;
         uint8_t currentConfiguration;
         uint8_t currentInterfaceAlternateSetting[USB_DEVICE_CONFIG_HID];
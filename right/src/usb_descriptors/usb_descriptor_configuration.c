@@ -180,6 +180,37 @@ uint8_t UsbConfigurationDescriptor[USB_CONFIGURATION_DESCRIPTOR_TOTAL_LENGTH] =
     USB_SHORT_GET_LOW(USB_MOUSE_INTERRUPT_IN_PACKET_SIZE),
     USB_SHORT_GET_HIGH(USB_MOUSE_INTERRUPT_IN_PACKET_SIZE),
     USB_MOUSE_INTERRUPT_IN_INTERVAL,
+
+    // NKRO keyboard interface descriptor
+    USB_DESCRIPTOR_LENGTH_INTERFACE,
+    USB_DESCRIPTOR_TYPE_INTERFACE,
+    USB_NKRO_KEYBOARD_INTERFACE_INDEX,
+    USB_INTERFACE_ALTERNATE_SETTING_NONE,
+    USB_NKRO_KEYBOARD_ENDPOINT_COUNT,
+    USB_CLASS_HID,
+    USB_HID_SUBCLASS_NONE,
+    USB_HID_PROTOCOL_NONE,
+    USB_STRING_DESCRIPTOR_NONE,
+
+    // NKRO keyboard HID descriptor
+    USB_DESCRIPTOR_LENGTH_HID,
+    USB_DESCRIPTOR_TYPE_HID,
+    USB_SHORT_GET_LOW(USB_HID_VERSION),
+    USB_SHORT_GET_HIGH(USB_HID_VERSION),
+    USB_HID_COUNTRY_CODE_NOT_SUPPORTED,
+    USB_REPORT_DESCRIPTOR_COUNT_PER_HID_DEVICE,
+    USB_DESCRIPTOR_TYPE_HID_REPORT,
+    USB_SHORT_GET_LOW(USB_NKRO_KEYBOARD_REPORT_DESCRIPTOR_LENGTH),
+    USB_SHORT_GET_HIGH(USB_NKRO_KEYBOARD_REPORT_DESCRIPTOR_LENGTH),
+
+    // NKRO keyboard endpoint descriptor
+    USB_DESCRIPTOR_LENGTH_ENDPOINT,
+    USB_DESCRIPTOR_TYPE_ENDPOINT,
+    USB_NKRO_KEYBOARD_ENDPOINT_INDEX | (USB_IN << USB_DESCRIPTOR_ENDPOINT_ADDRESS_DIRECTION_SHIFT),
+    USB_ENDPOINT_INTERRUPT,
+    USB_SHORT_GET_LOW(USB_NKRO_KEYBOARD_INTERRUPT_IN_PACKET_SIZE),
+    USB_SHORT_GET_HIGH(USB_NKRO_KEYBOARD_INTERRUPT_IN_PACKET_SIZE),
+    USB_NKRO_KEYBOARD_INTERRUPT_IN_INTERVAL,
 };
 
 usb_status_t USB_DeviceGetConfigurationDescriptor(
@@ -7,14 +7,15 @@
     #include "usb_interfaces/usb_interface_media_keyboard.h"
     #include "usb_interfaces/usb_interface_system_keyboard.h"
     #include "usb_interfaces/usb_interface_mouse.h"
+    #include "usb_interfaces/usb_interface_nkro_keyboard.h"
     #include "usb_interfaces/usb_interface_generic_hid.h"
 
 // Macros:
 
     #define USB_COMPOSITE_CONFIGURATION_INDEX 1
     #define USB_CONFIGURATION_DESCRIPTOR_TOTAL_LENGTH \
-    (5 * USB_DESCRIPTOR_LENGTH_INTERFACE + 5 * USB_DESCRIPTOR_LENGTH_HID + \
-    6 * USB_DESCRIPTOR_LENGTH_ENDPOINT + USB_DESCRIPTOR_LENGTH_CONFIGURE)
+    (6 * USB_DESCRIPTOR_LENGTH_INTERFACE + 6 * USB_DESCRIPTOR_LENGTH_HID + \
+    7 * USB_DESCRIPTOR_LENGTH_ENDPOINT + USB_DESCRIPTOR_LENGTH_CONFIGURE)
 
 // Variables:
 
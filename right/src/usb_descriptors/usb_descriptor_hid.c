@@ -2,6 +2,7 @@
 #include "usb_descriptor_hid.h"
 #include "usb_descriptor_mouse_report.h"
 #include "usb_descriptor_generic_hid_report.h"
+#include "usb_descriptor_nkro_keyboard_report.h"
 #include "usb_descriptor_configuration.h"
 
 #define USB_GENERIC_HID_DESCRIPTOR_INDEX \
@@ -23,6 +24,10 @@
     (USB_SYSTEM_KEYBOARD_HID_DESCRIPTOR_INDEX + USB_DESCRIPTOR_LENGTH_HID + \
     USB_DESCRIPTOR_LENGTH_ENDPOINT + USB_DESCRIPTOR_LENGTH_INTERFACE)
 
+#define USB_NKRO_KEYBOARD_HID_DESCRIPTOR_INDEX \
+    (USB_MOUSE_HID_DESCRIPTOR_INDEX + USB_DESCRIPTOR_LENGTH_HID + \
+    USB_DESCRIPTOR_LENGTH_ENDPOINT + USB_DESCRIPTOR_LENGTH_INTERFACE)
+
 usb_status_t USB_DeviceGetHidDescriptor(
     usb_device_handle handle, usb_device_get_hid_descriptor_struct_t *hidDescriptor)
 {
@@ -44,6 +49,9 @@ usb_status_t USB_DeviceGetHidDescriptor(
         case USB_MOUSE_INTERFACE_INDEX:
             hidDescriptor->buffer = &UsbConfigurationDescriptor[USB_MOUSE_HID_DESCRIPTOR_INDEX];
             break;
+        case USB_NKRO_KEYBOARD_INTERFACE_INDEX:
+            hidDescriptor->buffer = &UsbConfigurationDescriptor[USB_NKRO_KEYBOARD_HID_DESCRIPTOR_INDEX];
+            break;
         default:
             return kStatus_USB_InvalidRequest;
     }
@@ -74,6 +82,11 @@ usb_status_t USB_DeviceGetHidReportDescriptor(
             hidReportDescriptor->buffer = UsbMouseReportDescriptor;
             hidReportDescriptor->length = USB_MOUSE_REPORT_DESCRIPTOR_LENGTH;
             break;
+        case USB_NKRO_KEYBOARD_INTERFACE_INDEX:
+            hidReportDescriptor->buffer = UsbNkroKeyboardReportDescriptor;
+            hidReportDescriptor->length = USB_NKRO_KEYBOARD_REPORT_DESCRIPTOR_LENGTH;
+            UsbNkroKeyboardUsedByHost = true;
+            break;
         default:
             return kStatus_USB_InvalidRequest;
     }
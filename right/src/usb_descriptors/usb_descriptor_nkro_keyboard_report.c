@@ -0,0 +1,35 @@
+#include "usb_api.h"
+#include "usb_descriptor_nkro_keyboard_report.h"
+
+uint8_t UsbNkroKeyboardReportDescriptor[USB_NKRO_KEYBOARD_REPORT_DESCRIPTOR_LENGTH] = {
+    HID_RI_USAGE_PAGE(8, HID_RI_USAGE_PAGE_GENERIC_DESKTOP),
+    HID_RI_USAGE(8, HID_RI_USAGE_GENERIC_DESKTOP_KEYBOARD),
+    HID_RI_COLLECTION(8, HID_RI_COLLECTION_APPLICATION),
+
+        // Modifiers
+        HID_RI_USAGE_PAGE(8, HID_RI_USAGE_PAGE_KEY_CODES),
+        HID_RI_USAGE_MINIMUM(8, 0xE0),
+        HID_RI_USAGE_MAXIMUM(8, 0xE7),
+        HID_RI_LOGICAL_MINIMUM(8, 0x00),
+        HID_RI_LOGICAL_MAXIMUM(8, 0x01),
+        HID_RI_REPORT_SIZE(8, 0x01),
+        HID_RI_REPORT_COUNT(8, 0x08),
+        HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+
+        // Reserved for future use, always 0
+        HID_RI_REPORT_COUNT(8, 0x01),
+        HID_RI_REPORT_SIZE(8, 0x08),
+        HID_RI_INPUT(8, HID_IOF_CONSTANT),
+
+        // Scancodes, one bit per key
+        HID_RI_USAGE_PAGE(8, HID_RI_USAGE_PAGE_KEY_CODES),
+        HID_RI_USAGE_MINIMUM(8, 0x00),
+        HID_RI_USAGE_MAXIMUM(8, USB_NKRO_KEYBOARD_MAX_SCANCODE),
+        HID_RI_LOGICAL_MINIMUM(8, 0x00),
+        HID_RI_LOGICAL_MAXIMUM(8, 0x01),
+        HID_RI_REPORT_SIZE(8, 0x01),
+        HID_RI_REPORT_COUNT(8, USB_NKRO_KEYBOARD_MAX_SCANCODE + 1),
+        HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+
+    HID_RI_END_COLLECTION(0),
+};
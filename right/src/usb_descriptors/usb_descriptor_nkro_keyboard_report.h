@@ -0,0 +1,16 @@
+#ifndef __USB_DESCRIPTOR_NKRO_KEYBOARD_REPORT_H__
+#define __USB_DESCRIPTOR_NKRO_KEYBOARD_REPORT_H__
+
+// Macros:
+
+    #define USB_NKRO_KEYBOARD_REPORT_DESCRIPTOR_LENGTH 45
+
+    // Scancodes up to this one are reported in the bitfield, modifiers have their own byte.
+    #define USB_NKRO_KEYBOARD_MAX_SCANCODE 0xDF
+    #define USB_NKRO_KEYBOARD_BITFIELD_LENGTH ((USB_NKRO_KEYBOARD_MAX_SCANCODE + 1) / 8)
+
+// Variables:
+
+    extern uint8_t UsbNkroKeyboardReportDescriptor[USB_NKRO_KEYBOARD_REPORT_DESCRIPTOR_LENGTH];
+
+#endif
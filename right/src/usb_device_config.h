@@ -9,6 +9,7 @@
 #include "usb_interfaces/usb_interface_media_keyboard.h"
 #include "usb_interfaces/usb_interface_system_keyboard.h"
 #include "usb_interfaces/usb_interface_mouse.h"
+#include "usb_interfaces/usb_interface_nkro_keyboard.h"
 
 // Device instance count, the sum of KHCI and EHCI instance counts
 #define USB_DEVICE_CONFIG_NUM 1
@@ -19,7 +20,8 @@
     USB_BASIC_KEYBOARD_INTERFACE_COUNT + \
     USB_MEDIA_KEYBOARD_INTERFACE_COUNT + \
     USB_SYSTEM_KEYBOARD_INTERFACE_COUNT + \
-    USB_MOUSE_INTERFACE_COUNT \
+    USB_MOUSE_INTERFACE_COUNT + \
+    USB_NKRO_KEYBOARD_INTERFACE_COUNT \
 )
 
 // Whether the device is self-powered: 1 supported, 0 not supported
@@ -38,7 +40,8 @@
     USB_BASIC_KEYBOARD_ENDPOINT_COUNT + \
     USB_MEDIA_KEYBOARD_ENDPOINT_COUNT + \
     USB_SYSTEM_KEYBOARD_ENDPOINT_COUNT + \
-    USB_MOUSE_ENDPOINT_COUNT \
+    USB_MOUSE_ENDPOINT_COUNT + \
+    USB_NKRO_KEYBOARD_ENDPOINT_COUNT \
 )
 
 // The maximum buffer length for the KHCI DMA workaround
@@ -2,12 +2,18 @@
 #include "usb_composite_device.h"
 #include "usb_report_updater.h"
 #include "timer.h"
+#include "perf_probes.h"
 
 static usb_basic_keyboard_report_t usbBasicKeyboardReports[2];
+static usb_boot_keyboard_report_t usbBootKeyboardReports[2];
 static uint8_t usbBasicKeyboardProtocol = 1;
 static uint8_t usbBasicKeyboardInBuffer[USB_BASIC_KEYBOARD_REPORT_LENGTH];
 static uint32_t usbBasicKeyboardReportLastSendTime = 0;
 uint32_t UsbBasicKeyboardActionCounter;
+
+#ifdef PERF_PROBES
+static uint32_t usbBasicKeyboardSendStartTime;
+#endif
 usb_basic_keyboard_report_t* ActiveUsbBasicKeyboardReport = usbBasicKeyboardReports;
 
 static usb_basic_keyboard_report_t* GetInactiveUsbBasicKeyboardReport(void)
@@ -22,7 +28,38 @@ static void SwitchActiveUsbBasicKeyboardReport(void)
 
 void UsbBasicKeyboardResetActiveReport(void)
 {
-    bzero(ActiveUsbBasicKeyboardReport, USB_BASIC_KEYBOARD_REPORT_LENGTH);
+    bzero(ActiveUsbBasicKeyboardReport, sizeof(usb_basic_keyboard_report_t));
+}
+
+usb_basic_keyboard_report_t* UsbBasicKeyboardGetLastSentReport(void)
+{
+    return GetInactiveUsbBasicKeyboardReport();
+}
+
+// The NKRO interface is only used by hosts which asked for its report descriptor, and never
+// while the host has switched this interface to boot protocol.
+static bool isNkroKeyboardUsed(void)
+{
+    return UsbNkroKeyboardUsedByHost && usbBasicKeyboardProtocol == 1;
+}
+
+// Translates the active report to the boot report of this interface. If more than
+// USB_BASIC_KEYBOARD_MAX_KEYS keys are held, every scancode slot reports ErrorRollOver, as the HID
+// spec asks for, so that the host keeps its key state instead of seeing some keys released.
+static usb_boot_keyboard_report_t* getActiveBootReport(void)
+{
+    usb_boot_keyboard_report_t *bootReport = &usbBootKeyboardReports[ActiveUsbBasicKeyboardReport - usbBasicKeyboardReports];
+    bzero(bootReport, USB_BASIC_KEYBOARD_REPORT_LENGTH);
+    bootReport->modifiers = ActiveUsbBasicKeyboardReport->modifiers;
+    uint8_t scancode = UsbBasicKeyboardNextScancode(ActiveUsbBasicKeyboardReport, 0);
+    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS && scancode != 0; i++) {
+        bootReport->scancodes[i] = scancode;
+        scancode = UsbBasicKeyboardNextScancode(ActiveUsbBasicKeyboardReport, scancode);
+    }
+    if (scancode != 0) {
+        memset(bootReport->scancodes, HID_KEYBOARD_SC_ERROR_ROLLOVER, USB_BASIC_KEYBOARD_MAX_KEYS);
+    }
+    return bootReport;
 }
 
 usb_status_t UsbBasicKeyboardAction(void)
@@ -31,20 +68,40 @@ usb_status_t UsbBasicKeyboardAction(void)
         return kStatus_USB_Error; // The device is not attached
     }
 
-    usb_status_t usb_status = USB_DeviceHidSend(
-        UsbCompositeDevice.basicKeyboardHandle, USB_BASIC_KEYBOARD_ENDPOINT_INDEX,
-        (uint8_t *)ActiveUsbBasicKeyboardReport, USB_BASIC_KEYBOARD_REPORT_LENGTH);
+    usb_status_t usb_status;
+    if (isNkroKeyboardUsed()) {
+        usb_status = USB_DeviceHidSend(
+            UsbCompositeDevice.nkroKeyboardHandle, USB_NKRO_KEYBOARD_ENDPOINT_INDEX,
+            (uint8_t *)ActiveUsbBasicKeyboardReport, USB_NKRO_KEYBOARD_REPORT_LENGTH);
+    } else {
+        usb_status = USB_DeviceHidSend(
+            UsbCompositeDevice.basicKeyboardHandle, USB_BASIC_KEYBOARD_ENDPOINT_INDEX,
+            (uint8_t *)getActiveBootReport(), USB_BASIC_KEYBOARD_REPORT_LENGTH);
+    }
     if (usb_status == kStatus_USB_Success) {
         usbBasicKeyboardReportLastSendTime = CurrentTime;
         UsbBasicKeyboardActionCounter++;
         SwitchActiveUsbBasicKeyboardReport();
+#ifdef PERF_PROBES
+        usbBasicKeyboardSendStartTime = Timer_GetCurrentTimeMicros();
+#endif
     }
     return usb_status;
 }
 
+// Called when either the boot or the NKRO interface has finished sending a report.
+void UsbBasicKeyboardReportSent(void)
+{
+    UsbReportUpdateSemaphore &= ~(1 << USB_BASIC_KEYBOARD_INTERFACE_INDEX);
+#ifdef PERF_PROBES
+    PerfProbe_Record(PerfProbeId_UsbSend, Timer_GetCurrentTimeMicros() - usbBasicKeyboardSendStartTime);
+#endif
+}
+
 usb_status_t UsbBasicKeyboardCheckIdleElapsed()
 {
-    uint16_t idlePeriodMs = ((usb_device_hid_struct_t*)UsbCompositeDevice.basicKeyboardHandle)->idleRate * 4; // idleRate is in 4ms units.
+    class_handle_t handle = isNkroKeyboardUsed() ? UsbCompositeDevice.nkroKeyboardHandle : UsbCompositeDevice.basicKeyboardHandle;
+    uint16_t idlePeriodMs = ((usb_device_hid_struct_t*)handle)->idleRate * 4; // idleRate is in 4ms units.
     if (!idlePeriodMs) {
         return kStatus_USB_Busy;
     }
@@ -67,7 +124,7 @@ usb_status_t UsbBasicKeyboardCallback(class_handle_t handle, uint32_t event, voi
 
     switch (event) {
         case kUSB_DeviceHidEventSendResponse:
-            UsbReportUpdateSemaphore &= ~(1 << USB_BASIC_KEYBOARD_INTERFACE_INDEX);
+            UsbBasicKeyboardReportSent();
             if (UsbCompositeDevice.attach) {
                 error = kStatus_USB_Success;
             }
@@ -79,7 +136,7 @@ usb_status_t UsbBasicKeyboardCallback(class_handle_t handle, uint32_t event, voi
         case kUSB_DeviceHidEventGetReport: {
             usb_device_hid_report_struct_t *report = (usb_device_hid_report_struct_t*)param;
             if (report->reportType == USB_DEVICE_HID_REQUEST_GET_REPORT_TYPE_INPUT && report->reportId == 0 && report->reportLength <= USB_BASIC_KEYBOARD_REPORT_LENGTH) {
-                report->reportBuffer = (void*)ActiveUsbBasicKeyboardReport;
+                report->reportBuffer = (void*)getActiveBootReport();
 
                 usbBasicKeyboardReportLastSendTime = CurrentTime;
                 UsbBasicKeyboardActionCounter++;
@@ -152,3 +209,68 @@ usb_status_t UsbBasicKeyboardSetInterface(class_handle_t handle, uint8_t interfa
 {
     return kStatus_USB_Error;
 }
+
+void UsbBasicKeyboardAddScancode(usb_basic_keyboard_report_t* report, uint8_t scancode)
+{
+    if (scancode == 0) {
+        return;
+    } else if (scancode <= USB_NKRO_KEYBOARD_MAX_SCANCODE) {
+        report->bitfield[scancode / 8] |= 1 << (scancode % 8);
+    } else if (scancode >= HID_KEYBOARD_SC_LEFT_CONTROL && scancode <= HID_KEYBOARD_SC_RIGHT_GUI) {
+        report->modifiers |= 1 << (scancode - HID_KEYBOARD_SC_LEFT_CONTROL);
+    }
+}
+
+void UsbBasicKeyboardRemoveScancode(usb_basic_keyboard_report_t* report, uint8_t scancode)
+{
+    if (scancode == 0) {
+        return;
+    } else if (scancode <= USB_NKRO_KEYBOARD_MAX_SCANCODE) {
+        report->bitfield[scancode / 8] &= ~(1 << (scancode % 8));
+    } else if (scancode >= HID_KEYBOARD_SC_LEFT_CONTROL && scancode <= HID_KEYBOARD_SC_RIGHT_GUI) {
+        report->modifiers &= ~(1 << (scancode - HID_KEYBOARD_SC_LEFT_CONTROL));
+    }
+}
+
+bool UsbBasicKeyboardContainsScancode(const usb_basic_keyboard_report_t* report, uint8_t scancode)
+{
+    if (scancode == 0) {
+        return false;
+    } else if (scancode <= USB_NKRO_KEYBOARD_MAX_SCANCODE) {
+        return report->bitfield[scancode / 8] & (1 << (scancode % 8));
+    } else if (scancode >= HID_KEYBOARD_SC_LEFT_CONTROL && scancode <= HID_KEYBOARD_SC_RIGHT_GUI) {
+        return report->modifiers & (1 << (scancode - HID_KEYBOARD_SC_LEFT_CONTROL));
+    }
+    return false;
+}
+
+// Returns the lowest scancode of the bitfield which is greater than the given one, or 0 if there is none.
+uint8_t UsbBasicKeyboardNextScancode(const usb_basic_keyboard_report_t* report, uint8_t scancode)
+{
+    uint16_t from = scancode + 1;
+    while (from <= USB_NKRO_KEYBOARD_MAX_SCANCODE) {
+        uint8_t bits = report->bitfield[from / 8] >> (from % 8);
+        if (bits) {
+            return from + __builtin_ctz(bits);
+        }
+        from = (from | 7) + 1;
+    }
+    return 0;
+}
+
+uint8_t UsbBasicKeyboardScancodeCount(const usb_basic_keyboard_report_t* report)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < USB_NKRO_KEYBOARD_BITFIELD_LENGTH; i++) {
+        count += __builtin_popcount(report->bitfield[i]);
+    }
+    return count;
+}
+
+void UsbBasicKeyboardMergeReports(const usb_basic_keyboard_report_t* sourceReport, usb_basic_keyboard_report_t* targetReport)
+{
+    targetReport->modifiers |= sourceReport->modifiers;
+    for (uint8_t i = 0; i < USB_NKRO_KEYBOARD_BITFIELD_LENGTH; i++) {
+        targetReport->bitfield[i] |= sourceReport->bitfield[i];
+    }
+}
@@ -7,6 +7,7 @@
     #include "attributes.h"
     #include "usb_api.h"
     #include "usb_descriptors/usb_descriptor_basic_keyboard_report.h"
+    #include "usb_descriptors/usb_descriptor_nkro_keyboard_report.h"
 
 // Macros:
 
@@ -23,17 +24,23 @@
 
 // Typedefs:
 
+    // Keys are collected in a bitfield report, which is sent as it is through the NKRO keyboard
+    // interface if the host uses it. Otherwise it is translated to the boot report of this interface,
+    // which carries at most USB_BASIC_KEYBOARD_MAX_KEYS scancodes.
+    typedef struct {
+        uint8_t modifiers;
+        uint8_t reserved; // Always must be 0
+        uint8_t bitfield[USB_NKRO_KEYBOARD_BITFIELD_LENGTH];
+    } ATTR_PACKED usb_basic_keyboard_report_t;
+
     // Note: We support boot protocol mode in this interface, thus the keyboard
     // report may not exceed 8 bytes and must conform to the HID keyboard boot
-    // protocol as specified in the USB HID specification. If a different or
-    // longer format is desired in the future, we will need to translate sent
-    // reports to the boot protocol format when the host has set boot protocol
-    // mode.
+    // protocol as specified in the USB HID specification.
     typedef struct {
         uint8_t modifiers;
         uint8_t reserved; // Always must be 0
         uint8_t scancodes[USB_BASIC_KEYBOARD_MAX_KEYS];
-    } ATTR_PACKED usb_basic_keyboard_report_t;
+    } ATTR_PACKED usb_boot_keyboard_report_t;
 
 // Variables:
 
@@ -48,7 +55,16 @@
 
     void UsbBasicKeyboardResetActiveReport(void);
     usb_status_t UsbBasicKeyboardAction(void);
+    void UsbBasicKeyboardReportSent(void);
+    usb_basic_keyboard_report_t* UsbBasicKeyboardGetLastSentReport(void);
     usb_status_t UsbBasicKeyboardCheckIdleElapsed();
     usb_status_t UsbBasicKeyboardCheckReportReady();
 
+    void UsbBasicKeyboardAddScancode(usb_basic_keyboard_report_t* report, uint8_t scancode);
+    void UsbBasicKeyboardRemoveScancode(usb_basic_keyboard_report_t* report, uint8_t scancode);
+    bool UsbBasicKeyboardContainsScancode(const usb_basic_keyboard_report_t* report, uint8_t scancode);
+    uint8_t UsbBasicKeyboardNextScancode(const usb_basic_keyboard_report_t* report, uint8_t scancode);
+    uint8_t UsbBasicKeyboardScancodeCount(const usb_basic_keyboard_report_t* report);
+    void UsbBasicKeyboardMergeReports(const usb_basic_keyboard_report_t* sourceReport, usb_basic_keyboard_report_t* targetReport);
+
 #endif
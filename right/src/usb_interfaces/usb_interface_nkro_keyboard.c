@@ -0,0 +1,67 @@
+#include "usb_composite_device.h"
+#include "usb_report_updater.h"
+
+volatile bool UsbNkroKeyboardUsedByHost;
+
+// This interface has no reports of its own, it sends the bitfield reports of the basic keyboard
+// interface whenever UsbBasicKeyboardAction() finds the host using it.
+usb_status_t UsbNkroKeyboardCallback(class_handle_t handle, uint32_t event, void *param)
+{
+    usb_status_t error = kStatus_USB_Error;
+
+    switch (event) {
+        case kUSB_DeviceHidEventSendResponse:
+            UsbBasicKeyboardReportSent();
+            if (UsbCompositeDevice.attach) {
+                error = kStatus_USB_Success;
+            }
+            break;
+        case kUSB_DeviceHidEventRecvResponse:
+            error = kStatus_USB_InvalidRequest;
+            break;
+
+        case kUSB_DeviceHidEventGetReport: {
+            usb_device_hid_report_struct_t *report = (usb_device_hid_report_struct_t*)param;
+            if (report->reportType == USB_DEVICE_HID_REQUEST_GET_REPORT_TYPE_INPUT && report->reportId == 0 && report->reportLength <= USB_NKRO_KEYBOARD_REPORT_LENGTH) {
+                report->reportBuffer = (void*)UsbBasicKeyboardGetLastSentReport();
+                error = kStatus_USB_Success;
+            } else {
+                error = kStatus_USB_InvalidRequest;
+            }
+            break;
+        }
+
+        // The keyboard LEDs are set through the basic keyboard interface.
+        case kUSB_DeviceHidEventSetReport:
+        case kUSB_DeviceHidEventRequestReportBuffer:
+            error = kStatus_USB_InvalidRequest;
+            break;
+
+        case kUSB_DeviceHidEventGetIdle:
+        case kUSB_DeviceHidEventSetIdle:
+            error = kStatus_USB_Success;
+            break;
+
+        // No boot protocol support for this interface.
+        case kUSB_DeviceHidEventGetProtocol:
+        case kUSB_DeviceHidEventSetProtocol:
+            error = kStatus_USB_InvalidRequest;
+            break;
+
+        default:
+            break;
+    }
+
+    return error;
+}
+
+usb_status_t UsbNkroKeyboardSetConfiguration(class_handle_t handle, uint8_t configuration)
+{
+    UsbNkroKeyboardUsedByHost = false;
+    return kStatus_USB_Error;
+}
+
+usb_status_t UsbNkroKeyboardSetInterface(class_handle_t handle, uint8_t interface, uint8_t alternateSetting)
+{
+    return kStatus_USB_Error;
+}
@@ -0,0 +1,36 @@
+#ifndef __USB_INTERFACE_NKRO_KEYBOARD_H__
+#define __USB_INTERFACE_NKRO_KEYBOARD_H__
+
+// Includes:
+
+    #include "fsl_common.h"
+    #include "attributes.h"
+    #include "usb_api.h"
+    #include "usb_descriptors/usb_descriptor_nkro_keyboard_report.h"
+
+// Macros:
+
+    #define USB_NKRO_KEYBOARD_INTERFACE_INDEX 5
+    #define USB_NKRO_KEYBOARD_INTERFACE_COUNT 1
+
+    #define USB_NKRO_KEYBOARD_ENDPOINT_INDEX 7
+    #define USB_NKRO_KEYBOARD_ENDPOINT_COUNT 1
+
+    #define USB_NKRO_KEYBOARD_INTERRUPT_IN_PACKET_SIZE 32
+    #define USB_NKRO_KEYBOARD_INTERRUPT_IN_INTERVAL 1
+
+    #define USB_NKRO_KEYBOARD_REPORT_LENGTH (2 + USB_NKRO_KEYBOARD_BITFIELD_LENGTH)
+
+// Variables:
+
+    // Set once the host has fetched the report descriptor of this interface. Hosts which only
+    // understand boot keyboards, like most BIOSes, never do so and get boot reports instead.
+    extern volatile bool UsbNkroKeyboardUsedByHost;
+
+// Functions:
+
+    usb_status_t UsbNkroKeyboardCallback(class_handle_t handle, uint32_t event, void *param);
+    usb_status_t UsbNkroKeyboardSetConfiguration(class_handle_t handle, uint8_t configuration);
+    usb_status_t UsbNkroKeyboardSetInterface(class_handle_t handle, uint8_t interface, uint8_t alternateSetting);
+
+#endif
@@ -19,6 +19,10 @@
 #include "usb_commands/usb_command_switch_keymap.h"
 #include "usb_commands/usb_command_get_variable.h"
 #include "usb_commands/usb_command_set_variable.h"
+#include "usb_commands/usb_command_get_key_latency_histogram.h"
+#include "usb_commands/usb_command_get_perf_stats.h"
+#include "usb_commands/usb_command_get_status_buffer.h"
+#include "usb_commands/usb_command_get_slave_scheduler_stats.h"
 
 void UsbProtocolHandler(void)
 {
@@ -85,6 +89,18 @@ void UsbProtocolHandler(void)
         case UsbCommandId_SetVariable:
             UsbCommand_SetVariable();
             break;
+        case UsbCommandId_GetKeyLatencyHistogram:
+            UsbCommand_GetKeyLatencyHistogram();
+            break;
+        case UsbCommandId_GetPerfStats:
+            UsbCommand_GetPerfStats();
+            break;
+        case UsbCommandId_GetStatusBuffer:
+            UsbCommand_GetStatusBuffer();
+            break;
+        case UsbCommandId_GetSlaveSchedulerStats:
+            UsbCommand_GetSlaveSchedulerStats();
+            break;
         default:
             SetUsbTxBufferUint8(0, UsbStatusCode_InvalidCommand);
             break;
@@ -36,6 +36,10 @@
         UsbCommandId_SwitchKeymap             = 0x11,
         UsbCommandId_GetVariable              = 0x12,
         UsbCommandId_SetVariable              = 0x13,
+        UsbCommandId_GetKeyLatencyHistogram   = 0x14,
+        UsbCommandId_GetPerfStats             = 0x15,
+        UsbCommandId_GetStatusBuffer          = 0x16,
+        UsbCommandId_GetSlaveSchedulerStats   = 0x17,
     } usb_command_id_t;
 
     typedef enum {
@@ -44,6 +48,7 @@
         UsbVariable_DebounceTimePress,
         UsbVariable_DebounceTimeRelease,
         UsbVariable_UsbReportSemaphore,
+        UsbVariable_EagerKeyPresses,
     } usb_variable_id_t;
 
     typedef enum {
@@ -24,6 +24,9 @@
 #include "layer_switcher.h"
 #include "mouse_controller.h"
 #include "debug.h"
+#include "perf_probes.h"
+#include "combos.h"
+#include "macro_events.h"
 
 bool TestUsbStack = false;
 static key_action_t actionCache[SLOT_COUNT][MAX_KEY_COUNT_PER_MODULE];
@@ -38,6 +41,9 @@ sticky_strategy_t StickyModifierStrategy = Stick_Smart;
 
 uint8_t KeystrokeDelay = 0;
 
+bool EagerKeyPresses = false;
+uint32_t KeyLatencyHistogram[KEY_LATENCY_HISTOGRAM_BUCKET_COUNT];
+
 key_state_t* EmergencyKey = NULL;
 
 // Holds are applied on current base layer.
@@ -96,7 +102,6 @@ static void handleEventInterrupts(key_state_t *keyState) {
     }
 }
 
-uint8_t basicScancodeIndex = 0;
 static uint8_t mediaScancodeIndex = 0;
 static uint8_t systemScancodeIndex = 0;
 
@@ -180,10 +185,7 @@ static void applyKeystrokePrimary(key_state_t *keyState, key_action_t *action)
         if (!stickyModifiersChanged || KeyState_ActivatedEarlier(keyState)) {
             switch (action->keystroke.keystrokeType) {
                 case KeystrokeType_Basic:
-                    if (basicScancodeIndex >= USB_BASIC_KEYBOARD_MAX_KEYS || action->keystroke.scancode == 0) {
-                        break;
-                    }
-                    ActiveUsbBasicKeyboardReport->scancodes[basicScancodeIndex++] = action->keystroke.scancode;
+                    UsbBasicKeyboardAddScancode(ActiveUsbBasicKeyboardReport, action->keystroke.scancode);
                     break;
                 case KeystrokeType_Media:
                     if (mediaScancodeIndex >= USB_MEDIA_KEYBOARD_MAX_KEYS) {
@@ -242,6 +244,12 @@ static void applyKeystroke(key_state_t *keyState, key_action_t *action, key_acti
     }
 }
 
+// Returns the action which got cached when the key was activated, keyState has to point into KeyStates.
+key_action_t* GetCachedKeyAction(key_state_t *keyState)
+{
+    return &actionCache[0][0] + (keyState - &KeyStates[0][0]);
+}
+
 void ApplyKeyAction(key_state_t *keyState, key_action_t *action, key_action_t *actionBase)
 {
     if (KeyState_ActivatedNow(keyState)) {
@@ -288,7 +296,6 @@ void clearActiveReports(void)
     memset(ActiveUsbBasicKeyboardReport, 0, sizeof *ActiveUsbBasicKeyboardReport);
     memset(ActiveUsbMediaKeyboardReport, 0, sizeof *ActiveUsbMediaKeyboardReport);
     memset(ActiveUsbSystemKeyboardReport, 0, sizeof *ActiveUsbSystemKeyboardReport);
-    basicScancodeIndex = 0;
     mediaScancodeIndex = 0;
     systemScancodeIndex = 0;
 }
@@ -296,32 +303,30 @@ void clearActiveReports(void)
 
 void mergeReports(void)
 {
-    for(uint8_t j = 0; j < MACRO_STATE_POOL_SIZE; j++) {
-        if(MacroState[j].ms.reportsUsed) {
-            //if the macro ended right now, we still want to flush the last report
-            MacroState[j].ms.reportsUsed &= MacroState[j].ms.macroPlaying;
-            macro_state_t *s = &MacroState[j];
-            ActiveUsbBasicKeyboardReport->modifiers |= s->ms.macroBasicKeyboardReport.modifiers;
-            for ( int i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS && s->ms.macroBasicKeyboardReport.scancodes[i] != 0; i++) {
-                if( basicScancodeIndex < USB_BASIC_KEYBOARD_MAX_KEYS ) {
-                    ActiveUsbBasicKeyboardReport->scancodes[basicScancodeIndex++] = s->ms.macroBasicKeyboardReport.scancodes[i];
-                }
+    uint32_t usedReports = MacroUsedReports;
+    while (usedReports) {
+        macro_reports_t *r = &MacroReports[__builtin_ctz(usedReports)];
+        usedReports &= usedReports - 1;
+        UsbBasicKeyboardMergeReports(&r->basicKeyboardReport, ActiveUsbBasicKeyboardReport);
+        for ( int i = 0; i < USB_MEDIA_KEYBOARD_MAX_KEYS && r->mediaKeyboardReport.scancodes[i] != 0 ; i++) {
+            if( mediaScancodeIndex < USB_MEDIA_KEYBOARD_MAX_KEYS ) {
+                ActiveUsbMediaKeyboardReport->scancodes[mediaScancodeIndex++] = r->mediaKeyboardReport.scancodes[i];
             }
-            for ( int i = 0; i < USB_MEDIA_KEYBOARD_MAX_KEYS && s->ms.macroMediaKeyboardReport.scancodes[i] != 0 ; i++) {
-                if( mediaScancodeIndex < USB_MEDIA_KEYBOARD_MAX_KEYS ) {
-                    ActiveUsbMediaKeyboardReport->scancodes[mediaScancodeIndex++] = s->ms.macroMediaKeyboardReport.scancodes[i];
-                }
-            }
-            for ( int i = 0; i < USB_SYSTEM_KEYBOARD_MAX_KEYS && s->ms.macroSystemKeyboardReport.scancodes[i] != 0; i++) {
-                if( systemScancodeIndex < USB_SYSTEM_KEYBOARD_MAX_KEYS ) {
-                    ActiveUsbSystemKeyboardReport->scancodes[systemScancodeIndex++] = s->ms.macroSystemKeyboardReport.scancodes[i];
-                }
+        }
+        for ( int i = 0; i < USB_SYSTEM_KEYBOARD_MAX_KEYS && r->systemKeyboardReport.scancodes[i] != 0; i++) {
+            if( systemScancodeIndex < USB_SYSTEM_KEYBOARD_MAX_KEYS ) {
+                ActiveUsbSystemKeyboardReport->scancodes[systemScancodeIndex++] = r->systemKeyboardReport.scancodes[i];
             }
-            ActiveUsbMouseReport->buttons |= s->ms.macroMouseReport.buttons;
-            ActiveUsbMouseReport->x += s->ms.macroMouseReport.x;
-            ActiveUsbMouseReport->y += s->ms.macroMouseReport.y;
-            ActiveUsbMouseReport->wheelX += s->ms.macroMouseReport.wheelX;
-            ActiveUsbMouseReport->wheelY += s->ms.macroMouseReport.wheelY;
+        }
+        ActiveUsbMouseReport->buttons |= r->mouseReport.buttons;
+        ActiveUsbMouseReport->x += r->mouseReport.x;
+        ActiveUsbMouseReport->y += r->mouseReport.y;
+        ActiveUsbMouseReport->wheelX += r->mouseReport.wheelX;
+        ActiveUsbMouseReport->wheelY += r->mouseReport.wheelY;
+        //if the macro ended right now, we still want to flush the last report
+        macro_state_t *owner = &MacroState[r->ownerSlot];
+        if (!owner->ms.macroPlaying) {
+            Macros_ReleaseReports(owner);
         }
     }
     if(!SuppressMods) {
@@ -332,6 +337,13 @@ void mergeReports(void)
 static void commitKeyState(key_state_t *keyState, bool active)
 {
     WATCH_TRIGGER(keyState);
+    if (active && MacroEvent_KeyPressRegistered) {
+        MacroEvent_OnKeyPress(keyState);
+    }
+    keyState = Combos_ProcessKeyEvent(keyState, active);
+    if (keyState == NULL) {
+        return;
+    }
     if (PostponerCore_IsActive()) {
         PostponerCore_TrackKeyEvent(keyState, active);
     } else {
@@ -339,19 +351,88 @@ static void commitKeyState(key_state_t *keyState, bool active)
     }
 }
 
-static inline void preprocessKeyState(key_state_t *keyState)
+static inline bool debounceTimeElapsed(key_state_t *keyState, uint8_t debounceTime)
+{
+    return (uint8_t)(CurrentTime - keyState->timestamp) > debounceTime;
+}
+
+// In eager mode, a press of a released key is committed immediately and debouncing applies
+// to releases only: the release is committed once the switch has stayed open for
+// DebounceTimeRelease. Here `debouncing` marks a pending release and the timestamp
+// holds the time of its last open edge.
+static inline uint64_t debounceSlotEager(key_state_bits_t *bits, key_state_t *keyStates, uint64_t hardware)
+{
+    uint64_t opening = bits->debounced & ~hardware;
+    uint64_t pressed = hardware & ~bits->debounced;
+    uint64_t released = 0;
+
+    for (uint64_t keys = opening; keys; keys &= keys - 1) {
+        uint64_t mask = keys & -keys;
+        key_state_t *keyState = &keyStates[__builtin_ctzll(keys)];
+        if (!(bits->debouncing & mask)) {
+            keyState->timestamp = CurrentTime;
+        } else if (debounceTimeElapsed(keyState, DebounceTimeRelease)) {
+            released |= mask;
+        }
+    }
+
+    bits->debouncing = opening & ~released;
+    bits->debounced = (bits->debounced | pressed) & ~released;
+    return pressed | released;
+}
+
+// The debouncer works on the packed words of a slot, and returns the keys whose debounced
+// state flips in this cycle. These are committed by the caller in scan order. Only keys
+// which are debouncing consult their timer, and a key flips only if its bit differs between
+// the hardware and debounced words while it is not debouncing.
+static inline uint64_t debounceSlot(key_state_bits_t *bits, key_state_t *keyStates)
+{
+    uint64_t hardware = bits->hardware;
+
+    if (EagerKeyPresses) {
+        return debounceSlotEager(bits, keyStates, hardware);
+    }
+
+    for (uint64_t keys = bits->debouncing; keys; keys &= keys - 1) {
+        key_state_t *keyState = &keyStates[__builtin_ctzll(keys)];
+        if (debounceTimeElapsed(keyState, keyState->previous ? DebounceTimePress : DebounceTimeRelease)) {
+            bits->debouncing &= ~(keys & -keys);
+        }
+    }
+
+    uint64_t changed = (hardware ^ bits->debounced) & ~bits->debouncing;
+    for (uint64_t keys = changed; keys; keys &= keys - 1) {
+        keyStates[__builtin_ctzll(keys)].timestamp = CurrentTime;
+    }
+    bits->debouncing |= changed;
+    bits->debounced ^= changed;
+    return changed;
+}
+
+static inline void commitDebouncedKeyState(key_state_bits_t *bits, uint64_t changed, uint8_t keyId, key_state_t *keyState)
 {
-    uint8_t debounceTime = keyState->previous ? DebounceTimePress : DebounceTimeRelease;
-    if (keyState->debouncing && (uint8_t)(CurrentTime - keyState->timestamp) > debounceTime) {
-        keyState->debouncing = false;
+    if ((changed >> keyId) & 1) {
+        commitKeyState(keyState, (bits->debounced >> keyId) & 1);
     }
+}
 
-    if (!keyState->debouncing && keyState->debouncedSwitchState != keyState->hardwareSwitchState) {
-        keyState->timestamp = CurrentTime;
-        keyState->debouncing = true;
-        keyState->debouncedSwitchState = keyState->hardwareSwitchState;
+// Returns the first key at or after keyId which is held in hardware, debounced as held, debouncing or active.
+static inline uint8_t nextKeyToProcess(uint8_t slotId, uint8_t keyId)
+{
+    if (keyId >= MAX_KEY_COUNT_PER_MODULE) {
+        return MAX_KEY_COUNT_PER_MODULE;
+    }
+    key_state_bits_t *bits = &KeyStateBits[slotId];
+    uint64_t keys = (bits->hardware | bits->debounced | bits->debouncing | bits->active) >> keyId;
+    return keys ? keyId + __builtin_ctzll(keys) : MAX_KEY_COUNT_PER_MODULE;
+}
 
-        commitKeyState(keyState, keyState->debouncedSwitchState);
+static inline void updateKeyActivity(uint8_t slotId, uint8_t keyId, key_state_t *keyState)
+{
+    if (KeyState_NonZero(keyState)) {
+        KeyStateBits[slotId].active |= 1ULL << keyId;
+    } else {
+        KeyStateBits[slotId].active &= ~(1ULL << keyId);
     }
 }
 
@@ -368,7 +449,7 @@ static void handleUsbStackTestMode() {
         }
         if (simulateKeypresses) {
             isEven = !isEven;
-            ActiveUsbBasicKeyboardReport->scancodes[basicScancodeIndex++] = isEven ? HID_KEYBOARD_SC_A : HID_KEYBOARD_SC_BACKSPACE;
+            UsbBasicKeyboardAddScancode(ActiveUsbBasicKeyboardReport, isEven ? HID_KEYBOARD_SC_A : HID_KEYBOARD_SC_BACKSPACE);
             if (++mediaCounter % 200 == 0) {
                 isEvenMedia = !isEvenMedia;
                 ActiveUsbMediaKeyboardReport->scancodes[mediaScancodeIndex++] = isEvenMedia ? MEDIA_VOLUME_DOWN : MEDIA_VOLUME_UP;
@@ -378,15 +459,18 @@ static void handleUsbStackTestMode() {
     }
 }
 
+static layer_id_t previousLayer = LayerId_Base;
+
 //This might be moved directly into the layer_switcher
 static void handleLayerChanges() {
-    static layer_id_t previousLayer = LayerId_Base;
-
     LayerSwitcher_UpdateActiveLayer();
 
     if(ActiveLayer != previousLayer) {
         previousLayer = ActiveLayer;
         stickyModifiers = 0;
+        if (MacroEvent_LayerChangeRegistered) {
+            MacroEvent_OnLayerChange(ActiveLayer);
+        }
     }
 }
 
@@ -398,12 +482,13 @@ static void updateActiveUsbReports(void)
     SuppressMods = false;
 
     if (MacroPlaying) {
+        PERF_PROBE_BEGIN(ContinueMacro);
         Macros_ContinueMacro();
+        PERF_PROBE_END(ContinueMacro);
     }
 
     memcpy(ActiveMouseStates, ToggledMouseStates, ACTIVE_MOUSE_STATES_COUNT);
 
-    basicScancodeIndex = 0;
     mediaScancodeIndex = 0;
     systemScancodeIndex = 0;
 
@@ -415,17 +500,25 @@ static void updateActiveUsbReports(void)
 
     handleUsbStackTestMode();
 
+    if (ComboPending) {
+        Combos_UpdatePending();
+    }
+
     if (PostponerCore_IsActive()) {
+        PERF_PROBE_BEGIN(RunPostponedEvents);
         PostponerCore_RunPostponedEvents();
+        PERF_PROBE_END(RunPostponedEvents);
     }
 
     for (uint8_t slotId=0; slotId<SLOT_COUNT; slotId++) {
-        for (uint8_t keyId=0; keyId<MAX_KEY_COUNT_PER_MODULE; keyId++) {
+        key_state_bits_t *bits = &KeyStateBits[slotId];
+        uint64_t changed = debounceSlot(bits, KeyStates[slotId]);
+        for (uint8_t keyId=nextKeyToProcess(slotId, 0); keyId<MAX_KEY_COUNT_PER_MODULE; keyId=nextKeyToProcess(slotId, keyId+1)) {
             key_state_t *keyState = &KeyStates[slotId][keyId];
             key_action_t *action;
             key_action_t *actionBase;
 
-            preprocessKeyState(keyState);
+            commitDebouncedKeyState(bits, changed, keyId, keyState);
 
             if (KeyState_NonZero(keyState)) {
                 if (KeyState_ActivatedNow(keyState)) {
@@ -447,6 +540,8 @@ static void updateActiveUsbReports(void)
 
                 keyState->previous = keyState->current;
             }
+
+            updateKeyActivity(slotId, keyId, keyState);
         }
     }
 
@@ -463,14 +558,17 @@ static void updateActiveUsbReports(void)
 }
 
 void justPreprocessInput(void) {
-    // Make preprocessKeyState push new events into postponer queue.
+    // Make the debouncer push new events into postponer queue.
     // As a side-effect, postpone first cycle after we switch back to regular update loop
     PostponerCore_PostponeNCycles(0);
     for (uint8_t slotId=0; slotId<SLOT_COUNT; slotId++) {
-        for (uint8_t keyId=0; keyId<MAX_KEY_COUNT_PER_MODULE; keyId++) {
+        key_state_bits_t *bits = &KeyStateBits[slotId];
+        uint64_t changed = debounceSlot(bits, KeyStates[slotId]);
+        for (uint8_t keyId=nextKeyToProcess(slotId, 0); keyId<MAX_KEY_COUNT_PER_MODULE; keyId=nextKeyToProcess(slotId, keyId+1)) {
             key_state_t *keyState = &KeyStates[slotId][keyId];
 
-            preprocessKeyState(keyState);
+            commitDebouncedKeyState(bits, changed, keyId, keyState);
+            updateKeyActivity(slotId, keyId, keyState);
         }
     }
 
@@ -484,16 +582,132 @@ void justPreprocessInput(void) {
     }
 }
 
+// The report updater is quiescent when no key is held, debouncing or active, and no macro,
+// postponer, sticky modifier or mouse motion can alter the reports. The first quiescent cycle
+// still runs in full in order to settle layers and macro reports; the following ones produce
+// empty reports without evaluating them, but still keep the active layer up to date.
+static bool isQuiescent(void)
+{
+    for (uint8_t slotId=0; slotId<SLOT_COUNT; slotId++) {
+        key_state_bits_t *bits = &KeyStateBits[slotId];
+        if (bits->hardware | bits->debounced | bits->debouncing | bits->active) {
+            return false;
+        }
+    }
+
+    return !MacroPlaying && !PostponerCore_IsActive() && !TestUsbStack && !stickyModifiers && MouseController_IsIdle();
+}
+
+static void updateQuiescentUsbReports(void)
+{
+    handleLayerChanges();
+
+    LedDisplay_SetIcon(LedDisplayIcon_Agent, CurrentTime - LastUsbGetKeyboardStateRequestTimestamp < 1000);
+
+    MouseController_SkipMouseActions();
+}
+
+// Key latency is measured from the time a new press reached the hardware word of its slot, i.e. the
+// matrix scan of the right half or the receipt of a module's key states, until the key's scancode first
+// appears in a basic keyboard report which is handed to the USB stack. One press is measured at a time.
+// Presses of keys which don't type a basic keystroke, and the ones which don't show up in time, are skipped.
+#define KEY_LATENCY_TIMEOUT 1000000 // us
+
+static uint64_t lastHardwareBits[SLOT_COUNT];
+static key_state_t *latencyKey;
+static uint32_t latencyKeyPressTime;
+static bool latencyKeyTyped;
+
+// A measured key is dropped once it turns out to type no basic keystroke, or if it takes too long.
+static bool isLatencyKeyMeasurable(void)
+{
+    key_action_t *action = GetCachedKeyAction(latencyKey);
+
+    if (Timer_GetCurrentTimeMicros() - latencyKeyPressTime > KEY_LATENCY_TIMEOUT) {
+        return false;
+    }
+    // a key which is not activated yet, e.g. a postponed one, has no cached action
+    return !KeyState_NonZero(latencyKey) || (action->type == KeyActionType_Keystroke && action->keystroke.keystrokeType == KeystrokeType_Basic);
+}
+
+static void detectPressEdges(void)
+{
+    if (latencyKey != NULL && !isLatencyKeyMeasurable()) {
+        latencyKey = NULL;
+    }
+    for (uint8_t slotId=0; slotId<SLOT_COUNT; slotId++) {
+        key_state_bits_t *bits = &KeyStateBits[slotId];
+        uint64_t hardware = bits->hardware;
+        uint64_t pressed = hardware & ~lastHardwareBits[slotId];
+        lastHardwareBits[slotId] = hardware;
+        if (pressed && latencyKey == NULL) {
+            latencyKey = &KeyStates[slotId][__builtin_ctzll(pressed)];
+            latencyKeyPressTime = bits->pressTime;
+        }
+    }
+}
+
+static void checkLatencyKeyTyped(void)
+{
+    latencyKeyTyped = false;
+    if (latencyKey == NULL || !KeyState_NonZero(latencyKey) || !isLatencyKeyMeasurable()) {
+        return;
+    }
+    key_action_t *action = GetCachedKeyAction(latencyKey);
+    if (action->keystroke.scancode) {
+        latencyKeyTyped = UsbBasicKeyboardContainsScancode(ActiveUsbBasicKeyboardReport, action->keystroke.scancode);
+    } else {
+        latencyKeyTyped = action->keystroke.modifiers && (ActiveUsbBasicKeyboardReport->modifiers & action->keystroke.modifiers) == action->keystroke.modifiers;
+    }
+}
+
+static void recordKeyLatency(void)
+{
+    if (!latencyKeyTyped) {
+        return;
+    }
+    latencyKey = NULL;
+
+    uint32_t bucket = (Timer_GetCurrentTimeMicros() - latencyKeyPressTime) / KEY_LATENCY_HISTOGRAM_BUCKET_WIDTH;
+    if (bucket >= KEY_LATENCY_HISTOGRAM_BUCKET_COUNT) {
+        bucket = KEY_LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+    }
+    KeyLatencyHistogram[bucket]++;
+}
+
+// Slave drivers run in interrupt context, so they leave clearing the key states of a lost slot to the main loop.
+static void resetRequestedSlots(void)
+{
+    for (uint8_t slotId=0; slotId<SLOT_COUNT; slotId++) {
+        key_state_bits_t *bits = &KeyStateBits[slotId];
+        if (bits->resetRequested) {
+            memset(KeyStates[slotId], 0, MAX_KEY_COUNT_PER_MODULE * sizeof(key_state_t));
+            bits->debounced = 0;
+            bits->debouncing = 0;
+            bits->active = 0;
+            bits->resetRequested = false;
+        }
+    }
+}
+
 uint32_t UsbReportUpdateCounter;
+uint32_t UsbReportUpdateFastPathCounter;
 
 void UpdateUsbReports(void)
 {
     static uint32_t lastUpdateTime;
     static uint32_t lastReportTime;
+    static bool wasQuiescent;
 
-    for (uint8_t keyId = 0; keyId < RIGHT_KEY_MATRIX_KEY_COUNT; keyId++) {
-        KeyStates[SlotId_RightKeyboardHalf][keyId].hardwareSwitchState = RightKeyMatrix.keyStates[keyId];
+    uint64_t rightHardware = RightKeyMatrix.keyStates;
+    if (rightHardware & ~KeyStateBits[SlotId_RightKeyboardHalf].hardware) {
+        // the matrix has been scanned right before by the main loop
+        KeyStateBits[SlotId_RightKeyboardHalf].pressTime = Timer_GetCurrentTimeMicros();
     }
+    KeyStateBits[SlotId_RightKeyboardHalf].hardware = rightHardware;
+
+    resetRequestedSlots();
+    detectPressEdges();
 
     if (UsbReportUpdateSemaphore && !SleepModeActive) {
         if (Timer_GetElapsedTime(&lastUpdateTime) < USB_SEMAPHORE_TIMEOUT) {
@@ -516,10 +730,23 @@ void UpdateUsbReports(void)
     UsbSystemKeyboardResetActiveReport();
     UsbMouseResetActiveReport();
 
-    updateActiveUsbReports();
+    bool quiescent = isQuiescent();
+    if (quiescent && wasQuiescent && ActiveLayer == previousLayer) {
+        UsbReportUpdateFastPathCounter++;
+        layer_id_t quiescentLayer = ActiveLayer;
+        updateQuiescentUsbReports();
+        // A layer change, or a macro started by $onLayerChange, is settled by a full cycle.
+        quiescent = ActiveLayer == quiescentLayer && !MacroPlaying;
+    } else {
+        PERF_PROBE_BEGIN(UpdateReports);
+        updateActiveUsbReports();
+        PERF_PROBE_END(UpdateReports);
+    }
+    wasQuiescent = quiescent;
 
     if (UsbBasicKeyboardCheckReportReady() == kStatus_USB_Success) {
         MacroRecorder_RecordBasicReport(ActiveUsbBasicKeyboardReport);
+        checkLatencyKeyTyped();
 
         if(RuntimeMacroRecordingBlind) {
             //just switch reports without sending the report
@@ -532,6 +759,8 @@ void UpdateUsbReports(void)
                 //This is *not* asynchronously safe as long as multiple reports of different type can be sent at the same time.
                 //TODO: consider either making it atomic, or lowering semaphore reset delay
                 UsbReportUpdateSemaphore &= ~(1 << USB_BASIC_KEYBOARD_INTERFACE_INDEX);
+            } else {
+                recordKeyLatency();
             }
             lastReportTime = CurrentTime;
         }
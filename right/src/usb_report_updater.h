@@ -17,6 +17,9 @@
 
     #define USB_SEMAPHORE_TIMEOUT 100 // ms
 
+    #define KEY_LATENCY_HISTOGRAM_BUCKET_COUNT 14
+    #define KEY_LATENCY_HISTOGRAM_BUCKET_WIDTH 500 // us, the last bucket also holds everything above
+
 // Typedefs:
 
     typedef enum {
@@ -42,6 +45,7 @@
 // Variables:
 
     extern uint32_t UsbReportUpdateCounter;
+    extern uint32_t UsbReportUpdateFastPathCounter;
     extern volatile uint8_t UsbReportUpdateSemaphore;
     extern bool TestUsbStack;
     extern uint8_t HardwareModifierState;
@@ -53,7 +57,8 @@
     extern bool PendingPostponedAndReleased;
     extern bool ActivateOnRelease;
     extern key_state_t* EmergencyKey;
-    extern uint8_t basicScancodeIndex;
+    extern bool EagerKeyPresses;
+    extern uint32_t KeyLatencyHistogram[KEY_LATENCY_HISTOGRAM_BUCKET_COUNT];
 
 
 
@@ -64,5 +69,6 @@
     void ActivateKey(key_state_t *keyState, bool debounce);
     void ActivateStickyMods(key_state_t *keyState, uint8_t mods);
     void ApplyKeyAction(key_state_t *keyState, key_action_t *action, key_action_t *actionBase);
+    key_action_t* GetCachedKeyAction(key_state_t *keyState);
 
 #endif
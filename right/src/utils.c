@@ -39,10 +39,8 @@ void Utils_DecodeId(uint16_t keyid, uint8_t* outSlotId, uint8_t* outSlotIdx)
 void Utils_reportReport(usb_basic_keyboard_report_t* report)
 {
     Macros_SetStatusString("Reporting ", NULL);
-    for ( int i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
-        if (report->scancodes[i] != 0) {
-            Macros_SetStatusChar(MacroShortcutParser_ScancodeToCharacter(report->scancodes[i]));
-        }
+    for (uint8_t scancode = UsbBasicKeyboardNextScancode(report, 0); scancode != 0; scancode = UsbBasicKeyboardNextScancode(report, scancode)) {
+        Macros_SetStatusChar(MacroShortcutParser_ScancodeToCharacter(scancode));
     }
     Macros_SetStatusString("\n", NULL);
 }
@@ -0,0 +1,332 @@
+#!/usr/bin/env node
+const fs = require('fs');
+
+// Key abbreviations accepted by MacroShortcutParser_Parse, e.g. `tapKey leftArrow`.
+// Order does not matter, new entries can be appended anywhere.
+const records = [
+    ['enter', 'HID_KEYBOARD_SC_ENTER', 'scType_basic'],
+    ['escape', 'HID_KEYBOARD_SC_ESCAPE', 'scType_basic'],
+    ['backspace', 'HID_KEYBOARD_SC_BACKSPACE', 'scType_basic'],
+    ['tab', 'HID_KEYBOARD_SC_TAB', 'scType_basic'],
+    ['space', 'HID_KEYBOARD_SC_SPACE', 'scType_basic'],
+    ['minusAndUnderscore', 'HID_KEYBOARD_SC_MINUS_AND_UNDERSCORE', 'scType_basic'],
+    ['equalAndPlus', 'HID_KEYBOARD_SC_EQUAL_AND_PLUS', 'scType_basic'],
+    ['openingBracketAndOpeningBrace', 'HID_KEYBOARD_SC_OPENING_BRACKET_AND_OPENING_BRACE', 'scType_basic'],
+    ['closingBracketAndClosingBrace', 'HID_KEYBOARD_SC_CLOSING_BRACKET_AND_CLOSING_BRACE', 'scType_basic'],
+    ['backslashAndPipe', 'HID_KEYBOARD_SC_BACKSLASH_AND_PIPE', 'scType_basic'],
+    ['nonUsHashmarkAndTilde', 'HID_KEYBOARD_SC_NON_US_HASHMARK_AND_TILDE', 'scType_basic'],
+    ['semicolonAndColon', 'HID_KEYBOARD_SC_SEMICOLON_AND_COLON', 'scType_basic'],
+    ['apostropheAndQuote', 'HID_KEYBOARD_SC_APOSTROPHE_AND_QUOTE', 'scType_basic'],
+    ['graveAccentAndTilde', 'HID_KEYBOARD_SC_GRAVE_ACCENT_AND_TILDE', 'scType_basic'],
+    ['commaAndLessThanSign', 'HID_KEYBOARD_SC_COMMA_AND_LESS_THAN_SIGN', 'scType_basic'],
+    ['dotAndGreaterThanSign', 'HID_KEYBOARD_SC_DOT_AND_GREATER_THAN_SIGN', 'scType_basic'],
+    ['slashAndQuestionMark', 'HID_KEYBOARD_SC_SLASH_AND_QUESTION_MARK', 'scType_basic'],
+    ['capsLock', 'HID_KEYBOARD_SC_CAPS_LOCK', 'scType_basic'],
+    ['f1', 'HID_KEYBOARD_SC_F1', 'scType_basic'],
+    ['f2', 'HID_KEYBOARD_SC_F2', 'scType_basic'],
+    ['f3', 'HID_KEYBOARD_SC_F3', 'scType_basic'],
+    ['f4', 'HID_KEYBOARD_SC_F4', 'scType_basic'],
+    ['f5', 'HID_KEYBOARD_SC_F5', 'scType_basic'],
+    ['f6', 'HID_KEYBOARD_SC_F6', 'scType_basic'],
+    ['f7', 'HID_KEYBOARD_SC_F7', 'scType_basic'],
+    ['f8', 'HID_KEYBOARD_SC_F8', 'scType_basic'],
+    ['f9', 'HID_KEYBOARD_SC_F9', 'scType_basic'],
+    ['f10', 'HID_KEYBOARD_SC_F10', 'scType_basic'],
+    ['f11', 'HID_KEYBOARD_SC_F11', 'scType_basic'],
+    ['f12', 'HID_KEYBOARD_SC_F12', 'scType_basic'],
+    ['printScreen', 'HID_KEYBOARD_SC_PRINT_SCREEN', 'scType_basic'],
+    ['scrollLock', 'HID_KEYBOARD_SC_SCROLL_LOCK', 'scType_basic'],
+    ['pause', 'HID_KEYBOARD_SC_PAUSE', 'scType_basic'],
+    ['insert', 'HID_KEYBOARD_SC_INSERT', 'scType_basic'],
+    ['home', 'HID_KEYBOARD_SC_HOME', 'scType_basic'],
+    ['pageUp', 'HID_KEYBOARD_SC_PAGE_UP', 'scType_basic'],
+    ['delete', 'HID_KEYBOARD_SC_DELETE', 'scType_basic'],
+    ['end', 'HID_KEYBOARD_SC_END', 'scType_basic'],
+    ['pageDown', 'HID_KEYBOARD_SC_PAGE_DOWN', 'scType_basic'],
+    ['rightArrow', 'HID_KEYBOARD_SC_RIGHT_ARROW', 'scType_basic'],
+    ['leftArrow', 'HID_KEYBOARD_SC_LEFT_ARROW', 'scType_basic'],
+    ['downArrow', 'HID_KEYBOARD_SC_DOWN_ARROW', 'scType_basic'],
+    ['upArrow', 'HID_KEYBOARD_SC_UP_ARROW', 'scType_basic'],
+    ['right', 'HID_KEYBOARD_SC_RIGHT_ARROW', 'scType_basic'],
+    ['left', 'HID_KEYBOARD_SC_LEFT_ARROW', 'scType_basic'],
+    ['down', 'HID_KEYBOARD_SC_DOWN_ARROW', 'scType_basic'],
+    ['up', 'HID_KEYBOARD_SC_UP_ARROW', 'scType_basic'],
+    ['numLock', 'HID_KEYBOARD_SC_NUM_LOCK', 'scType_basic'],
+    ['keypadSlash', 'HID_KEYBOARD_SC_KEYPAD_SLASH', 'scType_basic'],
+    ['keypadAsterisk', 'HID_KEYBOARD_SC_KEYPAD_ASTERISK', 'scType_basic'],
+    ['keypadMinus', 'HID_KEYBOARD_SC_KEYPAD_MINUS', 'scType_basic'],
+    ['keypadPlus', 'HID_KEYBOARD_SC_KEYPAD_PLUS', 'scType_basic'],
+    ['keypadEnter', 'HID_KEYBOARD_SC_KEYPAD_ENTER', 'scType_basic'],
+    ['keypad1AndEnd', 'HID_KEYBOARD_SC_KEYPAD_1_AND_END', 'scType_basic'],
+    ['keypad2AndDownArrow', 'HID_KEYBOARD_SC_KEYPAD_2_AND_DOWN_ARROW', 'scType_basic'],
+    ['keypad3AndPageDown', 'HID_KEYBOARD_SC_KEYPAD_3_AND_PAGE_DOWN', 'scType_basic'],
+    ['keypad4AndLeftArrow', 'HID_KEYBOARD_SC_KEYPAD_4_AND_LEFT_ARROW', 'scType_basic'],
+    ['keypad5', 'HID_KEYBOARD_SC_KEYPAD_5', 'scType_basic'],
+    ['keypad6AndRightArrow', 'HID_KEYBOARD_SC_KEYPAD_6_AND_RIGHT_ARROW', 'scType_basic'],
+    ['keypad7AndHome', 'HID_KEYBOARD_SC_KEYPAD_7_AND_HOME', 'scType_basic'],
+    ['keypad8AndUpArrow', 'HID_KEYBOARD_SC_KEYPAD_8_AND_UP_ARROW', 'scType_basic'],
+    ['keypad9AndPageUp', 'HID_KEYBOARD_SC_KEYPAD_9_AND_PAGE_UP', 'scType_basic'],
+    ['keypad0AndInsert', 'HID_KEYBOARD_SC_KEYPAD_0_AND_INSERT', 'scType_basic'],
+    ['np1', 'HID_KEYBOARD_SC_KEYPAD_1_AND_END', 'scType_basic'],
+    ['np2', 'HID_KEYBOARD_SC_KEYPAD_2_AND_DOWN_ARROW', 'scType_basic'],
+    ['np3', 'HID_KEYBOARD_SC_KEYPAD_3_AND_PAGE_DOWN', 'scType_basic'],
+    ['np4', 'HID_KEYBOARD_SC_KEYPAD_4_AND_LEFT_ARROW', 'scType_basic'],
+    ['np5', 'HID_KEYBOARD_SC_KEYPAD_5', 'scType_basic'],
+    ['np6', 'HID_KEYBOARD_SC_KEYPAD_6_AND_RIGHT_ARROW', 'scType_basic'],
+    ['np7', 'HID_KEYBOARD_SC_KEYPAD_7_AND_HOME', 'scType_basic'],
+    ['np8', 'HID_KEYBOARD_SC_KEYPAD_8_AND_UP_ARROW', 'scType_basic'],
+    ['np9', 'HID_KEYBOARD_SC_KEYPAD_9_AND_PAGE_UP', 'scType_basic'],
+    ['np0', 'HID_KEYBOARD_SC_KEYPAD_0_AND_INSERT', 'scType_basic'],
+    ['keypadDotAndDelete', 'HID_KEYBOARD_SC_KEYPAD_DOT_AND_DELETE', 'scType_basic'],
+    ['nonUsBackslashAndPipe', 'HID_KEYBOARD_SC_NON_US_BACKSLASH_AND_PIPE', 'scType_basic'],
+    ['backslashAndPipeIso', 'HID_KEYBOARD_SC_NON_US_BACKSLASH_AND_PIPE', 'scType_basic'],
+    ['application', 'HID_KEYBOARD_SC_APPLICATION', 'scType_basic'],
+    ['power', 'HID_KEYBOARD_SC_POWER', 'scType_basic'],
+    ['keypadEqualSign', 'HID_KEYBOARD_SC_KEYPAD_EQUAL_SIGN', 'scType_basic'],
+    ['f13', 'HID_KEYBOARD_SC_F13', 'scType_basic'],
+    ['f14', 'HID_KEYBOARD_SC_F14', 'scType_basic'],
+    ['f15', 'HID_KEYBOARD_SC_F15', 'scType_basic'],
+    ['f16', 'HID_KEYBOARD_SC_F16', 'scType_basic'],
+    ['f17', 'HID_KEYBOARD_SC_F17', 'scType_basic'],
+    ['f18', 'HID_KEYBOARD_SC_F18', 'scType_basic'],
+    ['f19', 'HID_KEYBOARD_SC_F19', 'scType_basic'],
+    ['f20', 'HID_KEYBOARD_SC_F20', 'scType_basic'],
+    ['f21', 'HID_KEYBOARD_SC_F21', 'scType_basic'],
+    ['f22', 'HID_KEYBOARD_SC_F22', 'scType_basic'],
+    ['f23', 'HID_KEYBOARD_SC_F23', 'scType_basic'],
+    ['f24', 'HID_KEYBOARD_SC_F24', 'scType_basic'],
+    ['execute', 'HID_KEYBOARD_SC_EXECUTE', 'scType_basic'],
+    ['help', 'HID_KEYBOARD_SC_HELP', 'scType_basic'],
+    ['menu', 'HID_KEYBOARD_SC_MENU', 'scType_basic'],
+    ['select', 'HID_KEYBOARD_SC_SELECT', 'scType_basic'],
+    ['stop', 'HID_KEYBOARD_SC_STOP', 'scType_basic'],
+    ['again', 'HID_KEYBOARD_SC_AGAIN', 'scType_basic'],
+    ['undo', 'HID_KEYBOARD_SC_UNDO', 'scType_basic'],
+    ['cut', 'HID_KEYBOARD_SC_CUT', 'scType_basic'],
+    ['copy', 'HID_KEYBOARD_SC_COPY', 'scType_basic'],
+    ['paste', 'HID_KEYBOARD_SC_PASTE', 'scType_basic'],
+    ['find', 'HID_KEYBOARD_SC_FIND', 'scType_basic'],
+    ['mute', 'HID_KEYBOARD_SC_MUTE', 'scType_basic'],
+    ['volumeUp', 'HID_KEYBOARD_SC_VOLUME_UP', 'scType_basic'],
+    ['volumeDown', 'HID_KEYBOARD_SC_VOLUME_DOWN', 'scType_basic'],
+    ['lockingCapsLock', 'HID_KEYBOARD_SC_LOCKING_CAPS_LOCK', 'scType_basic'],
+    ['lockingNumLock', 'HID_KEYBOARD_SC_LOCKING_NUM_LOCK', 'scType_basic'],
+    ['lockingScrollLock', 'HID_KEYBOARD_SC_LOCKING_SCROLL_LOCK', 'scType_basic'],
+    ['keypadComma', 'HID_KEYBOARD_SC_KEYPAD_COMMA', 'scType_basic'],
+    ['keypadEqualSignAs400', 'HID_KEYBOARD_SC_KEYPAD_EQUAL_SIGN_AS400', 'scType_basic'],
+    ['international1', 'HID_KEYBOARD_SC_INTERNATIONAL1', 'scType_basic'],
+    ['international2', 'HID_KEYBOARD_SC_INTERNATIONAL2', 'scType_basic'],
+    ['international3', 'HID_KEYBOARD_SC_INTERNATIONAL3', 'scType_basic'],
+    ['international4', 'HID_KEYBOARD_SC_INTERNATIONAL4', 'scType_basic'],
+    ['international5', 'HID_KEYBOARD_SC_INTERNATIONAL5', 'scType_basic'],
+    ['international6', 'HID_KEYBOARD_SC_INTERNATIONAL6', 'scType_basic'],
+    ['international7', 'HID_KEYBOARD_SC_INTERNATIONAL7', 'scType_basic'],
+    ['international8', 'HID_KEYBOARD_SC_INTERNATIONAL8', 'scType_basic'],
+    ['international9', 'HID_KEYBOARD_SC_INTERNATIONAL9', 'scType_basic'],
+    ['lang1', 'HID_KEYBOARD_SC_LANG1', 'scType_basic'],
+    ['lang2', 'HID_KEYBOARD_SC_LANG2', 'scType_basic'],
+    ['lang3', 'HID_KEYBOARD_SC_LANG3', 'scType_basic'],
+    ['lang4', 'HID_KEYBOARD_SC_LANG4', 'scType_basic'],
+    ['lang5', 'HID_KEYBOARD_SC_LANG5', 'scType_basic'],
+    ['lang6', 'HID_KEYBOARD_SC_LANG6', 'scType_basic'],
+    ['lang7', 'HID_KEYBOARD_SC_LANG7', 'scType_basic'],
+    ['lang8', 'HID_KEYBOARD_SC_LANG8', 'scType_basic'],
+    ['lang9', 'HID_KEYBOARD_SC_LANG9', 'scType_basic'],
+    ['alternateErase', 'HID_KEYBOARD_SC_ALTERNATE_ERASE', 'scType_basic'],
+    ['sysreq', 'HID_KEYBOARD_SC_SYSREQ', 'scType_basic'],
+    ['cancel', 'HID_KEYBOARD_SC_CANCEL', 'scType_basic'],
+    ['clear', 'HID_KEYBOARD_SC_CLEAR', 'scType_basic'],
+    ['prior', 'HID_KEYBOARD_SC_PRIOR', 'scType_basic'],
+    ['return', 'HID_KEYBOARD_SC_RETURN', 'scType_basic'],
+    ['separator', 'HID_KEYBOARD_SC_SEPARATOR', 'scType_basic'],
+    ['out', 'HID_KEYBOARD_SC_OUT', 'scType_basic'],
+    ['oper', 'HID_KEYBOARD_SC_OPER', 'scType_basic'],
+    ['clearAndAgain', 'HID_KEYBOARD_SC_CLEAR_AND_AGAIN', 'scType_basic'],
+    ['crselAndProps', 'HID_KEYBOARD_SC_CRSEL_AND_PROPS', 'scType_basic'],
+    ['exsel', 'HID_KEYBOARD_SC_EXSEL', 'scType_basic'],
+    ['keypad00', 'HID_KEYBOARD_SC_KEYPAD_00', 'scType_basic'],
+    ['keypad000', 'HID_KEYBOARD_SC_KEYPAD_000', 'scType_basic'],
+    ['thousandsSeparator', 'HID_KEYBOARD_SC_THOUSANDS_SEPARATOR', 'scType_basic'],
+    ['decimalSeparator', 'HID_KEYBOARD_SC_DECIMAL_SEPARATOR', 'scType_basic'],
+    ['currencyUnit', 'HID_KEYBOARD_SC_CURRENCY_UNIT', 'scType_basic'],
+    ['currencySubUnit', 'HID_KEYBOARD_SC_CURRENCY_SUB_UNIT', 'scType_basic'],
+    ['keypadOpeningParenthesis', 'HID_KEYBOARD_SC_KEYPAD_OPENING_PARENTHESIS', 'scType_basic'],
+    ['keypadClosingParenthesis', 'HID_KEYBOARD_SC_KEYPAD_CLOSING_PARENTHESIS', 'scType_basic'],
+    ['keypadOpeningBrace', 'HID_KEYBOARD_SC_KEYPAD_OPENING_BRACE', 'scType_basic'],
+    ['keypadClosingBrace', 'HID_KEYBOARD_SC_KEYPAD_CLOSING_BRACE', 'scType_basic'],
+    ['keypadTab', 'HID_KEYBOARD_SC_KEYPAD_TAB', 'scType_basic'],
+    ['keypadBackspace', 'HID_KEYBOARD_SC_KEYPAD_BACKSPACE', 'scType_basic'],
+    ['keypadA', 'HID_KEYBOARD_SC_KEYPAD_A', 'scType_basic'],
+    ['keypadB', 'HID_KEYBOARD_SC_KEYPAD_B', 'scType_basic'],
+    ['keypadC', 'HID_KEYBOARD_SC_KEYPAD_C', 'scType_basic'],
+    ['keypadD', 'HID_KEYBOARD_SC_KEYPAD_D', 'scType_basic'],
+    ['keypadE', 'HID_KEYBOARD_SC_KEYPAD_E', 'scType_basic'],
+    ['keypadF', 'HID_KEYBOARD_SC_KEYPAD_F', 'scType_basic'],
+    ['keypadXor', 'HID_KEYBOARD_SC_KEYPAD_XOR', 'scType_basic'],
+    ['keypadCaret', 'HID_KEYBOARD_SC_KEYPAD_CARET', 'scType_basic'],
+    ['keypadPercentage', 'HID_KEYBOARD_SC_KEYPAD_PERCENTAGE', 'scType_basic'],
+    ['keypadLessThanSign', 'HID_KEYBOARD_SC_KEYPAD_LESS_THAN_SIGN', 'scType_basic'],
+    ['keypadGreaterThanSign', 'HID_KEYBOARD_SC_KEYPAD_GREATER_THAN_SIGN', 'scType_basic'],
+    ['keypadAmp', 'HID_KEYBOARD_SC_KEYPAD_AMP', 'scType_basic'],
+    ['keypadAmpAmp', 'HID_KEYBOARD_SC_KEYPAD_AMP_AMP', 'scType_basic'],
+    ['keypadPipe', 'HID_KEYBOARD_SC_KEYPAD_PIPE', 'scType_basic'],
+    ['keypadPipePipe', 'HID_KEYBOARD_SC_KEYPAD_PIPE_PIPE', 'scType_basic'],
+    ['keypadColon', 'HID_KEYBOARD_SC_KEYPAD_COLON', 'scType_basic'],
+    ['keypadHashmark', 'HID_KEYBOARD_SC_KEYPAD_HASHMARK', 'scType_basic'],
+    ['keypadSpace', 'HID_KEYBOARD_SC_KEYPAD_SPACE', 'scType_basic'],
+    ['keypadAt', 'HID_KEYBOARD_SC_KEYPAD_AT', 'scType_basic'],
+    ['keypadExclamationSign', 'HID_KEYBOARD_SC_KEYPAD_EXCLAMATION_SIGN', 'scType_basic'],
+    ['keypadMemoryStore', 'HID_KEYBOARD_SC_KEYPAD_MEMORY_STORE', 'scType_basic'],
+    ['keypadMemoryRecall', 'HID_KEYBOARD_SC_KEYPAD_MEMORY_RECALL', 'scType_basic'],
+    ['keypadMemoryClear', 'HID_KEYBOARD_SC_KEYPAD_MEMORY_CLEAR', 'scType_basic'],
+    ['keypadMemoryAdd', 'HID_KEYBOARD_SC_KEYPAD_MEMORY_ADD', 'scType_basic'],
+    ['keypadMemorySubtract', 'HID_KEYBOARD_SC_KEYPAD_MEMORY_SUBTRACT', 'scType_basic'],
+    ['keypadMemoryMultiply', 'HID_KEYBOARD_SC_KEYPAD_MEMORY_MULTIPLY', 'scType_basic'],
+    ['keypadMemoryDivide', 'HID_KEYBOARD_SC_KEYPAD_MEMORY_DIVIDE', 'scType_basic'],
+    ['keypadPlusAndMinus', 'HID_KEYBOARD_SC_KEYPAD_PLUS_AND_MINUS', 'scType_basic'],
+    ['keypadClear', 'HID_KEYBOARD_SC_KEYPAD_CLEAR', 'scType_basic'],
+    ['keypadClearEntry', 'HID_KEYBOARD_SC_KEYPAD_CLEAR_ENTRY', 'scType_basic'],
+    ['keypadBinary', 'HID_KEYBOARD_SC_KEYPAD_BINARY', 'scType_basic'],
+    ['keypadOctal', 'HID_KEYBOARD_SC_KEYPAD_OCTAL', 'scType_basic'],
+    ['keypadDecimal', 'HID_KEYBOARD_SC_KEYPAD_DECIMAL', 'scType_basic'],
+    ['keypadHexadecimal', 'HID_KEYBOARD_SC_KEYPAD_HEXADECIMAL', 'scType_basic'],
+    ['leftControl', 'HID_KEYBOARD_SC_LEFT_CONTROL', 'scType_basic'],
+    ['leftShift', 'HID_KEYBOARD_SC_LEFT_SHIFT', 'scType_basic'],
+    ['leftAlt', 'HID_KEYBOARD_SC_LEFT_ALT', 'scType_basic'],
+    ['leftGui', 'HID_KEYBOARD_SC_LEFT_GUI', 'scType_basic'],
+    ['rightControl', 'HID_KEYBOARD_SC_RIGHT_CONTROL', 'scType_basic'],
+    ['rightShift', 'HID_KEYBOARD_SC_RIGHT_SHIFT', 'scType_basic'],
+    ['rightAlt', 'HID_KEYBOARD_SC_RIGHT_ALT', 'scType_basic'],
+    ['rightGui', 'HID_KEYBOARD_SC_RIGHT_GUI', 'scType_basic'],
+    ['mediaVolumeMute', 'MEDIA_VOLUME_MUTE', 'scType_media'],
+    ['mediaVolumeUp', 'MEDIA_VOLUME_UP', 'scType_media'],
+    ['mediaVolumeDown', 'MEDIA_VOLUME_DOWN', 'scType_media'],
+    ['mediaRecord', 'MEDIA_RECORD', 'scType_media'],
+    ['mediaFastForward', 'MEDIA_FAST_FORWARD', 'scType_media'],
+    ['mediaRewind', 'MEDIA_REWIND', 'scType_media'],
+    ['mediaNext', 'MEDIA_NEXT', 'scType_media'],
+    ['mediaPrevious', 'MEDIA_PREVIOUS', 'scType_media'],
+    ['mediaStop', 'MEDIA_STOP', 'scType_media'],
+    ['mediaPlayPause', 'MEDIA_PLAY_PAUSE', 'scType_media'],
+    ['mediaPause', 'MEDIA_PAUSE', 'scType_media'],
+    ['systemPowerDown', 'SYSTEM_POWER_DOWN', 'scType_system'],
+    ['systemSleep', 'SYSTEM_SLEEP', 'scType_system'],
+    ['systemWakeUp', 'SYSTEM_WAKE_UP', 'scType_system'],
+    ['mouseBtnLeft', 'MouseButton_Left', 'scType_mouseBtn'],
+    ['mouseBtnRight', 'MouseButton_Right', 'scType_mouseBtn'],
+    ['mouseBtnMiddle', 'MouseButton_Middle', 'scType_mouseBtn'],
+    ['mouseBtn1', 'MouseButton_Left', 'scType_mouseBtn'],
+    ['mouseBtn2', 'MouseButton_Right', 'scType_mouseBtn'],
+    ['mouseBtn3', 'MouseButton_Middle', 'scType_mouseBtn'],
+    ['mouseBtn4', 'MouseButton_4', 'scType_mouseBtn'],
+    ['mouseBtn5', 'MouseButton_5', 'scType_mouseBtn'],
+    ['mouseBtn6', 'MouseButton_6', 'scType_mouseBtn'],
+    ['mouseBtn7', 'MouseButton_7', 'scType_mouseBtn'],
+    ['mouseBtn8', 'MouseButton_8', 'scType_mouseBtn'],
+];
+
+// 32-bit FNV-1a with the offset basis perturbed by the seed.
+// Has to match StrHash() in right/src/str_utils.c.
+function hash(seed, str) {
+    let h = (2166136261 ^ seed) >>> 0;
+    for (let i = 0; i < str.length; i++) {
+        h = (h ^ str.charCodeAt(i)) >>> 0;
+        h = Math.imul(h, 16777619) >>> 0;
+    }
+    return h;
+}
+
+// Hash and displace: every record falls into a bucket by hash(0, id). Buckets are
+// then placed from the largest one, each by searching a seed which maps all its
+// records into free slots of the table.
+function buildPerfectHash(tableSize, bucketCount) {
+    const buckets = Array.from({length: bucketCount}, () => []);
+    records.forEach(record => buckets[hash(0, record[0]) % bucketCount].push(record));
+
+    const seeds = new Array(bucketCount).fill(0);
+    const table = new Array(tableSize).fill(null);
+    const order = buckets.map((bucket, index) => index).sort((a, b) => buckets[b].length - buckets[a].length);
+
+    for (const bucketIndex of order) {
+        const bucket = buckets[bucketIndex];
+        if (bucket.length === 0) {
+            continue;
+        }
+        let placed = false;
+        for (let seed = 1; seed < 256 && !placed; seed++) {
+            const slots = bucket.map(record => hash(seed, record[0]) % tableSize);
+            if (slots.every((slot, i) => table[slot] === null && slots.indexOf(slot) === i)) {
+                slots.forEach((slot, i) => table[slot] = bucket[i]);
+                seeds[bucketIndex] = seed;
+                placed = true;
+            }
+        }
+        if (!placed) {
+            return null;
+        }
+    }
+    return {seeds, table};
+}
+
+const ids = records.map(record => record[0]);
+const duplicates = ids.filter((id, i) => ids.indexOf(id) !== i);
+if (duplicates.length > 0) {
+    console.error(`Duplicate key abbreviations: ${duplicates.join(', ')}`);
+    process.exit(1);
+}
+
+const bucketCount = Math.ceil(records.length / 4);
+let tableSize = records.length;
+let result = null;
+while (!(result = buildPerfectHash(tableSize, bucketCount))) {
+    tableSize++;
+}
+
+const seedLines = [];
+for (let i = 0; i < result.seeds.length; i += 16) {
+    seedLines.push('    ' + result.seeds.slice(i, i + 16).join(', ') + ',');
+}
+const tableLines = result.table.map(record => record
+    ? `    {"${record[0]}", ${record[1]}, ${record[2]}},`
+    : '    {NULL, 0, scType_basic},');
+
+const header = `// Please do not edit this file by hand!
+// It is to be regenerated by /scripts/generate-shortcut-lookup.js
+`;
+
+fs.writeFileSync(`${__dirname}/../right/src/macro_shortcut_lookup.h`,
+`${header}
+#ifndef __MACRO_SHORTCUT_LOOKUP_H__
+#define __MACRO_SHORTCUT_LOOKUP_H__
+
+// Includes:
+
+    #include "macro_shortcut_parser.h"
+
+// Macros:
+
+    #define SHORTCUT_LOOKUP_BUCKET_COUNT ${bucketCount}
+    #define SHORTCUT_LOOKUP_TABLE_SIZE ${tableSize}
+
+// Variables:
+
+    extern const uint8_t ShortcutLookupSeeds[SHORTCUT_LOOKUP_BUCKET_COUNT];
+    extern const lookup_record_t ShortcutLookupTable[SHORTCUT_LOOKUP_TABLE_SIZE];
+
+#endif
+`);
+
+fs.writeFileSync(`${__dirname}/../right/src/macro_shortcut_lookup.c`,
+`${header}
+#include "macro_shortcut_lookup.h"
+#include "arduino_hid/ConsumerAPI.h"
+#include "arduino_hid/SystemAPI.h"
+
+const uint8_t ShortcutLookupSeeds[SHORTCUT_LOOKUP_BUCKET_COUNT] = {
+${seedLines.join('\n')}
+};
+
+const lookup_record_t ShortcutLookupTable[SHORTCUT_LOOKUP_TABLE_SIZE] = {
+${tableLines.join('\n')}
+};
+`);
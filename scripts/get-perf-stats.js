@@ -0,0 +1,44 @@
+#!/usr/bin/env node
+const program = require('commander');
+const {openDevice, sendCommand} = require('./uhk-hid');
+
+const UsbCommandId_GetPerfStats = 0x15;
+const probeNames = ['matrixScan', 'i2cRoundTrip', 'updateReports', 'continueMacro', 'runPostponedEvents', 'usbSend'];
+
+program
+    .usage('[options]')
+    .option('-r, --reset', 'reset the probes after reading them')
+    .parse(process.argv);
+
+function formatBuckets(buckets) {
+    return buckets
+        .map((count, i) => count ? (i === buckets.length-1 ? `>=${2 ** i}` : `<${2 ** (i+1)}`) + `us:${count}` : null)
+        .filter(bucket => bucket)
+        .join(' ');
+}
+
+const device = openDevice();
+
+for (let probeId = 0; ; probeId++) {
+    const response = sendCommand(device, [UsbCommandId_GetPerfStats, probeId, program.reset ? 1 : 0]);
+    if (response[0] !== 0) {
+        break;
+    }
+
+    const probeCount = response[1];
+    const bucketCount = response[2];
+    const count = response.readUInt32LE(3);
+    const min = response.readUInt32LE(7);
+    const max = response.readUInt32LE(11);
+    const avg = response.readUInt32LE(15);
+    const buckets = [...Array(bucketCount).keys()].map(i => response.readUInt16LE(19 + 2*i));
+
+    const name = probeNames[probeId] || `probe${probeId}`;
+    console.log(`${name.padEnd(20)} count:${count} min:${min}us avg:${avg}us max:${max}us  ${formatBuckets(buckets)}`);
+
+    if (probeId+1 >= probeCount) {
+        break;
+    }
+}
+
+device.close();
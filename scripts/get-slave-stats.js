@@ -0,0 +1,41 @@
+#!/usr/bin/env node
+const program = require('commander');
+const {openDevice, sendCommand} = require('./uhk-hid');
+
+const UsbCommandId_GetSlaveSchedulerStats = 0x17;
+const slaveNames = ['leftKeyboardHalf', 'leftModule', 'rightModule', 'rightTouchpad', 'rightLedDriver', 'leftLedDriver', 'moduleLeftLedDriver', 'kbootDriver'];
+
+program
+    .usage('[options]')
+    .option('-r, --reset', 'reset the counters after reading them')
+    .parse(process.argv);
+
+const device = openDevice();
+
+for (let slaveId = 0; ; slaveId++) {
+    const response = sendCommand(device, [UsbCommandId_GetSlaveSchedulerStats, slaveId, program.reset ? 1 : 0]);
+    if (response[0] !== 0) {
+        break;
+    }
+
+    const slaveCount = response[1];
+    const isConnected = response[2];
+    const isKeySlave = response[3];
+    const transferCount = response.readUInt32LE(4);
+    const averageTurnLatency = response.readUInt32LE(8);
+    const reconnectBackoff = response.readUInt16LE(12);
+    const keySlaveWeight = response[14];
+
+    if (slaveId === 0) {
+        console.log(`key slave weight: ${keySlaveWeight}`);
+    }
+    const name = slaveNames[slaveId] || `slave${slaveId}`;
+    const state = isConnected ? 'connected' : `disconnected, backoff ${reconnectBackoff}ms`;
+    console.log(`${name.padEnd(20)} ${isKeySlave ? 'key ' : 'misc'} transfers:${transferCount} avg turn:${averageTurnLatency}us  ${state}`);
+
+    if (slaveId+1 >= slaveCount) {
+        break;
+    }
+}
+
+device.close();
@@ -0,0 +1,54 @@
+#!/usr/bin/env node
+const program = require('commander');
+const {openDevice, sendCommand} = require('./uhk-hid');
+
+const UsbCommandId_GetStatusBuffer = 0x16;
+const chunkOffset = 10;
+
+program
+    .usage('[options]')
+    .option('-f, --follow', 'keep polling for new status text')
+    .option('-n, --new', 'skip the text which is already in the buffer')
+    .option('-i, --interval <ms>', 'polling interval of --follow', 100)
+    .parse(process.argv);
+
+function readChunk(device, position) {
+    const request = Buffer.alloc(5);
+    request.writeUInt8(UsbCommandId_GetStatusBuffer, 0);
+    request.writeUInt32LE(position, 1);
+    const response = sendCommand(device, [...request]);
+    if (response[0] !== 0) {
+        throw new Error(`GetStatusBuffer failed with status ${response[0]}.`);
+    }
+    return {
+        head: response.readUInt32LE(1),
+        position: response.readUInt32LE(5),
+        text: response.toString('latin1', chunkOffset, chunkOffset + response[9]),
+    };
+}
+
+const device = openDevice();
+let position = program.new ? readChunk(device, 0).head : 0;
+
+function drain() {
+    for (;;) {
+        const chunk = readChunk(device, position);
+        if (chunk.position > position) {
+            process.stderr.write(`\n[${chunk.position - position} characters skipped]\n`);
+        } else if (chunk.position < position) {
+            process.stderr.write('\n[the status buffer has been restarted]\n');
+        }
+        process.stdout.write(chunk.text);
+        position = chunk.position + chunk.text.length;
+        if (position === chunk.head) {
+            return;
+        }
+    }
+}
+
+drain();
+if (program.follow) {
+    setInterval(drain, program.interval);
+} else {
+    device.close();
+}
@@ -0,0 +1,22 @@
+const HID = require('node-hid');
+
+const vendorId = 0x1D50;
+const productIds = [0x6122, 0x6124];
+const genericHidInterface = 0;
+
+function openDevice() {
+    const deviceInfo = HID.devices().find(device =>
+        device.vendorId === vendorId && productIds.includes(device.productId) && device.interface === genericHidInterface);
+    if (!deviceInfo) {
+        throw new Error('No UHK found on the USB bus.');
+    }
+    return new HID.HID(deviceInfo.path);
+}
+
+// Sends a generic HID command and returns its 64 byte response. The leading zero is the report id expected by hidapi.
+function sendCommand(device, bytes) {
+    device.write([0, ...bytes]);
+    return Buffer.from(device.readTimeout(1000));
+}
+
+module.exports = {openDevice, sendCommand};
@@ -7,11 +7,7 @@
 
 // Macros:
 
+    // Key states are kept as bitmaps on both halves, this is the byte count of such a bitmap.
     #define BOOL_BYTES_TO_BITS_COUNT(BYTE_COUNT) (BYTE_COUNT/8 + (BYTE_COUNT % 8 ? 1 : 0))
 
-// Functions:
-
-    void BoolBytesToBits(const uint8_t *srcBytes, uint8_t *dstBits, uint8_t byteCount);
-    void BoolBitsToBytes(uint8_t *srcBits, uint8_t *dstBytes, uint8_t byteCount);
-
 #endif
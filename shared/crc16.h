@@ -7,6 +7,21 @@
 
 #define CRC16_HASH_LENGTH 2 // bytes
 
+// CRC-CCITT (polynomial 0x1021, zero seed) implementations, selectable at build time
+// by defining CRC16_IMPLEMENTATION. The hardware one is the default where available.
+#define CRC16_IMPLEMENTATION_BITWISE 0
+#define CRC16_IMPLEMENTATION_NIBBLE_TABLE 1 // 32 bytes of flash
+#define CRC16_IMPLEMENTATION_BYTE_TABLE 2 // 512 bytes of flash
+#define CRC16_IMPLEMENTATION_HARDWARE 3 // the CRC peripheral of the MK22
+
+#ifndef CRC16_IMPLEMENTATION
+    #if defined(FSL_FEATURE_SOC_CRC_COUNT) && FSL_FEATURE_SOC_CRC_COUNT
+        #define CRC16_IMPLEMENTATION CRC16_IMPLEMENTATION_HARDWARE
+    #else
+        #define CRC16_IMPLEMENTATION CRC16_IMPLEMENTATION_BYTE_TABLE
+    #endif
+#endif
+
 typedef struct Crc16Data {
     uint16_t currentCrc;
 } crc16_data_t;
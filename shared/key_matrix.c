@@ -22,13 +22,16 @@ void KeyMatrix_Init(key_matrix_t *keyMatrix)
 
 void KeyMatrix_ScanRow(key_matrix_t *keyMatrix)
 {
-    uint8_t *keyState = keyMatrix->keyStates + keyMatrix->currentRowNum * keyMatrix->colNum;
+    uint8_t rowOffset = keyMatrix->currentRowNum * keyMatrix->colNum;
     key_matrix_pin_t *row = keyMatrix->rows + keyMatrix->currentRowNum;
 
-    key_matrix_pin_t *colEnd = keyMatrix->cols + keyMatrix->colNum;
-    for (key_matrix_pin_t *col = keyMatrix->cols; col<colEnd; col++) {
-        *(keyState++) = GPIO_ReadPinInput(col->gpio, col->pin);
+    uint32_t rowStates = 0;
+    for (uint8_t colId=0; colId<keyMatrix->colNum; colId++) {
+        key_matrix_pin_t *col = keyMatrix->cols + colId;
+        rowStates |= GPIO_ReadPinInput(col->gpio, col->pin) << colId;
     }
+    uint64_t rowMask = ((1ULL << keyMatrix->colNum) - 1) << rowOffset;
+    keyMatrix->keyStates = (keyMatrix->keyStates & ~rowMask) | ((uint64_t)rowStates << rowOffset);
 
     GPIO_WritePinOutput(row->gpio, row->pin, 0);
 
@@ -8,7 +8,7 @@
 
 // Macros:
 
-    #define MAX_KEYS_IN_MATRIX 100
+    #define MAX_KEYS_IN_MATRIX 64 // the width of keyStates
 
 // Typedefs:
 
@@ -25,7 +25,7 @@
         uint8_t currentRowNum;
         key_matrix_pin_t *cols;
         key_matrix_pin_t *rows;
-        uint8_t keyStates[MAX_KEYS_IN_MATRIX];
+        volatile uint64_t keyStates; // bit n is set while key n is pressed
     } key_matrix_t;
 
 // Variables:
@@ -13,8 +13,10 @@ void KeyVector_Init(key_vector_t *keyVector)
 
 void KeyVector_Scan(key_vector_t *keyVector)
 {
-    uint8_t *keyState = keyVector->keyStates;
-    for (key_vector_pin_t *item = keyVector->items; item < keyVector->items + keyVector->itemNum; item++) {
-        *(keyState++) = !GPIO_ReadPinInput(item->gpio, item->pin);
+    uint32_t keyStates = 0;
+    for (uint8_t itemId=0; itemId<keyVector->itemNum; itemId++) {
+        key_vector_pin_t *item = keyVector->items + itemId;
+        keyStates |= !GPIO_ReadPinInput(item->gpio, item->pin) << itemId;
     }
+    keyVector->keyStates = keyStates;
 }
@@ -8,7 +8,7 @@
 
 // Macros:
 
-    #define MAX_KEYS_IN_VECTOR 20
+    #define MAX_KEYS_IN_VECTOR 32 // the width of keyStates
 
 // Typedefs:
 
@@ -22,7 +22,7 @@
     typedef struct {
         uint8_t itemNum;
         key_vector_pin_t *items;
-        uint8_t keyStates[MAX_KEYS_IN_VECTOR];
+        volatile uint32_t keyStates; // bit n is set while key n is pressed
     } key_vector_t;
 
 // Variables:
@@ -25,6 +25,69 @@ static version_t firmwareVersion = {
     FIRMWARE_PATCH_VERSION,
 };
 
+#define KEY_STATES_LENGTH BOOL_BYTES_TO_BITS_COUNT(MODULE_KEY_COUNT)
+
+static uint8_t keyStatesSequence = KEY_STATES_UNKNOWN_SEQUENCE + 1;
+static uint64_t lastSentKeyStates;
+static bool isMasterInSync;
+
+static uint64_t getKeyStates(void)
+{
+    #if KEY_ARRAY_TYPE == KEY_ARRAY_TYPE_VECTOR
+        return KeyVector.keyStates;
+    #elif KEY_ARRAY_TYPE == KEY_ARRAY_TYPE_MATRIX
+        return KeyMatrix.keyStates;
+    #endif
+}
+
+// The message carries the key state bitmap in little endian byte order, as it is laid out in memory.
+static void fillKeyStates(uint8_t *data, uint64_t keyStates)
+{
+    memcpy(data, &keyStates, KEY_STATES_LENGTH);
+}
+
+// Appends the pointer delta accumulated since the last message and returns its length.
+static uint8_t takePointerDelta(uint8_t *data)
+{
+    if (!MODULE_POINTER_COUNT) {
+        return 0;
+    }
+    pointer_delta_t *pointerDelta = (pointer_delta_t*)data;
+    pointerDelta->x = PointerDelta.x;
+    pointerDelta->y = PointerDelta.y;
+    PointerDelta.x = 0;
+    PointerDelta.y = 0;
+    return sizeof(pointer_delta_t);
+}
+
+// Used if the master acks sequence numbers, see key_states_message_type_t.
+static void fillDeltaKeyStatesMessage(void)
+{
+    uint64_t keyStates = getKeyStates();
+    bool isPointerMoving = MODULE_POINTER_COUNT && (PointerDelta.x || PointerDelta.y);
+    bool areKeyStatesChanged = keyStates != lastSentKeyStates;
+
+    if (isMasterInSync && !areKeyStatesChanged && !isPointerMoving) {
+        TxMessage.data[0] = KeyStatesMessage_Unchanged;
+        TxMessage.data[1] = keyStatesSequence;
+        TxMessage.length = KEY_STATES_DELTA_HEADER_LENGTH;
+        return;
+    }
+
+    if (areKeyStatesChanged || isPointerMoving) {
+        if (++keyStatesSequence == KEY_STATES_UNKNOWN_SEQUENCE) {
+            keyStatesSequence++;
+        }
+        lastSentKeyStates = keyStates;
+    }
+    uint8_t *data = TxMessage.data + KEY_STATES_DELTA_HEADER_LENGTH;
+    fillKeyStates(data, keyStates);
+    TxMessage.data[0] = KeyStatesMessage_Full;
+    TxMessage.data[1] = keyStatesSequence;
+    TxMessage.length = KEY_STATES_DELTA_HEADER_LENGTH + KEY_STATES_LENGTH + takePointerDelta(data + KEY_STATES_LENGTH);
+    isMasterInSync = true;
+}
+
 void SlaveRxHandler(void)
 {
     if (!CRC16_IsMessageValid(&RxMessage)) {
@@ -47,6 +110,11 @@ void SlaveRxHandler(void)
             uint8_t brightnessPercent = RxMessage.data[1];
             LedPwm_SetBrightness(brightnessPercent);
             break;
+        case SlaveCommand_RequestKeyStates:
+            if (RxMessage.length > 1) {
+                isMasterInSync = RxMessage.data[1] == keyStatesSequence;
+            }
+            break;
     }
 }
 
@@ -91,21 +159,12 @@ void SlaveTxHandler(void)
             break;
         }
         case SlaveCommand_RequestKeyStates: {
-            #if KEY_ARRAY_TYPE == KEY_ARRAY_TYPE_VECTOR
-                BoolBytesToBits(KeyVector.keyStates, TxMessage.data, MODULE_KEY_COUNT);
-            #elif KEY_ARRAY_TYPE == KEY_ARRAY_TYPE_MATRIX
-                BoolBytesToBits(KeyMatrix.keyStates, TxMessage.data, MODULE_KEY_COUNT);
-            #endif
-            uint8_t messageLength = BOOL_BYTES_TO_BITS_COUNT(MODULE_KEY_COUNT);
-            if (MODULE_POINTER_COUNT) {
-                pointer_delta_t *pointerDelta = (pointer_delta_t*)(TxMessage.data + messageLength);
-                pointerDelta->x = PointerDelta.x;
-                pointerDelta->y = PointerDelta.y;
-                PointerDelta.x = 0;
-                PointerDelta.y = 0;
-                messageLength += sizeof(pointer_delta_t);
+            if (RxMessage.length > 1) {
+                fillDeltaKeyStatesMessage();
+                break;
             }
-            TxMessage.length = messageLength;
+            fillKeyStates(TxMessage.data, getKeyStates());
+            TxMessage.length = KEY_STATES_LENGTH + takePointerDelta(TxMessage.data + KEY_STATES_LENGTH);
             break;
         }
     }
@@ -15,6 +15,9 @@
     #define SLAVE_SYNC_STRING "SYNC"
     #define SLAVE_SYNC_STRING_LENGTH (sizeof(SLAVE_SYNC_STRING) - 1)
 
+    #define KEY_STATES_DELTA_HEADER_LENGTH 2 // key_states_message_type_t and sequence number
+    #define KEY_STATES_UNKNOWN_SEQUENCE 0 // never sent by modules, so acking it always yields a full message
+
 // Typedefs:
 
     typedef enum {
@@ -25,6 +28,13 @@
         SlaveCommand_SetLedPwmBrightness,
     } slave_command_t;
 
+    // Since module protocol 4.2.0, a RequestKeyStates command may carry the sequence number of
+    // the last key states received by the master. Then the module answers by a message of one of these types.
+    typedef enum {
+        KeyStatesMessage_Unchanged, // nothing changed since the message of the given sequence number
+        KeyStatesMessage_Full,
+    } key_states_message_type_t;
+
     typedef enum {
         SlaveProperty_Sync,
         SlaveProperty_ModuleProtocolVersion,
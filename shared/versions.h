@@ -27,7 +27,7 @@
     #define DEVICE_PROTOCOL_PATCH_VERSION 1
 
     #define MODULE_PROTOCOL_MAJOR_VERSION 4
-    #define MODULE_PROTOCOL_MINOR_VERSION 1
+    #define MODULE_PROTOCOL_MINOR_VERSION 2
     #define MODULE_PROTOCOL_PATCH_VERSION 0
 
     #define USER_CONFIG_MAJOR_VERSION 4
@@ -0,0 +1,447 @@
+#include <glob.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "trace.h"
+#include "crc16.h"
+#include "hal_shims.h"
+#include "macros.h"
+#include "macro_bytecode.h"
+#include "macro_shortcut_parser.h"
+#include "postponer.h"
+#include "right_key_matrix.h"
+#include "status_buffer.h"
+#include "usb_report_updater.h"
+
+// Benchmarks of the host build. Every trace in traces/ is one: it is replayed BENCH_REPEATS times, and
+// the mean host time per UpdateUsbReports call is reported, together with the mean latency from a key
+// press to the next keyboard report. The microbenchmarks below time a single
+// operation in a loop instead.
+//
+// Host time depends on the machine and its load, so it is only meaningful next to a baseline build of
+// the same benchmarks on the same host. make bench builds one, runs both in turns and fails if a
+// benchmark got slower by more than the given ratio.
+//
+//   bench [-b <baseline bench>] [-m <max ratio>]   run all benchmarks
+//   bench -r <trace or microbenchmark>             run one benchmark and print its ns per operation
+
+#define BENCH_REPEATS 10
+#define BENCH_ROUNDS 5
+#define BENCH_DEFAULT_MAX_RATIO 1.25
+
+typedef struct {
+    const char *name;
+    uint32_t iterations;
+    bool (*setup)(void); // tells whether the benchmark is ready to run
+    void (*run)(uint32_t iterations);
+} microbenchmark_t;
+
+typedef struct {
+    double time; // ns per operation
+    double latency; // ms, traces only
+    bool found;
+} bench_result_t;
+
+static trace_t trace;
+
+static uint64_t nanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Microbenchmarks
+
+static void runUpdates(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        HalShims_AdvanceTime(1000);
+        HalShims_CompleteSends();
+        UpdateUsbReports();
+    }
+}
+
+static bool loadMacros(const char *text)
+{
+    FILE *file = fmemopen((void*)text, strlen(text), "r");
+    bool loaded = Trace_Read(file, "microbenchmark", &trace);
+    fclose(file);
+    return loaded;
+}
+
+// Holds the given number of keys of the right half, each mapped to its own keystroke, for as long as
+// the benchmark runs. Only held, debouncing and active keys are processed per update, so its cost
+// should grow with their count, not with the size of the matrix.
+static bool holdKeys(uint8_t keyCount)
+{
+    char text[64 * 16] = "";
+    char *line = text;
+
+    for (uint8_t keyId = 0; keyId < keyCount; keyId++) {
+        line += sprintf(line, "key %u 0x%02x\n", keyId, HID_KEYBOARD_SC_A + keyId);
+    }
+    if (keyCount && !loadMacros(text)) {
+        return false;
+    }
+    RightKeyMatrix.keyStates = (1ULL << keyCount) - 1;
+    runUpdates(100);
+    return true;
+}
+
+#define HELD_KEYS(KEY_COUNT) \
+    static bool hold ## KEY_COUNT ## Keys(void) { return holdKeys(KEY_COUNT); }
+
+HELD_KEYS(0)
+HELD_KEYS(2)
+HELD_KEYS(10)
+HELD_KEYS(30)
+
+// A loop of instant commands, one of them run per Macros_ContinueMacro call.
+static const char *macroActionsLoop =
+    "command 0 setReg 1 0\n"
+    "command 0 addReg 1 7\n"
+    "command 0 ifRegEq 1 7 noOp\n"
+    "command 0 goTo @-3\n";
+
+static bool startMacroActionsLoop(void)
+{
+    if (!loadMacros(macroActionsLoop)) {
+        return false;
+    }
+    MacroActionBudget = 0;
+    RightKeyMatrix.keyStates = 1 << 0;
+    runUpdates(20);
+    return MacroPlaying;
+}
+
+// The same loop without the compiled instructions and indices, as macros were run before.
+static bool startDecodedMacroActionsLoop(void)
+{
+    bool started = startMacroActionsLoop();
+    MacroBytecode_Reset();
+    return started;
+}
+
+// A two action loop at the end of a macro of the given length. Before the index, every jump parsed the
+// macro from its first action and looked for the label in all of its actions, as the decoded ones do.
+static bool startLoopAtEndOfMacro(uint8_t actionCount, bool decoded)
+{
+    static char macroText[255 * 24];
+    char *text = macroText;
+
+    for (uint8_t i = 0; i < actionCount - 2; i++) {
+        text += sprintf(text, "command 0 noOp\n");
+    }
+    sprintf(text, "command 0 loop: noOp\ncommand 0 goTo loop\n");
+    if (!loadMacros(macroText)) {
+        return false;
+    }
+    MacroActionBudget = 0;
+    RightKeyMatrix.keyStates = 1 << 0;
+    runUpdates(actionCount);
+    if (decoded) {
+        MacroBytecode_Reset();
+    }
+    return MacroPlaying;
+}
+
+#define LOOP_AT_END_OF_MACRO(ACTION_COUNT) \
+    static bool startLoopIn ## ACTION_COUNT ## ActionMacro(void) { return startLoopAtEndOfMacro(ACTION_COUNT, false); } \
+    static bool startDecodedLoopIn ## ACTION_COUNT ## ActionMacro(void) { return startLoopAtEndOfMacro(ACTION_COUNT, true); }
+
+LOOP_AT_END_OF_MACRO(10)
+LOOP_AT_END_OF_MACRO(100)
+LOOP_AT_END_OF_MACRO(255)
+
+// A macro which waits for a full postponer queue, i.e., POSTPONER_BUFFER_MAX_FILL pending presses, and
+// then keeps checking a 4 key chord against it with ifShortcut. In fixed order, the chord is at the front
+// of the queue, otherwise at its end.
+static bool startShortcutOverFullQueue(bool fixedOrder)
+{
+    char text[POSTPONER_BUFFER_SIZE * 16];
+    char *line = text;
+    uint8_t first = fixedOrder ? 1 : POSTPONER_BUFFER_MAX_FILL - 3;
+
+    line += sprintf(line, "command 0 postponeKeys ifNotPending %u goTo @0\n", POSTPONER_BUFFER_MAX_FILL);
+    if (fixedOrder) {
+        line += sprintf(line, "command 0 ifShortcut noConsume %u %u %u %u goTo @0\n", first, first + 1, first + 2, first + 3);
+    } else {
+        line += sprintf(line, "command 0 ifShortcut noConsume anyOrder %u %u %u %u goTo @0\n", first + 3, first + 2, first + 1, first);
+    }
+    for (uint8_t keyId = 1; keyId <= POSTPONER_BUFFER_MAX_FILL; keyId++) {
+        line += sprintf(line, "key %u 0x%02x\n", keyId, HID_KEYBOARD_SC_A + keyId);
+    }
+    if (!loadMacros(text)) {
+        return false;
+    }
+    MacroActionBudget = 0;
+    RightKeyMatrix.keyStates = 1 << 0;
+    runUpdates(20);
+    for (uint8_t keyId = 1; keyId <= POSTPONER_BUFFER_MAX_FILL; keyId++) {
+        RightKeyMatrix.keyStates |= 1ULL << keyId;
+        runUpdates(1);
+    }
+    runUpdates(20);
+    return MacroPlaying && PostponerQuery_PendingKeypressCount() == POSTPONER_BUFFER_MAX_FILL;
+}
+
+static bool startShortcutAtFrontOfFullQueue(void)
+{
+    return startShortcutOverFullQueue(true);
+}
+
+static bool startShortcutAtEndOfFullQueue(void)
+{
+    return startShortcutOverFullQueue(false);
+}
+
+// Abbreviations as tapKey and pressKey get them: single characters, names from all over the table, and
+// names behind modifier prefixes.
+static const char *shortcuts[] = {
+    "a", "7", "enter", "space", "leftArrow", "pageDown", "f12", "printScreen", "mediaPlayPause",
+    "keypadEnter", "mouseBtn4", "systemSleep", "LS-tab", "LC-f4", "RA-semicolonAndColon", "LSLC-escape",
+};
+
+#define SHORTCUT_COUNT (sizeof(shortcuts) / sizeof(shortcuts[0]))
+
+// Tells whether the parser knows all of the abbreviations, since it reports unknown ones to the status buffer.
+static bool checkShortcuts(void)
+{
+    uint32_t statusHead = StatusBuffer_Head;
+
+    for (uint8_t i = 0; i < SHORTCUT_COUNT; i++) {
+        MacroShortcutParser_Parse(shortcuts[i], shortcuts[i] + strlen(shortcuts[i]), MacroSubAction_Tap);
+    }
+    return StatusBuffer_Head == statusHead;
+}
+
+static void runShortcutLookups(uint32_t iterations)
+{
+    static uint8_t shortcutLengths[SHORTCUT_COUNT];
+    volatile uint8_t scancodes = 0;
+
+    for (uint8_t i = 0; i < SHORTCUT_COUNT; i++) {
+        shortcutLengths[i] = strlen(shortcuts[i]);
+    }
+    for (uint32_t i = 0; i < iterations; i++) {
+        const char *shortcut = shortcuts[i % SHORTCUT_COUNT];
+        macro_action_t action = MacroShortcutParser_Parse(shortcut, shortcut + shortcutLengths[i % SHORTCUT_COUNT], MacroSubAction_Tap);
+        scancodes += action.key.scancode;
+    }
+}
+
+// Checks the CRC16 of an i2c message per operation, as the right half does for every message of a module.
+static i2c_message_t crcMessage;
+
+static bool fillCrcMessage(uint8_t length)
+{
+    crcMessage.length = length;
+    for (uint16_t i = 0; i < length; i++) {
+        crcMessage.data[i] = i * 37 + 11;
+    }
+    CRC16_UpdateMessageChecksum(&crcMessage);
+    return CRC16_IsMessageValid(&crcMessage);
+}
+
+#define CRC16_MESSAGE(LENGTH) \
+    static bool fill ## LENGTH ## ByteCrcMessage(void) { return fillCrcMessage(LENGTH); }
+
+CRC16_MESSAGE(1)
+CRC16_MESSAGE(16)
+CRC16_MESSAGE(64)
+CRC16_MESSAGE(255)
+
+static void runCrcChecks(uint32_t iterations)
+{
+    volatile bool valid = true;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        valid &= CRC16_IsMessageValid(&crcMessage);
+    }
+}
+
+static void runMacroActions(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        Macros_ContinueMacro();
+    }
+}
+
+static const microbenchmark_t microbenchmarks[] = {
+    { .name = "held_0_keys", .iterations = 100000, .setup = hold0Keys, .run = runUpdates },
+    { .name = "held_2_keys", .iterations = 100000, .setup = hold2Keys, .run = runUpdates },
+    { .name = "held_10_keys", .iterations = 100000, .setup = hold10Keys, .run = runUpdates },
+    { .name = "held_30_keys", .iterations = 100000, .setup = hold30Keys, .run = runUpdates },
+    { .name = "macro_actions", .iterations = 100000, .setup = startMacroActionsLoop, .run = runMacroActions },
+    { .name = "macro_actions_decoded", .iterations = 100000, .setup = startDecodedMacroActionsLoop, .run = runMacroActions },
+    { .name = "if_shortcut_full_queue", .iterations = 100000, .setup = startShortcutAtFrontOfFullQueue, .run = runMacroActions },
+    { .name = "if_shortcut_any_order", .iterations = 100000, .setup = startShortcutAtEndOfFullQueue, .run = runMacroActions },
+    { .name = "shortcut_lookup", .iterations = 1000000, .setup = checkShortcuts, .run = runShortcutLookups },
+    { .name = "crc16_1_byte", .iterations = 1000000, .setup = fill1ByteCrcMessage, .run = runCrcChecks },
+    { .name = "crc16_16_bytes", .iterations = 1000000, .setup = fill16ByteCrcMessage, .run = runCrcChecks },
+    { .name = "crc16_64_bytes", .iterations = 100000, .setup = fill64ByteCrcMessage, .run = runCrcChecks },
+    { .name = "crc16_255_bytes", .iterations = 100000, .setup = fill255ByteCrcMessage, .run = runCrcChecks },
+    { .name = "loop_in_10_actions", .iterations = 100000, .setup = startLoopIn10ActionMacro, .run = runMacroActions },
+    { .name = "loop_in_10_decoded", .iterations = 100000, .setup = startDecodedLoopIn10ActionMacro, .run = runMacroActions },
+    { .name = "loop_in_100_actions", .iterations = 100000, .setup = startLoopIn100ActionMacro, .run = runMacroActions },
+    { .name = "loop_in_100_decoded", .iterations = 10000, .setup = startDecodedLoopIn100ActionMacro, .run = runMacroActions },
+    { .name = "loop_in_255_actions", .iterations = 100000, .setup = startLoopIn255ActionMacro, .run = runMacroActions },
+    { .name = "loop_in_255_decoded", .iterations = 10000, .setup = startDecodedLoopIn255ActionMacro, .run = runMacroActions },
+};
+
+static const microbenchmark_t* findMicrobenchmark(const char *name)
+{
+    for (uint8_t i = 0; i < sizeof(microbenchmarks) / sizeof(microbenchmarks[0]); i++) {
+        if (strcmp(microbenchmarks[i].name, name) == 0) {
+            return &microbenchmarks[i];
+        }
+    }
+    return NULL;
+}
+
+static bool runMicrobenchmark(const microbenchmark_t *microbenchmark)
+{
+    double bestTime = 0;
+
+    HalShims_Reset();
+    if (microbenchmark->setup && !microbenchmark->setup()) {
+        fprintf(stderr, "%s: setup failed\n", microbenchmark->name);
+        return false;
+    }
+    for (uint8_t i = 0; i < BENCH_REPEATS; i++) {
+        uint64_t start = nanoseconds();
+        microbenchmark->run(microbenchmark->iterations);
+        double time = (double)(nanoseconds() - start) / microbenchmark->iterations;
+        if (i == 0 || time < bestTime) {
+            bestTime = time;
+        }
+    }
+    printf("%.1f\n", bestTime);
+    return true;
+}
+
+// Scheduling and interrupts of the host only ever add time, so every update is timed by its fastest
+// replay, which keeps the result stable on a busy machine.
+static bool runTrace(const char *tracePath)
+{
+    trace_stats_t stats = {};
+
+    HalShims_Reset();
+    if (!Trace_Load(tracePath, &trace)) {
+        return false;
+    }
+    uint32_t *bestUpdateTimes = malloc(trace.duration * sizeof(uint32_t));
+    stats.updateTimes = malloc(trace.duration * sizeof(uint32_t));
+    for (uint8_t i = 0; i < BENCH_REPEATS; i++) {
+        HalShims_Reset();
+        Trace_Replay(&trace, &stats);
+        for (uint32_t update = 0; update < stats.updateCount; update++) {
+            if (i == 0 || stats.updateTimes[update] < bestUpdateTimes[update]) {
+                bestUpdateTimes[update] = stats.updateTimes[update];
+            }
+        }
+    }
+
+    uint64_t totalTime = 0;
+    for (uint32_t update = 0; update < stats.updateCount; update++) {
+        totalTime += bestUpdateTimes[update];
+    }
+    printf("%.1f %.2f\n", (double)totalTime / stats.updateCount, stats.latencyCount ? (double)stats.latencySum / stats.latencyCount : 0.0);
+
+    free(bestUpdateTimes);
+    free(stats.updateTimes);
+    return true;
+}
+
+// Runs a benchmark of the given bench binary in its own process, so that it starts from the power-on state of the firmware.
+static bench_result_t runBenchmark(const char *bench, const char *name)
+{
+    char command[2 * PATH_MAX];
+    bench_result_t result = {};
+
+    snprintf(command, sizeof(command), "%s -r %s 2>/dev/null", bench, name);
+    FILE *output = popen(command, "r");
+    if (output) {
+        result.found = fscanf(output, "%lf %lf", &result.time, &result.latency) >= 1;
+        result.found &= pclose(output) == 0;
+    }
+    return result;
+}
+
+static bool compareBenchmark(const char *bench, const char *baseline, const char *name, double maxRatio)
+{
+    bench_result_t best = {}, bestBaseline = {};
+
+    for (uint8_t round = 0; round < BENCH_ROUNDS; round++) {
+        bench_result_t result = runBenchmark(bench, name);
+        if (!result.found) {
+            printf("%-24s failed\n", name);
+            return false;
+        }
+        if (round == 0 || result.time < best.time) {
+            best = result;
+        }
+        if (!baseline) {
+            continue;
+        }
+        result = runBenchmark(baseline, name);
+        if (result.found && (!bestBaseline.found || result.time < bestBaseline.time)) {
+            bestBaseline = result;
+        }
+    }
+
+    if (!bestBaseline.found) {
+        printf("%-24s %9.1f ns %12s %6s %7.2f ms\n", name, best.time, "", "", best.latency);
+        return true;
+    }
+    double ratio = best.time / bestBaseline.time;
+    bool passed = ratio <= maxRatio;
+    printf("%-24s %9.1f ns %9.1f ns %6.2f %7.2f ms %s\n",
+        name, best.time, bestBaseline.time, ratio, best.latency, passed ? "" : "SLOWER THAN BASELINE");
+    return passed;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baseline = NULL;
+    double maxRatio = BENCH_DEFAULT_MAX_RATIO;
+    int option;
+
+    while ((option = getopt(argc, argv, "r:b:m:")) != -1) {
+        switch (option) {
+            case 'r': {
+                const microbenchmark_t *microbenchmark = findMicrobenchmark(optarg);
+                bool ran = microbenchmark ? runMicrobenchmark(microbenchmark) : runTrace(optarg);
+                return ran ? EXIT_SUCCESS : EXIT_FAILURE;
+            }
+            case 'b':
+                baseline = optarg;
+                break;
+            case 'm':
+                maxRatio = atof(optarg);
+                break;
+            default:
+                return EXIT_FAILURE;
+        }
+    }
+
+    glob_t traces;
+    bool passed = true;
+
+    if (glob("traces/*.trace", 0, NULL, &traces) != 0) {
+        fprintf(stderr, "no traces found\n");
+        return EXIT_FAILURE;
+    }
+    printf("%-24s %12s %12s %6s %10s\n", "benchmark", "time", baseline ? "baseline" : "", baseline ? "ratio" : "", "latency");
+    for (size_t i = 0; i < traces.gl_pathc; i++) {
+        passed &= compareBenchmark(argv[0], baseline, traces.gl_pathv[i], maxRatio);
+    }
+    for (uint8_t i = 0; i < sizeof(microbenchmarks) / sizeof(microbenchmarks[0]); i++) {
+        passed &= compareBenchmark(argv[0], baseline, microbenchmarks[i].name, maxRatio);
+    }
+
+    globfree(&traces);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,178 @@
+#!/usr/bin/env node
+const fs = require('fs');
+
+// Writes qwerty.bin, a user configuration in the binary format which Agent sends with WriteConfig
+// and ApplyConfig. It stands in for a configuration exported by Agent, which can be dropped next
+// to it and loaded by a trace the same way.
+//
+// Keys are listed in key matrix order, 7 per row. null leaves a key unmapped.
+
+const package = JSON.parse(fs.readFileSync(`${__dirname}/../../scripts/package.json`));
+
+const SerializedKeyActionType_None = 0;
+const SerializedKeyActionType_SwitchLayer = 32;
+const SerializedKeyActionType_Mouse = 34;
+const SerializedKeyActionType_PlayMacro = 35;
+const SerializedKeystrokeMask_HasScancode = 0b001;
+const SerializedKeystrokeMask_HasModifiers = 0b010;
+const SerializedKeystrokeMask_HasLongpress = 0b100;
+const SerializedMacroActionType_Text = 70;
+const SerializedMacroActionType_Command = 71;
+
+const ModuleId_RightKeyboardHalf = 0;
+const ModuleId_LeftKeyboardHalf = 1;
+const SwitchLayerMode_HoldAndDoubleTapToggle = 0;
+const Layer = {Mod: 1, Fn: 2, Mouse: 3};
+const SecondaryRole = {LeftCtrl: 1, LeftShift: 2, LeftAlt: 3, LeftSuper: 4, RightCtrl: 5, RightShift: 6, RightAlt: 7, RightSuper: 8, Mod: 9, Fn: 10, Mouse: 11};
+const Modifier = {LeftCtrl: 0x01, LeftShift: 0x02, LeftAlt: 0x04, LeftSuper: 0x08, RightCtrl: 0x10, RightShift: 0x20, RightAlt: 0x40, RightSuper: 0x80};
+const MouseAction = {LeftClick: 0, MiddleClick: 1, RightClick: 2, MoveUp: 3, MoveDown: 4, MoveLeft: 5, MoveRight: 6, ScrollUp: 7, ScrollDown: 8};
+
+const scancodes = {
+    ...Object.fromEntries([...'abcdefghijklmnopqrstuvwxyz'].map((letter, i) => [letter, 4 + i])),
+    ...Object.fromEntries([...'1234567890'].map((digit, i) => [digit, 30 + i])),
+    Enter: 40, Escape: 41, Backspace: 42, Tab: 43, Space: 44, '-': 45, '=': 46, '[': 47, ']': 48, '\\': 49,
+    ';': 51, "'": 52, '`': 53, ',': 54, '.': 55, '/': 56, CapsLock: 57,
+    ...Object.fromEntries([...Array(12).keys()].map(i => [`F${i+1}`, 58 + i])),
+    Home: 74, PageUp: 75, Delete: 76, End: 77, PageDown: 78, Right: 79, Left: 80, Down: 81, Up: 82,
+};
+
+const key = (name, {modifiers, secondaryRole} = {}) => ({key: name, modifiers, secondaryRole});
+const modifier = name => ({modifiers: Modifier[name]});
+const layer = name => ({layer: Layer[name]});
+const mouse = name => ({mouse: MouseAction[name]});
+const macro = index => ({macro: index});
+
+const macros = [
+    {name: 'hello', actions: [{text: 'Hello, world!'}]},
+    {name: 'sign', actions: [{command: 'tapKey LC-a'}, {text: 'Best regards'}]},
+];
+
+const keymaps = [{
+    abbreviation: 'QWR',
+    name: 'QWERTY',
+    description: 'Host test keymap',
+    isDefault: true,
+    layers: [
+        {
+            [ModuleId_RightKeyboardHalf]: [
+                '7', '8', '9', '0', '-', '=', 'Backspace',
+                'y', 'u', 'i', 'o', 'p', '[', ']',
+                'h', 'j', 'k', 'l', ';', "'", 'Enter',
+                'n', 'm', ',', '.', '/', modifier('RightShift'), '\\',
+                key('Space', {secondaryRole: 'Fn'}), layer('Mod'), modifier('RightAlt'), modifier('RightSuper'), modifier('RightCtrl'), layer('Fn'), macro(0),
+            ],
+            [ModuleId_LeftKeyboardHalf]: [
+                '`', '1', '2', '3', '4', '5', '6',
+                'Tab', 'q', 'w', 'e', 'r', 't', null,
+                layer('Mouse'), 'a', 's', 'd', 'f', 'g', null,
+                modifier('LeftShift'), null, 'z', 'x', 'c', 'v', 'b',
+                modifier('LeftCtrl'), modifier('LeftSuper'), modifier('LeftAlt'), layer('Fn'), key('Space', {secondaryRole: 'Mod'}), layer('Mod'), macro(1),
+            ],
+        },
+        {
+            [ModuleId_RightKeyboardHalf]: [
+                null, null, null, null, null, null, 'Delete',
+                'PageUp', 'Home', 'Up', 'End', null, null, null,
+                'PageDown', 'Left', 'Down', 'Right', null, null, null,
+            ],
+            [ModuleId_LeftKeyboardHalf]: [
+                'Escape', 'F1', 'F2', 'F3', 'F4', 'F5', 'F6',
+            ],
+        },
+        {
+            [ModuleId_RightKeyboardHalf]: [
+                'F7', 'F8', 'F9', 'F10', 'F11', 'F12', 'Delete',
+            ],
+            [ModuleId_LeftKeyboardHalf]: [
+                'Escape', 'F1', 'F2', 'F3', 'F4', 'F5', 'F6',
+            ],
+        },
+        {
+            [ModuleId_RightKeyboardHalf]: [
+                null, null, null, null, null, null, null,
+                mouse('ScrollUp'), mouse('LeftClick'), mouse('MoveUp'), mouse('RightClick'), null, null, null,
+                mouse('ScrollDown'), mouse('MoveLeft'), mouse('MoveDown'), mouse('MoveRight'), null, null, null,
+            ],
+            [ModuleId_LeftKeyboardHalf]: [],
+        },
+    ],
+}];
+
+const bytes = [];
+const uint8 = value => bytes.push(value & 0xff);
+const uint16 = value => { uint8(value); uint8(value >> 8); };
+const compactLength = length => length < 0xff ? uint8(length) : (uint8(0xff), uint16(length));
+const string = text => { compactLength(Buffer.byteLength(text)); bytes.push(...Buffer.from(text)); };
+
+function writeKeyAction(action) {
+    if (action === null || action === undefined) {
+        uint8(SerializedKeyActionType_None);
+        return;
+    }
+    if (typeof action === 'string') {
+        action = key(action);
+    }
+    if (action.layer !== undefined) {
+        uint8(SerializedKeyActionType_SwitchLayer);
+        uint8(action.layer - 1);
+        uint8(SwitchLayerMode_HoldAndDoubleTapToggle);
+    } else if (action.mouse !== undefined) {
+        uint8(SerializedKeyActionType_Mouse);
+        uint8(action.mouse);
+    } else if (action.macro !== undefined) {
+        uint8(SerializedKeyActionType_PlayMacro);
+        uint8(action.macro);
+    } else {
+        const scancode = scancodes[action.key];
+        uint8((scancode ? SerializedKeystrokeMask_HasScancode : 0) |
+              (action.modifiers ? SerializedKeystrokeMask_HasModifiers : 0) |
+              (action.secondaryRole ? SerializedKeystrokeMask_HasLongpress : 0));
+        scancode && uint8(scancode);
+        action.modifiers && uint8(action.modifiers);
+        action.secondaryRole && uint8(SecondaryRole[action.secondaryRole] - 1);
+    }
+}
+
+const [major, minor, patch] = package.userConfigVersion.split('.').map(Number);
+uint16(major);
+uint16(minor);
+uint16(patch);
+uint16(0); // userConfigLength, patched below
+string('UHK 60 v2');
+uint16(400); // doubleTapSwitchLayerTimeout
+[255, 255, 255].forEach(uint8); // LED brightnesses
+[5, 35, 10, 40, 80, 20, 20, 10, 20, 50].forEach(uint8); // mouse move and scroll speeds
+compactLength(0); // module configurations
+
+compactLength(macros.length);
+for (const {name, actions} of macros) {
+    uint8(0); // isLooped
+    uint8(0); // isPrivate
+    string(name);
+    compactLength(actions.length);
+    for (const action of actions) {
+        uint8(action.command ? SerializedMacroActionType_Command : SerializedMacroActionType_Text);
+        string(action.command || action.text);
+    }
+}
+
+compactLength(keymaps.length);
+for (const keymap of keymaps) {
+    string(keymap.abbreviation);
+    uint8(keymap.isDefault);
+    string(keymap.name);
+    string(keymap.description);
+    compactLength(keymap.layers.length);
+    for (const modules of keymap.layers) {
+        compactLength(Object.keys(modules).length);
+        for (const [moduleId, actions] of Object.entries(modules)) {
+            uint8(moduleId);
+            compactLength(actions.length);
+            actions.forEach(writeKeyAction);
+        }
+    }
+}
+
+bytes[6] = bytes.length & 0xff;
+bytes[7] = bytes.length >> 8;
+fs.writeFileSync(`${__dirname}/qwerty.bin`, Buffer.from(bytes));
@@ -0,0 +1,50 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include "trace.h"
+#include "hal_shims.h"
+
+// Replays a trace and prints the reports sent to the host, one per line: the time in ms, the
+// endpoint and the report bytes. With -t, the time of every UpdateUsbReports call follows
+// as "update <ms> <ns>" lines. A summary goes to stderr.
+
+static trace_t trace;
+
+int main(int argc, char *argv[])
+{
+    bool printUpdateTimes = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "t")) != -1) {
+        if (option != 't') {
+            return EXIT_FAILURE;
+        }
+        printUpdateTimes = true;
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-t] <trace>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    HalShims_Reset();
+    if (!Trace_Load(argv[optind], &trace)) {
+        return EXIT_FAILURE;
+    }
+
+    trace_stats_t stats = {
+        .updateTimes = malloc(trace.duration * sizeof(uint32_t)),
+    };
+    Trace_Replay(&trace, &stats);
+    Trace_WriteReports(stdout);
+
+    if (printUpdateTimes) {
+        for (uint32_t i = 0; i < stats.updateCount; i++) {
+            printf("update %u %u\n", i + 1, stats.updateTimes[i]);
+        }
+    }
+    fprintf(stderr, "%u updates, %.1f ns/update, %.2f ms mean latency\n",
+        stats.updateCount, (double)stats.updateTime / stats.updateCount,
+        stats.latencyCount ? (double)stats.latencySum / stats.latencyCount : 0.0);
+
+    free(stats.updateTimes);
+    return EXIT_SUCCESS;
+}
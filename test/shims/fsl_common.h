@@ -0,0 +1,171 @@
+#ifndef __FSL_COMMON_H__
+#define __FSL_COMMON_H__
+
+// Host stand-in for the KSDK fsl_common.h. Only what the firmware sources under test use.
+
+// Includes:
+
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <string.h>
+    #include <strings.h>
+
+// Macros:
+
+    #define MAKE_STATUS(group, code) ((((group)*100) + (code)))
+
+    #define MAX(a, b) (((a) > (b)) ? (a) : (b))
+    #define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+    #define USEC_TO_COUNT(us, clockFreqInHz) (us)
+    #define MSEC_TO_COUNT(ms, clockFreqInHz) (ms)
+    #define COUNT_TO_USEC(count, clockFreqInHz) (count)
+
+// Typedefs:
+
+    typedef int32_t status_t;
+
+    enum {
+        kStatusGroup_Generic = 0,
+        kStatusGroup_I2C = 11,
+        kStatusGroup_SPI = 12,
+    };
+
+    enum {
+        kStatus_Success = 0,
+        kStatus_Fail = 1,
+        kStatus_ReadOnly,
+        kStatus_OutOfRange,
+        kStatus_InvalidArgument,
+        kStatus_Timeout,
+        kStatus_NoTransferInProgress,
+    };
+
+    typedef int IRQn_Type;
+    typedef int clock_ip_name_t;
+    typedef int clock_name_t;
+
+    typedef struct { int unused; } PORT_Type;
+    // The output writes of the KSDK go to the set, clear and toggle registers. Here these keep
+    // the mask of their last write, so that a test can tell a pulse of a pin from no change.
+    typedef struct {
+        uint32_t PDOR; // output pins
+        uint32_t PSOR;
+        uint32_t PCOR;
+        uint32_t PTOR;
+        uint32_t PDIR; // input pins
+    } GPIO_Type;
+    typedef struct { int unused; } I2C_Type;
+    typedef struct { int unused; } SPI_Type;
+
+    typedef struct {
+        volatile uint32_t DATA;
+        volatile uint32_t GPOLY;
+        volatile uint32_t CTRL;
+    } CRC_Type;
+
+    enum {
+        kCLOCK_PortA,
+        kCLOCK_PortB,
+        kCLOCK_PortC,
+        kCLOCK_PortD,
+        kCLOCK_PortE,
+    };
+
+    enum {
+        kCLOCK_CoreSysClk,
+        kCLOCK_BusClk,
+    };
+
+    enum {
+        kGPIO_DigitalInput,
+        kGPIO_DigitalOutput,
+    };
+
+    typedef struct {
+        int pinDirection;
+        uint8_t outputLogic;
+    } gpio_pin_config_t;
+
+    enum {
+        kPORT_MuxAsGpio,
+        kPORT_PullUp,
+        kPORT_PullDown,
+        kPORT_PullDisable,
+        kPORT_MuxAlt2,
+        kPORT_MuxAlt3,
+        kPORT_MuxAlt4,
+        kPORT_MuxAlt7,
+    };
+
+    typedef struct {
+        int pullSelect;
+        int mux;
+    } port_pin_config_t;
+
+// Variables:
+
+    extern uint32_t SystemCoreClock;
+    extern PORT_Type HalShims_Ports[5];
+    extern GPIO_Type HalShims_Gpios[5];
+    extern I2C_Type HalShims_I2cs[2];
+    extern SPI_Type HalShims_Spis[2];
+
+    // Like the peripheral base addresses of the KSDK, these are constants, so pin tables can refer to them.
+    #define PORTA (&HalShims_Ports[0])
+    #define PORTB (&HalShims_Ports[1])
+    #define PORTC (&HalShims_Ports[2])
+    #define PORTD (&HalShims_Ports[3])
+    #define PORTE (&HalShims_Ports[4])
+    #define GPIOA (&HalShims_Gpios[0])
+    #define GPIOB (&HalShims_Gpios[1])
+    #define GPIOC (&HalShims_Gpios[2])
+    #define GPIOD (&HalShims_Gpios[3])
+    #define GPIOE (&HalShims_Gpios[4])
+    #define I2C0 (&HalShims_I2cs[0])
+    #define I2C1 (&HalShims_I2cs[1])
+    #define SPI0 (&HalShims_Spis[0])
+    #define SPI1 (&HalShims_Spis[1])
+
+// Inline functions:
+
+    static inline uint32_t DisableGlobalIRQ(void) { return 0; }
+    static inline void EnableGlobalIRQ(uint32_t primask) {}
+    static inline void EnableIRQ(IRQn_Type irq) {}
+    static inline void NVIC_SystemReset(void) {}
+    static inline void __WFI(void) {}
+
+    static inline void CLOCK_EnableClock(int clock) {}
+    static inline uint32_t CLOCK_GetFreq(clock_name_t name) { return SystemCoreClock; }
+
+    static inline void GPIO_PinInit(GPIO_Type *base, uint32_t pin, const gpio_pin_config_t *config) {}
+    static inline void GPIO_SetPinsOutput(GPIO_Type *base, uint32_t mask)
+    {
+        base->PSOR = mask;
+        base->PDOR |= mask;
+    }
+    static inline void GPIO_ClearPinsOutput(GPIO_Type *base, uint32_t mask)
+    {
+        base->PCOR = mask;
+        base->PDOR &= ~mask;
+    }
+    static inline void GPIO_TogglePinsOutput(GPIO_Type *base, uint32_t mask)
+    {
+        base->PTOR = mask;
+        base->PDOR ^= mask;
+    }
+    static inline void GPIO_WritePinOutput(GPIO_Type *base, uint32_t pin, uint8_t output)
+    {
+        if (output) {
+            GPIO_SetPinsOutput(base, 1U << pin);
+        } else {
+            GPIO_ClearPinsOutput(base, 1U << pin);
+        }
+    }
+    static inline uint32_t GPIO_ReadPinInput(GPIO_Type *base, uint32_t pin) { return (base->PDIR >> pin) & 1; }
+
+    static inline void PORT_SetPinMux(PORT_Type *base, uint32_t pin, int mux) {}
+    static inline void PORT_SetPinConfig(PORT_Type *base, uint32_t pin, const port_pin_config_t *config) {}
+
+#endif
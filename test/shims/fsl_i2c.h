@@ -0,0 +1,49 @@
+#ifndef __FSL_I2C_H__
+#define __FSL_I2C_H__
+
+// Includes:
+
+    #include "fsl_common.h"
+
+// Typedefs:
+
+    enum {
+        kStatus_I2C_Busy = MAKE_STATUS(kStatusGroup_I2C, 0),
+        kStatus_I2C_Idle,
+        kStatus_I2C_Nak,
+        kStatus_I2C_ArbitrationLost,
+        kStatus_I2C_Timeout,
+    };
+
+    enum {
+        kI2C_Write,
+        kI2C_Read,
+    };
+
+    enum {
+        kI2C_TransferDefaultFlag,
+    };
+
+    typedef struct i2c_master_handle i2c_master_handle_t;
+    typedef void (*i2c_master_transfer_callback_t)(I2C_Type *base, i2c_master_handle_t *handle, status_t status, void *userData);
+
+    struct i2c_master_handle {
+        int unused;
+    };
+
+    typedef struct {
+        uint32_t flags;
+        uint8_t slaveAddress;
+        int direction;
+        uint32_t subaddress;
+        uint8_t subaddressSize;
+        uint8_t *data;
+        size_t dataSize;
+    } i2c_master_transfer_t;
+
+// Functions:
+
+    status_t I2C_MasterTransferNonBlocking(I2C_Type *base, i2c_master_handle_t *handle, i2c_master_transfer_t *xfer);
+    void I2C_MasterTransferCreateHandle(I2C_Type *base, i2c_master_handle_t *handle, i2c_master_transfer_callback_t callback, void *userData);
+
+#endif
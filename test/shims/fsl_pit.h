@@ -0,0 +1,8 @@
+#ifndef __FSL_PIT_H__
+#define __FSL_PIT_H__
+
+// Includes:
+
+    #include "fsl_common.h"
+
+#endif
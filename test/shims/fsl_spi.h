@@ -0,0 +1,47 @@
+#ifndef __FSL_SPI_H__
+#define __FSL_SPI_H__
+
+// Includes:
+
+    #include "fsl_common.h"
+
+// Typedefs:
+
+    enum {
+        kSPI_ClockPolarityActiveHigh,
+        kSPI_ClockPolarityActiveLow,
+    };
+
+    enum {
+        kSPI_ClockPhaseFirstEdge,
+        kSPI_ClockPhaseSecondEdge,
+    };
+
+    typedef struct {
+        uint8_t *txData;
+        uint8_t *rxData;
+        size_t dataSize;
+        uint32_t flags;
+    } spi_transfer_t;
+
+    typedef struct spi_master_handle spi_master_handle_t;
+    typedef void (*spi_master_callback_t)(SPI_Type *base, spi_master_handle_t *handle, status_t status, void *userData);
+
+    struct spi_master_handle {
+        int unused;
+    };
+
+    typedef struct {
+        int polarity;
+        int phase;
+        uint32_t baudRate_Bps;
+    } spi_master_config_t;
+
+// Functions:
+
+    void SPI_MasterGetDefaultConfig(spi_master_config_t *config);
+    void SPI_MasterInit(SPI_Type *base, spi_master_config_t *config, uint32_t srcClock_Hz);
+    void SPI_MasterTransferCreateHandle(SPI_Type *base, spi_master_handle_t *handle, spi_master_callback_t callback, void *userData);
+    status_t SPI_MasterTransferNonBlocking(SPI_Type *base, spi_master_handle_t *handle, spi_transfer_t *xfer);
+
+#endif
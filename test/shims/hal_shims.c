@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_shims.h"
+#include "timer.h"
+#include "key_matrix.h"
+#include "right_key_matrix.h"
+#include "module.h"
+#include "slave_scheduler.h"
+#include "slave_drivers/uhk_module_driver.h"
+#include "slave_drivers/touchpad_driver.h"
+#include "slave_drivers/is31fl3xxx_driver.h"
+#include "usb_composite_device.h"
+#include "usb_device_hid.h"
+#include "usb_report_updater.h"
+#include "usb_interfaces/usb_interface_basic_keyboard.h"
+#include "usb_interfaces/usb_interface_media_keyboard.h"
+#include "usb_interfaces/usb_interface_system_keyboard.h"
+#include "usb_interfaces/usb_interface_mouse.h"
+#include "usb_interfaces/usb_interface_nkro_keyboard.h"
+#include "usb_interfaces/usb_interface_generic_hid.h"
+#include "usb_protocol_handler.h"
+#include "peripherals/reset_button.h"
+#include "buffer.h"
+
+// Host stand-ins for the peripherals, slave drivers and the USB stack which the report
+// pipeline talks to. Time only moves when a test advances it, and every report handed
+// to the USB stack is recorded until the test completes the pending transfers.
+
+hal_shims_report_t HalShims_SentReports[HAL_SHIMS_MAX_SENT_REPORTS];
+uint32_t HalShims_SentReportCount;
+
+static uint32_t currentTimeMicros;
+static class_handle_t pendingSends[USB_DEVICE_CONFIG_HID];
+static uint8_t pendingSendCount;
+
+// Timer
+
+volatile uint32_t CurrentTime;
+
+uint32_t Timer_GetCurrentTimeMicros()
+{
+    return currentTimeMicros;
+}
+
+uint32_t Timer_GetElapsedTime(uint32_t *time)
+{
+    return CurrentTime - *time;
+}
+
+uint32_t Timer_GetElapsedTimeMicros(uint32_t *time)
+{
+    return Timer_GetCurrentTimeMicros() - *time;
+}
+
+uint32_t Timer_GetElapsedTimeAndSetCurrent(uint32_t *time)
+{
+    uint32_t elapsedTime = Timer_GetElapsedTime(time);
+    *time = CurrentTime;
+    return elapsedTime;
+}
+
+// Key matrix and slaves
+
+uint8_t DebounceTimePress = 5;
+uint8_t DebounceTimeRelease = 5;
+key_matrix_t RightKeyMatrix;
+
+uhk_slave_t Slaves[SLAVE_COUNT];
+uint8_t I2cSlaveScheduler_KeySlaveWeight = 1;
+uhk_module_state_t UhkModuleStates[UHK_MODULE_MAX_SLOT_COUNT];
+touchpad_events_t TouchpadEvents;
+
+uint8_t KeyBacklightBrightness = 0xff;
+uint8_t LedDriverValues[LED_DRIVER_MAX_COUNT][LED_DRIVER_LED_COUNT_MAX];
+
+void LedSlaveDriver_UpdateLeds(void)
+{
+}
+
+// USB
+
+static usb_device_hid_struct_t hidDevices[USB_DEVICE_CONFIG_HID];
+
+volatile bool SleepModeActive;
+usb_composite_device_t UsbCompositeDevice;
+
+// Class handles are 32 bit wide like on the MCU, which is why the tests are linked with -no-pie.
+static class_handle_t hidHandle(uint8_t interfaceIndex)
+{
+    uintptr_t address = (uintptr_t)&hidDevices[interfaceIndex];
+    if (address > UINT32_MAX) {
+        fprintf(stderr, "HID device struct is not addressable by a class handle\n");
+        abort();
+    }
+    return (class_handle_t)address;
+}
+
+void WakeUpHost(void)
+{
+}
+
+usb_status_t USB_DeviceHidSend(class_handle_t handle, uint8_t ep, uint8_t *buffer, uint32_t length)
+{
+    if (HalShims_SentReportCount < HAL_SHIMS_MAX_SENT_REPORTS) {
+        hal_shims_report_t *report = &HalShims_SentReports[HalShims_SentReportCount++];
+        report->time = currentTimeMicros;
+        report->endpoint = ep;
+        report->length = MIN(length, HAL_SHIMS_MAX_REPORT_LENGTH);
+        memcpy(report->data, buffer, report->length);
+    }
+    pendingSends[pendingSendCount++] = handle;
+    return kStatus_USB_Success;
+}
+
+// USB commands answer into the generic HID buffer, which the tests read directly.
+
+uint8_t GenericHidInBuffer[USB_GENERIC_HID_IN_BUFFER_LENGTH];
+bool IsFactoryResetModeEnabled;
+
+void SetUsbTxBufferUint8(uint32_t offset, uint8_t value)
+{
+    SetBufferUint8(GenericHidInBuffer, offset, value);
+}
+
+void SetUsbTxBufferUint16(uint32_t offset, uint16_t value)
+{
+    SetBufferUint16(GenericHidInBuffer, offset, value);
+}
+
+void SetUsbTxBufferUint32(uint32_t offset, uint32_t value)
+{
+    SetBufferUint32(GenericHidInBuffer, offset, value);
+}
+
+void HalShims_Reset(void)
+{
+    UsbCompositeDevice.basicKeyboardHandle = hidHandle(USB_BASIC_KEYBOARD_INTERFACE_INDEX);
+    UsbCompositeDevice.mediaKeyboardHandle = hidHandle(USB_MEDIA_KEYBOARD_INTERFACE_INDEX);
+    UsbCompositeDevice.systemKeyboardHandle = hidHandle(USB_SYSTEM_KEYBOARD_INTERFACE_INDEX);
+    UsbCompositeDevice.mouseHandle = hidHandle(USB_MOUSE_INTERFACE_INDEX);
+    UsbCompositeDevice.nkroKeyboardHandle = hidHandle(USB_NKRO_KEYBOARD_INTERFACE_INDEX);
+    UsbCompositeDevice.attach = 1;
+    memset(hidDevices, 0, sizeof(hidDevices));
+    HalShims_SentReportCount = 0;
+    pendingSendCount = 0;
+    UsbReportUpdateSemaphore = 0;
+}
+
+void HalShims_AdvanceTime(uint32_t micros)
+{
+    currentTimeMicros += micros;
+    CurrentTime = currentTimeMicros / 1000;
+}
+
+void HalShims_CompleteSends(void)
+{
+    for (uint8_t i = 0; i < pendingSendCount; i++) {
+        class_handle_t handle = pendingSends[i];
+        if (handle == UsbCompositeDevice.basicKeyboardHandle) {
+            UsbBasicKeyboardCallback(handle, kUSB_DeviceHidEventSendResponse, NULL);
+        } else if (handle == UsbCompositeDevice.mediaKeyboardHandle) {
+            UsbMediaKeyboardCallback(handle, kUSB_DeviceHidEventSendResponse, NULL);
+        } else if (handle == UsbCompositeDevice.systemKeyboardHandle) {
+            UsbSystemKeyboardCallback(handle, kUSB_DeviceHidEventSendResponse, NULL);
+        } else if (handle == UsbCompositeDevice.mouseHandle) {
+            UsbMouseCallback(handle, kUSB_DeviceHidEventSendResponse, NULL);
+        } else if (handle == UsbCompositeDevice.nkroKeyboardHandle) {
+            UsbNkroKeyboardCallback(handle, kUSB_DeviceHidEventSendResponse, NULL);
+        }
+    }
+    pendingSendCount = 0;
+}
+
+// Stands in for the host fetching the report descriptor of the NKRO interface, which makes the
+// basic keyboard reports go through it.
+void HalShims_UseNkroKeyboard(bool useNkro)
+{
+    UsbNkroKeyboardUsedByHost = useNkro;
+}
@@ -0,0 +1,35 @@
+#ifndef __HAL_SHIMS_H__
+#define __HAL_SHIMS_H__
+
+// Includes:
+
+    #include "fsl_common.h"
+    #include "usb.h"
+
+// Macros:
+
+    #define HAL_SHIMS_MAX_SENT_REPORTS 1024
+    #define HAL_SHIMS_MAX_REPORT_LENGTH 64
+
+// Typedefs:
+
+    typedef struct {
+        uint32_t time; // us
+        uint8_t endpoint;
+        uint8_t length;
+        uint8_t data[HAL_SHIMS_MAX_REPORT_LENGTH];
+    } hal_shims_report_t;
+
+// Variables:
+
+    extern hal_shims_report_t HalShims_SentReports[HAL_SHIMS_MAX_SENT_REPORTS];
+    extern uint32_t HalShims_SentReportCount;
+
+// Functions:
+
+    void HalShims_Reset(void);
+    void HalShims_AdvanceTime(uint32_t micros);
+    void HalShims_CompleteSends(void);
+    void HalShims_UseNkroKeyboard(bool useNkro);
+
+#endif
@@ -0,0 +1,10 @@
+#include "fsl_common.h"
+
+// The peripheral instances which PORTA, GPIOA and the like of fsl_common.h point to.
+
+uint32_t SystemCoreClock = 48000000U;
+
+PORT_Type HalShims_Ports[5];
+GPIO_Type HalShims_Gpios[5];
+I2C_Type HalShims_I2cs[2];
+SPI_Type HalShims_Spis[2];
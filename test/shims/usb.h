@@ -0,0 +1,36 @@
+#ifndef __USB_H__
+#define __USB_H__
+
+// Includes:
+
+    #include "fsl_common.h"
+
+// Macros:
+
+    #define USB_SHORT_GET_LOW(x) ((x) & 0xFF)
+    #define USB_SHORT_GET_HIGH(x) (((x) >> 8) & 0xFF)
+
+// Typedefs:
+
+    typedef int usb_status_t;
+
+    enum {
+        kStatus_USB_Success = 0,
+        kStatus_USB_Error,
+        kStatus_USB_Busy,
+        kStatus_USB_InvalidHandle,
+        kStatus_USB_InvalidParameter,
+        kStatus_USB_InvalidRequest,
+        kStatus_USB_ControllerNotFound,
+        kStatus_USB_InvalidControllerInterface,
+        kStatus_USB_NotSupported,
+        kStatus_USB_Retry,
+        kStatus_USB_TransferStall,
+        kStatus_USB_TransferFailed,
+        kStatus_USB_AllocFail,
+    };
+
+    typedef void *usb_device_handle;
+    typedef void *class_handle_t;
+
+#endif
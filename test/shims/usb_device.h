@@ -0,0 +1,47 @@
+#ifndef __USB_DEVICE_H__
+#define __USB_DEVICE_H__
+
+// Includes:
+
+    #include "usb.h"
+
+// Macros:
+
+    #define USB_SETUP_PACKET_SIZE 8
+
+    #define USB_DESCRIPTOR_LENGTH_DEVICE 18
+    #define USB_DESCRIPTOR_LENGTH_CONFIGURE 9
+    #define USB_DESCRIPTOR_LENGTH_INTERFACE 9
+    #define USB_DESCRIPTOR_LENGTH_ENDPOINT 7
+
+    #define USB_DESCRIPTOR_TYPE_DEVICE 1
+    #define USB_DESCRIPTOR_TYPE_CONFIGURE 2
+    #define USB_DESCRIPTOR_TYPE_STRING 3
+    #define USB_DESCRIPTOR_TYPE_INTERFACE 4
+    #define USB_DESCRIPTOR_TYPE_ENDPOINT 5
+
+    #define USB_ENDPOINT_INTERRUPT 3
+    #define USB_OUT 0
+    #define USB_IN 1
+
+// Typedefs:
+
+    typedef void *usb_device_controller_handle;
+
+    typedef usb_status_t (*usb_device_callback_t)(usb_device_handle handle, uint32_t callbackEvent, void *eventParam);
+
+    typedef struct {
+        uint8_t *buffer;
+        uint32_t length;
+        uint8_t isSetup;
+    } usb_device_endpoint_callback_message_struct_t;
+
+    typedef struct {
+        uint8_t bmRequestType;
+        uint8_t bRequest;
+        uint16_t wValue;
+        uint16_t wIndex;
+        uint16_t wLength;
+    } usb_setup_struct_t;
+
+#endif
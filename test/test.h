@@ -0,0 +1,45 @@
+#ifndef __TEST_H__
+#define __TEST_H__
+
+// Includes:
+
+    #include <stdio.h>
+    #include <stdlib.h>
+
+// Macros:
+
+    #define CHECK(condition) \
+        do { \
+            if (!(condition)) { \
+                fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+                TestFailures++; \
+            } \
+        } while (0)
+
+    #define CHECK_EQUAL(actual, expected) \
+        do { \
+            long long actualValue = (actual), expectedValue = (expected); \
+            if (actualValue != expectedValue) { \
+                fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actualValue, expectedValue); \
+                TestFailures++; \
+            } \
+        } while (0)
+
+    #define RUN_TEST(test) \
+        do { \
+            test(); \
+            TestCount++; \
+        } while (0)
+
+    #define TEST_EXIT() \
+        do { \
+            printf("%d tests, %d failed checks\n", TestCount, TestFailures); \
+            return TestFailures ? EXIT_FAILURE : EXIT_SUCCESS; \
+        } while (0)
+
+// Variables:
+
+    static int TestCount;
+    static int TestFailures;
+
+#endif
@@ -0,0 +1,218 @@
+#include "test.h"
+#include "hal_shims.h"
+#include "combos.h"
+#include "key_action.h"
+#include "key_states.h"
+#include "keymap.h"
+#include "layer.h"
+#include "right_key_matrix.h"
+#include "usb_report_updater.h"
+#include "usb_interfaces/usb_interface_basic_keyboard.h"
+
+// Presses keys of the right half through the report updater with combos defined, and measures the
+// latency of every press: the time from the press until its scancode, or the combo's, first shows up
+// in a sent report. Keys 0-2 are members of the combos, key 3 is not a member of any. Latencies are
+// checked against the one of a lone key 3, which passes the report updater without combos.
+//
+// Member presses are held back in the postponer, which replays its queue in the update after the one
+// that commits a plain key, and then one event every two updates. That is the whole cost of a combo
+// which completes: REPLAY_CYCLES on top of a plain key.
+
+#define KEY_COUNT 4
+#define PAIR_OUTPUT 8
+#define TRIPLE_OUTPUT 9
+#define COMBO_TIMEOUT 50
+#define REPLAY_CYCLES 1
+
+static uint32_t now;
+static uint32_t plainLatency;
+
+static void mapKey(uint8_t keyId, uint8_t scancode)
+{
+    key_action_t *action = &CurrentKeymap[LayerId_Base][SlotId_RightKeyboardHalf][keyId];
+    action->type = KeyActionType_Keystroke;
+    action->keystroke.keystrokeType = KeystrokeType_Basic;
+    action->keystroke.scancode = scancode;
+}
+
+static key_state_t* key(uint8_t keyId)
+{
+    return &KeyStates[SlotId_RightKeyboardHalf][keyId];
+}
+
+static void runFor(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        HalShims_AdvanceTime(1000);
+        HalShims_CompleteSends();
+        UpdateUsbReports();
+        now++;
+    }
+}
+
+static void setKey(uint8_t keyId, bool pressed)
+{
+    if (pressed) {
+        RightKeyMatrix.keyStates |= 1ULL << keyId;
+    } else {
+        RightKeyMatrix.keyStates &= ~(1ULL << keyId);
+    }
+}
+
+static bool reportContains(const hal_shims_report_t *report, uint8_t scancode)
+{
+    const usb_boot_keyboard_report_t *bootReport = (const usb_boot_keyboard_report_t*)report->data;
+    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
+        if (bootReport->scancodes[i] == scancode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the ms from the given time until the first report which carries the scancode, UINT32_MAX if none does.
+static uint32_t latency(uint32_t pressTime, uint8_t scancode)
+{
+    for (uint32_t r = 0; r < HalShims_SentReportCount; r++) {
+        uint32_t reportTime = HalShims_SentReports[r].time / 1000;
+        if (reportTime >= pressTime && reportContains(&HalShims_SentReports[r], scancode)) {
+            return reportTime - pressTime;
+        }
+    }
+    return UINT32_MAX;
+}
+
+static bool wasSent(uint8_t scancode)
+{
+    return latency(0, scancode) != UINT32_MAX;
+}
+
+static void releaseAll(void)
+{
+    RightKeyMatrix.keyStates = 0;
+    runFor(200);
+    HalShims_Reset();
+}
+
+// Presses the given keys one after another, pressDelay ms apart, and holds them for 100 ms more.
+static uint32_t pressTogether(const uint8_t *keyIds, uint8_t count, uint32_t pressDelay)
+{
+    uint32_t lastPressTime = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        setKey(keyIds[i], true);
+        lastPressTime = now;
+        runFor(pressDelay);
+    }
+    runFor(100);
+    return lastPressTime;
+}
+
+static void testPlainKeyLatency(void)
+{
+    const uint8_t keys[] = {3};
+    uint32_t pressTime = pressTogether(keys, 1, 0);
+    plainLatency = latency(pressTime, HID_KEYBOARD_SC_D);
+
+    fprintf(stderr, "plain key: %u ms\n", plainLatency);
+    CHECK(plainLatency <= 2);
+    releaseAll();
+}
+
+static void testPairFiresWithLastPress(void)
+{
+    const uint8_t keys[] = {0, 1};
+    uint32_t pressTime = pressTogether(keys, 2, 10);
+    uint32_t pairLatency = latency(pressTime, HID_KEYBOARD_SC_I);
+
+    fprintf(stderr, "pair combo: %u ms after its last press\n", pairLatency);
+    CHECK(pairLatency <= plainLatency + REPLAY_CYCLES);
+    CHECK(!wasSent(HID_KEYBOARD_SC_A));
+    CHECK(!wasSent(HID_KEYBOARD_SC_B));
+    releaseAll();
+}
+
+// Keys 0 and 1 are a prefix of the triple, so the pair waits for the timeout or the third key.
+static void testTripleFiresWithLastPress(void)
+{
+    Combos_Define(key(TRIPLE_OUTPUT), COMBO_TIMEOUT, (key_state_t*[]){key(0), key(1), key(2)}, 3);
+
+    const uint8_t keys[] = {0, 1, 2};
+    uint32_t pressTime = pressTogether(keys, 3, 10);
+    uint32_t tripleLatency = latency(pressTime, HID_KEYBOARD_SC_J);
+
+    fprintf(stderr, "triple combo: %u ms after its last press\n", tripleLatency);
+    CHECK(tripleLatency <= plainLatency + REPLAY_CYCLES);
+    CHECK(!wasSent(HID_KEYBOARD_SC_I));
+    releaseAll();
+
+    const uint8_t pair[] = {0, 1};
+    uint32_t pairPressTime = pressTogether(pair, 2, 10);
+    uint32_t pairLatency = latency(pairPressTime, HID_KEYBOARD_SC_I);
+
+    fprintf(stderr, "pair combo which prefixes a triple: %u ms after its last press\n", pairLatency);
+    CHECK(pairLatency <= COMBO_TIMEOUT + plainLatency + REPLAY_CYCLES);
+    releaseAll();
+
+    Combos_Remove(key(TRIPLE_OUTPUT));
+}
+
+// A lone member is held back until no combo can match anymore, i.e. for the timeout.
+static void testLoneMemberWaitsForTimeout(void)
+{
+    const uint8_t keys[] = {0};
+    uint32_t pressTime = pressTogether(keys, 1, 0);
+    uint32_t memberLatency = latency(pressTime, HID_KEYBOARD_SC_A);
+
+    fprintf(stderr, "lone member: %u ms\n", memberLatency);
+    CHECK(COMBO_TIMEOUT <= memberLatency && memberLatency <= COMBO_TIMEOUT + plainLatency + REPLAY_CYCLES);
+    releaseAll();
+}
+
+// A key which is not a member of any combo ends the match at once: the member is replayed right away
+// and the key two updates after it, rather than after the timeout.
+static void testOtherKeysAreNotDelayed(void)
+{
+    const uint8_t keys[] = {0, 3};
+    uint32_t memberPressTime = now;
+    uint32_t otherPressTime = pressTogether(keys, 2, 10);
+    uint32_t otherLatency = latency(otherPressTime, HID_KEYBOARD_SC_D);
+    uint32_t memberLatency = latency(memberPressTime, HID_KEYBOARD_SC_A);
+
+    fprintf(stderr, "other key: %u ms, member before it: %u ms\n", otherLatency, memberLatency);
+    CHECK(otherLatency <= plainLatency + REPLAY_CYCLES + 2);
+    CHECK(memberLatency <= 10 + plainLatency + REPLAY_CYCLES);
+    releaseAll();
+}
+
+static void testOutputIsReleasedWithFirstMember(void)
+{
+    const uint8_t keys[] = {0, 1};
+    pressTogether(keys, 2, 10);
+    setKey(1, false);
+    runFor(10);
+
+    hal_shims_report_t *report = &HalShims_SentReports[HalShims_SentReportCount - 1];
+    CHECK(!reportContains(report, HID_KEYBOARD_SC_I));
+    CHECK(!reportContains(report, HID_KEYBOARD_SC_A));
+    releaseAll();
+}
+
+int main(void)
+{
+    HalShims_Reset();
+    for (uint8_t keyId = 0; keyId < KEY_COUNT; keyId++) {
+        mapKey(keyId, HID_KEYBOARD_SC_A + keyId);
+    }
+    mapKey(PAIR_OUTPUT, HID_KEYBOARD_SC_I);
+    mapKey(TRIPLE_OUTPUT, HID_KEYBOARD_SC_J);
+    Combos_Define(key(PAIR_OUTPUT), COMBO_TIMEOUT, (key_state_t*[]){key(0), key(1)}, 2);
+
+    RUN_TEST(testPlainKeyLatency);
+    RUN_TEST(testPairFiresWithLastPress);
+    RUN_TEST(testTripleFiresWithLastPress);
+    RUN_TEST(testLoneMemberWaitsForTimeout);
+    RUN_TEST(testOtherKeysAreNotDelayed);
+    RUN_TEST(testOutputIsReleasedWithFirstMember);
+
+    TEST_EXIT();
+}
@@ -0,0 +1,115 @@
+#include "test.h"
+#include "crc16.h"
+
+// Checks a software implementation of shared/crc16.c against a reference CRC-CCITT over messages
+// of every payload length, and over random messages which are fed to crc16_update in two parts
+// split at a random point. The Makefile links this test once per software CRC16_IMPLEMENTATION.
+// The hardware one needs the CRC peripheral of the MK22, so it is not covered on the host.
+
+#define MESSAGE_COUNT 20000
+
+static uint32_t randomState = 88172645;
+
+static uint32_t nextRandom(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static uint16_t referenceCrc(const uint8_t *data, uint32_t length)
+{
+    uint16_t crc = 0;
+
+    for (uint32_t j = 0; j < length; j++) {
+        crc ^= data[j] << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t crc(const uint8_t *data, uint32_t length, uint32_t split)
+{
+    crc16_data_t crc16Data;
+    uint16_t hash;
+
+    crc16_init(&crc16Data);
+    crc16_update(&crc16Data, data, split);
+    crc16_update(&crc16Data, data + split, length - split);
+    crc16_finalize(&crc16Data, &hash);
+    return hash;
+}
+
+static void testCheckValue(void)
+{
+    const char *check = "123456789";
+
+    CHECK_EQUAL(crc((const uint8_t*)check, strlen(check), 0), 0x31c3);
+    CHECK_EQUAL(crc(NULL, 0, 0), 0);
+}
+
+static void testRandomMessagesMatchReference(void)
+{
+    uint8_t data[I2C_MESSAGE_MAX_PAYLOAD_LENGTH];
+
+    for (uint32_t m = 0; m < MESSAGE_COUNT; m++) {
+        uint32_t length = 1 + nextRandom() % sizeof(data);
+        for (uint32_t i = 0; i < length; i++) {
+            data[i] = nextRandom();
+        }
+        uint32_t split = nextRandom() % (length + 1);
+        if (crc(data, length, split) != referenceCrc(data, length)) {
+            fprintf(stderr, "message %u of %u bytes split at %u\n", m, length, split);
+            TestFailures++;
+            break;
+        }
+    }
+}
+
+// Every payload length of an i2c message, each split at every point, and checksummed as a message.
+static void testEveryLengthMatchesReference(void)
+{
+    i2c_message_t message;
+
+    for (uint32_t length = 1; length <= I2C_MESSAGE_MAX_PAYLOAD_LENGTH; length++) {
+        for (uint32_t i = 0; i < length; i++) {
+            message.data[i] = nextRandom();
+        }
+        uint16_t reference = referenceCrc(message.data, length);
+        for (uint32_t split = 0; split <= length; split++) {
+            if (crc(message.data, length, split) != reference) {
+                fprintf(stderr, "%u bytes split at %u\n", length, split);
+                TestFailures++;
+                return;
+            }
+        }
+        message.length = length;
+        CRC16_UpdateMessageChecksum(&message);
+        CHECK_EQUAL(message.crc, reference);
+        CHECK(CRC16_IsMessageValid(&message));
+    }
+}
+
+static void testMessageChecksum(void)
+{
+    i2c_message_t message = { .length = 4, .data = { 0x01, 0x02, 0x03, 0x04 } };
+
+    CRC16_UpdateMessageChecksum(&message);
+    CHECK_EQUAL(message.crc, referenceCrc(message.data, message.length));
+    CHECK(CRC16_IsMessageValid(&message));
+    message.data[2] ^= 0x10;
+    CHECK(!CRC16_IsMessageValid(&message));
+}
+
+int main(void)
+{
+    RUN_TEST(testCheckValue);
+    RUN_TEST(testEveryLengthMatchesReference);
+    RUN_TEST(testRandomMessagesMatchReference);
+    RUN_TEST(testMessageChecksum);
+
+    TEST_EXIT();
+}
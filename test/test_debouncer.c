@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include "test.h"
+#include "hal_shims.h"
+#include "key_states.h"
+#include "right_key_matrix.h"
+#include "key_matrix.h"
+#include "timer.h"
+#include "usb_report_updater.h"
+
+// Feeds bouncing switches of the right half through the report updater and checks its word at
+// a time debouncer against the per key debouncer which it replaced, cycle by cycle. The keys
+// are unmapped, so that every key state is committed as debounced, without postponing.
+
+#define KEY_COUNT 20
+#define CYCLE_COUNT 20000
+
+typedef struct {
+    uint64_t debounced;
+    uint64_t debouncing;
+    uint8_t timestamps[KEY_COUNT];
+} reference_debouncer_t;
+
+static reference_debouncer_t reference;
+
+// The former preprocessKeyState, one key at a time. `previous` of a key is its debounced state
+// of the previous cycle, since the key is committed without postponing.
+static void referenceDebounce(uint8_t keyId, bool hardware)
+{
+    uint64_t mask = 1ULL << keyId;
+    uint8_t *timestamp = &reference.timestamps[keyId];
+    bool previous = reference.debounced & mask;
+
+    if (EagerKeyPresses) {
+        if (!(reference.debounced & mask)) {
+            reference.debouncing &= ~mask;
+            if (hardware) {
+                reference.debounced |= mask;
+            }
+        } else if (hardware) {
+            reference.debouncing &= ~mask;
+        } else if (!(reference.debouncing & mask)) {
+            *timestamp = CurrentTime;
+            reference.debouncing |= mask;
+        } else if ((uint8_t)(CurrentTime - *timestamp) > DebounceTimeRelease) {
+            reference.debouncing &= ~mask;
+            reference.debounced &= ~mask;
+        }
+        return;
+    }
+
+    if (reference.debouncing & mask) {
+        uint8_t debounceTime = previous ? DebounceTimePress : DebounceTimeRelease;
+        if ((uint8_t)(CurrentTime - *timestamp) > debounceTime) {
+            reference.debouncing &= ~mask;
+        }
+    }
+    if (hardware != previous && !(reference.debouncing & mask)) {
+        *timestamp = CurrentTime;
+        reference.debouncing |= mask;
+        reference.debounced ^= mask;
+    }
+}
+
+// Every key bounces with its own probability: some settle in a few cycles, others chatter.
+static uint64_t bounce(uint64_t hardware)
+{
+    for (uint8_t keyId = 0; keyId < KEY_COUNT; keyId++) {
+        if (rand() % (4 + keyId * 8) == 0) {
+            hardware ^= 1ULL << keyId;
+        }
+    }
+    return hardware;
+}
+
+static void checkAgainstReference(void)
+{
+    uint64_t hardware = 0;
+    uint32_t flips = 0;
+
+    memset(&reference, 0, sizeof(reference));
+    srand(1);
+    for (uint32_t cycle = 0; cycle < CYCLE_COUNT; cycle++) {
+        hardware = bounce(hardware);
+        RightKeyMatrix.keyStates = hardware;
+
+        HalShims_AdvanceTime(1000);
+        HalShims_CompleteSends();
+        uint64_t debounced = reference.debounced;
+        for (uint8_t keyId = 0; keyId < KEY_COUNT; keyId++) {
+            referenceDebounce(keyId, (hardware >> keyId) & 1);
+        }
+        flips += __builtin_popcountll(debounced ^ reference.debounced);
+        UpdateUsbReports();
+
+        key_state_bits_t *bits = &KeyStateBits[SlotId_RightKeyboardHalf];
+        if (bits->debounced != reference.debounced || bits->debouncing != reference.debouncing) {
+            fprintf(stderr, "cycle %u: debounced %llx/%llx, debouncing %llx/%llx\n", cycle,
+                (unsigned long long)bits->debounced, (unsigned long long)reference.debounced,
+                (unsigned long long)bits->debouncing, (unsigned long long)reference.debouncing);
+            TestFailures++;
+            break;
+        }
+        for (uint8_t keyId = 0; keyId < KEY_COUNT; keyId++) {
+            CHECK_EQUAL(KeyStates[SlotId_RightKeyboardHalf][keyId].current, (reference.debounced >> keyId) & 1);
+        }
+    }
+    CHECK(flips > 100);
+
+    RightKeyMatrix.keyStates = 0;
+    for (uint8_t i = 0; i < 100; i++) {
+        HalShims_AdvanceTime(1000);
+        HalShims_CompleteSends();
+        UpdateUsbReports();
+    }
+}
+
+static void testDefaultDebounceTimes(void)
+{
+    checkAgainstReference();
+}
+
+static void testAsymmetricDebounceTimes(void)
+{
+    DebounceTimePress = 2;
+    DebounceTimeRelease = 13;
+    checkAgainstReference();
+}
+
+static void testEagerKeyPresses(void)
+{
+    EagerKeyPresses = true;
+    checkAgainstReference();
+    EagerKeyPresses = false;
+}
+
+int main(void)
+{
+    HalShims_Reset();
+
+    RUN_TEST(testDefaultDebounceTimes);
+    RUN_TEST(testAsymmetricDebounceTimes);
+    RUN_TEST(testEagerKeyPresses);
+
+    TEST_EXIT();
+}
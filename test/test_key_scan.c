@@ -0,0 +1,146 @@
+#include "test.h"
+#include "key_matrix.h"
+#include "key_vector.h"
+#include "bool_array_converter.h"
+
+// Scans random key states through the GPIO registers with the matrix and vector scanners of
+// shared/, and checks their bitmaps against the key states, and the bytes which a module sends
+// of them against the bool array to bit array conversion that the wire format was defined by.
+
+#define SCAN_COUNT 100000
+#define MATRIX_ROW_COUNT 5
+#define MATRIX_COL_COUNT 7
+#define MATRIX_KEY_COUNT (MATRIX_ROW_COUNT * MATRIX_COL_COUNT)
+#define MATRIX_COL_FIRST_PIN 2
+#define VECTOR_KEY_COUNT 20
+
+static GPIO_Type rowGpio, colGpio, vectorGpios[2];
+static key_matrix_pin_t rows[MATRIX_ROW_COUNT], cols[MATRIX_COL_COUNT];
+static key_matrix_t keyMatrix = {
+    .colNum = MATRIX_COL_COUNT,
+    .rowNum = MATRIX_ROW_COUNT,
+    .cols = cols,
+    .rows = rows,
+};
+static key_vector_pin_t vectorItems[VECTOR_KEY_COUNT];
+static key_vector_t keyVector = {
+    .itemNum = VECTOR_KEY_COUNT,
+    .items = vectorItems,
+};
+
+static uint32_t randomState = 1234567;
+
+static uint32_t nextRandom(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+// The conversion which modules used to build the key states of their messages with.
+static void boolBytesToBits(const uint8_t *srcBytes, uint8_t *dstBits, uint8_t byteCount)
+{
+    memset(dstBits, 0, BOOL_BYTES_TO_BITS_COUNT(byteCount));
+    for (uint8_t i = 0; i < byteCount; i++) {
+        dstBits[i/8] |= !!srcBytes[i] << (i%8);
+    }
+}
+
+static void checkWireBytes(uint64_t keyStates, const uint8_t *pressed, uint8_t keyCount)
+{
+    uint8_t expected[8], sent[8];
+
+    boolBytesToBits(pressed, expected, keyCount);
+    memcpy(sent, &keyStates, BOOL_BYTES_TO_BITS_COUNT(keyCount));
+    CHECK(memcmp(sent, expected, BOOL_BYTES_TO_BITS_COUNT(keyCount)) == 0);
+}
+
+// The columns read the pressed keys of the rows which are driven high.
+static void driveMatrixColumns(const uint8_t *pressed)
+{
+    colGpio.PDIR = 0;
+    for (uint8_t row = 0; row < MATRIX_ROW_COUNT; row++) {
+        if (!(rowGpio.PDOR & 1U << rows[row].pin)) {
+            continue;
+        }
+        for (uint8_t col = 0; col < MATRIX_COL_COUNT; col++) {
+            colGpio.PDIR |= (uint32_t)pressed[row * MATRIX_COL_COUNT + col] << cols[col].pin;
+        }
+    }
+}
+
+static void scanMatrix(const uint8_t *pressed)
+{
+    for (uint8_t row = 0; row < MATRIX_ROW_COUNT; row++) {
+        driveMatrixColumns(pressed);
+        KeyMatrix_ScanRow(&keyMatrix);
+        CHECK_EQUAL(rowGpio.PDOR, 1U << rows[keyMatrix.currentRowNum].pin);
+    }
+}
+
+static void testMatrixScan(void)
+{
+    uint8_t pressed[MATRIX_KEY_COUNT] = {0};
+
+    KeyMatrix_Init(&keyMatrix);
+    scanMatrix(pressed);
+
+    for (uint32_t s = 0; s < SCAN_COUNT; s++) {
+        uint64_t expected = 0;
+        for (uint8_t key = 0; key < MATRIX_KEY_COUNT; key++) {
+            pressed[key] = nextRandom() % 4 == 0;
+            expected |= (uint64_t)pressed[key] << key;
+        }
+        scanMatrix(pressed);
+        if (keyMatrix.keyStates != expected) {
+            fprintf(stderr, "scan %u: %016llx instead of %016llx\n", s,
+                (unsigned long long)keyMatrix.keyStates, (unsigned long long)expected);
+            TestFailures++;
+            break;
+        }
+        checkWireBytes(keyMatrix.keyStates, pressed, MATRIX_KEY_COUNT);
+    }
+}
+
+static void testVectorScan(void)
+{
+    uint8_t pressed[VECTOR_KEY_COUNT];
+
+    KeyVector_Init(&keyVector);
+    for (uint32_t s = 0; s < SCAN_COUNT; s++) {
+        uint32_t expected = 0;
+        vectorGpios[0].PDIR = vectorGpios[1].PDIR = 0xffffffff;
+        for (uint8_t key = 0; key < VECTOR_KEY_COUNT; key++) {
+            // The keys are pulled up, so a pressed key reads low.
+            pressed[key] = nextRandom() % 4 == 0;
+            vectorItems[key].gpio->PDIR &= ~((uint32_t)pressed[key] << vectorItems[key].pin);
+            expected |= (uint32_t)pressed[key] << key;
+        }
+        KeyVector_Scan(&keyVector);
+        if (keyVector.keyStates != expected) {
+            fprintf(stderr, "scan %u: %08x instead of %08x\n", s, keyVector.keyStates, expected);
+            TestFailures++;
+            break;
+        }
+        checkWireBytes(keyVector.keyStates, pressed, VECTOR_KEY_COUNT);
+    }
+}
+
+int main(void)
+{
+    for (uint8_t row = 0; row < MATRIX_ROW_COUNT; row++) {
+        rows[row] = (key_matrix_pin_t){ .gpio = &rowGpio, .pin = row };
+    }
+    for (uint8_t col = 0; col < MATRIX_COL_COUNT; col++) {
+        cols[col] = (key_matrix_pin_t){ .gpio = &colGpio, .pin = MATRIX_COL_FIRST_PIN + col };
+    }
+    for (uint8_t key = 0; key < VECTOR_KEY_COUNT; key++) {
+        vectorItems[key] = (key_vector_pin_t){ .gpio = &vectorGpios[key % 2], .pin = 31 - key / 2 };
+    }
+
+    RUN_TEST(testMatrixScan);
+    RUN_TEST(testVectorScan);
+
+    TEST_EXIT();
+}
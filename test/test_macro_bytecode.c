@@ -0,0 +1,98 @@
+#define _GNU_SOURCE
+#include "test.h"
+#include "trace.h"
+#include "hal_shims.h"
+#include "macro_bytecode.h"
+#include "str_utils.h"
+#include "eeprom.h"
+#include "config_parser/config_globals.h"
+
+// Compiles command actions and checks the operands which the bytecode resolves ahead of the runtime.
+
+static const char macroText[] =
+    "command 0 start: setReg 0 3\n"
+    "command 0 goTo end\n"
+    "command 0 mid: noOp\n"
+    "command 0 end: repeatFor 0 mid\n"
+    "command 0 ifRegEq 0 1 goTo @-2\n"
+    "command 0 goTo start\n"
+    "command 0 goTo nowhere\n";
+
+static trace_t trace;
+
+// Finds the command in the serialized macro and fetches its instruction.
+static const macro_instruction_t* fetch(const char *command, const char **cmd)
+{
+    const macro_instruction_t *instruction;
+
+    *cmd = memmem(ValidatedUserConfigBuffer.buffer, USER_CONFIG_SIZE, command, strlen(command));
+    if (*cmd == NULL) {
+        return NULL;
+    }
+    MacroBytecode_Fetch(*cmd, *cmd + strlen(command), &instruction);
+    return instruction;
+}
+
+static bool fetchOperand(const char *command, uint8_t operandIdx, int32_t *value)
+{
+    const char *cmd;
+    const macro_instruction_t *instruction = fetch(command, &cmd);
+    const char *cmdEnd = cmd + strlen(command);
+    const char *arg = cmd;
+
+    for (uint8_t i = 0; i <= operandIdx; i++) {
+        arg = NextTok(arg, cmdEnd);
+    }
+    return MacroBytecode_FetchOperand(instruction, arg, value);
+}
+
+static void testLiteralsAreParsed(void)
+{
+    int32_t value = -1;
+
+    CHECK(fetchOperand("setReg 0 3", 1, &value));
+    CHECK_EQUAL(value, 3);
+}
+
+static void testLabelsAreResolved(void)
+{
+    int32_t value = -1;
+
+    CHECK(fetchOperand("goTo end", 0, &value));
+    CHECK_EQUAL(value, 3);
+    CHECK(fetchOperand("repeatFor 0 mid", 1, &value));
+    CHECK_EQUAL(value, 2);
+    CHECK(fetchOperand("goTo start", 0, &value));
+    CHECK_EQUAL(value, 0);
+}
+
+static void testRelativeAddressesAreResolved(void)
+{
+    int32_t value = -1;
+
+    CHECK(fetchOperand("goTo @-2", 0, &value));
+    CHECK_EQUAL(value, 2);
+}
+
+// Unknown labels are left to the runtime, which reports them.
+static void testUnknownLabelsAreLeftUnresolved(void)
+{
+    int32_t value;
+
+    CHECK(!fetchOperand("goTo nowhere", 0, &value));
+}
+
+int main(void)
+{
+    HalShims_Reset();
+    FILE *file = fmemopen((void*)macroText, sizeof(macroText) - 1, "r");
+    CHECK(Trace_Read(file, "bytecode", &trace));
+    fclose(file);
+
+    RUN_TEST(testLiteralsAreParsed);
+    RUN_TEST(testLabelsAreResolved);
+    RUN_TEST(testRelativeAddressesAreResolved);
+    RUN_TEST(testUnknownLabelsAreLeftUnresolved);
+
+    TEST_EXIT();
+}
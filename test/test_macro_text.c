@@ -0,0 +1,157 @@
+#include "test.h"
+#include "trace.h"
+#include "hal_shims.h"
+#include "usb_interfaces/usb_interface_basic_keyboard.h"
+
+// Replays a key which types text by a $write macro, and checks the sequence of boot reports:
+// each report presses at most one key which the previous report did not hold, and the new
+// keys with their modifiers spell out the text.
+
+#define SHIFT_MODIFIERS (HID_KEYBOARD_MODIFIER_LEFTSHIFT | HID_KEYBOARD_MODIFIER_RIGHTSHIFT)
+
+static trace_t trace;
+
+static char scancodeToChar(uint8_t scancode, bool shift)
+{
+    if (HID_KEYBOARD_SC_A <= scancode && scancode <= HID_KEYBOARD_SC_Z) {
+        return (shift ? 'A' : 'a') + scancode - HID_KEYBOARD_SC_A;
+    }
+    if (HID_KEYBOARD_SC_1_AND_EXCLAMATION <= scancode && scancode <= HID_KEYBOARD_SC_9_AND_OPENING_PARENTHESIS) {
+        return shift ? "!@#$%^&*("[scancode - HID_KEYBOARD_SC_1_AND_EXCLAMATION] : '1' + scancode - HID_KEYBOARD_SC_1_AND_EXCLAMATION;
+    }
+    switch (scancode) {
+        case HID_KEYBOARD_SC_SPACE:
+            return ' ';
+        case HID_KEYBOARD_SC_COMMA_AND_LESS_THAN_SIGN:
+            return shift ? '<' : ',';
+    }
+    return '?';
+}
+
+static bool reportContains(const usb_boot_keyboard_report_t *report, uint8_t scancode)
+{
+    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
+        if (report->scancodes[i] == scancode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void replay(const char *traceText)
+{
+    trace_stats_t stats;
+
+    FILE *file = fmemopen((void*)traceText, strlen(traceText), "r");
+    HalShims_Reset();
+    CHECK(Trace_Read(file, "write", &trace));
+    fclose(file);
+    Trace_Replay(&trace, &stats);
+}
+
+static void replayWrite(const char *text)
+{
+    char traceText[256];
+
+    snprintf(traceText, sizeof(traceText), "macro 0 $write %s\n10 press 0\n20 release 0\n", text);
+    replay(traceText);
+}
+
+static void checkTyped(const char *text)
+{
+    char typed[128] = {0};
+    uint8_t typedLength = 0;
+    usb_boot_keyboard_report_t previous = {0};
+
+    for (uint32_t r = 0; r < HalShims_SentReportCount; r++) {
+        CHECK_EQUAL(HalShims_SentReports[r].endpoint, USB_BASIC_KEYBOARD_ENDPOINT_INDEX);
+        const usb_boot_keyboard_report_t *report = (usb_boot_keyboard_report_t*)HalShims_SentReports[r].data;
+        uint8_t newKeyCount = 0;
+        for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
+            uint8_t scancode = report->scancodes[i];
+            if (scancode && !reportContains(&previous, scancode)) {
+                newKeyCount++;
+                if (typedLength < sizeof(typed) - 1) {
+                    typed[typedLength++] = scancodeToChar(scancode, report->modifiers & SHIFT_MODIFIERS);
+                }
+            }
+        }
+        CHECK(newKeyCount <= 1);
+        previous = *report;
+    }
+
+    usb_boot_keyboard_report_t released = {0};
+    CHECK(memcmp(&previous, &released, sizeof(released)) == 0);
+    if (strcmp(typed, text) != 0) {
+        fprintf(stderr, "typed \"%s\" instead of \"%s\"\n", typed, text);
+        TestFailures++;
+    }
+}
+
+static void checkWrite(const char *text)
+{
+    replayWrite(text);
+    checkTyped(text);
+}
+
+static void testWriteTypesText(void)
+{
+    checkWrite("hello world");
+}
+
+// A held key can't be pressed again, so a repeated character is typed after an empty report.
+static void testWriteReleasesRepeatedCharacters(void)
+{
+    checkWrite("aa bb, aaa");
+}
+
+static void testWriteSwitchesModifiers(void)
+{
+    checkWrite("Hello, World! 1A2b");
+}
+
+// With a different key in every report, typing takes a report per character.
+static void testWriteRollsKeys(void)
+{
+    const char *text = "abcdef";
+
+    replayWrite(text);
+    CHECK_EQUAL(HalShims_SentReportCount, strlen(text) + 1);
+}
+
+// A called macro has reports of its own, so typing can't clear the modifier its caller holds.
+static void testCalleeTypesUnderCallersModifier(void)
+{
+    replay(
+        "macro 1 foo\n"
+        "command 0 pressKey LS-\n"
+        "command 0 call key1\n"
+        "command 0 releaseKey LS-\n"
+        "10 press 0\n"
+        "20 release 0\n");
+    checkTyped("FOO");
+}
+
+// Host time stands still within an update, so a polling loop which didn't yield would never end.
+static void testPollingLoopYields(void)
+{
+    replay(
+        "command 0 ifNotReleased goTo @0\n"
+        "command 0 write x\n"
+        "10 press 0\n"
+        "20 release 0\n");
+    checkTyped("x");
+    CHECK(HalShims_SentReportCount > 0 && HalShims_SentReports[0].time >= 20000);
+}
+
+int main(void)
+{
+    RUN_TEST(testWriteTypesText);
+    RUN_TEST(testWriteReleasesRepeatedCharacters);
+    RUN_TEST(testWriteSwitchesModifiers);
+    RUN_TEST(testWriteRollsKeys);
+    RUN_TEST(testCalleeTypesUnderCallersModifier);
+    RUN_TEST(testPollingLoopYields);
+
+    TEST_EXIT();
+}
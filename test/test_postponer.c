@@ -0,0 +1,223 @@
+#include "test.h"
+#include "hal_shims.h"
+#include "key_states.h"
+#include "postponer.h"
+#include "utils.h"
+
+// Drives the postponer queue with random operations and compares its indexed queries
+// with a plain model of the queue, which answers them by walking it.
+
+#define OPERATION_COUNT 200000
+#define TEST_KEY_COUNT 7
+
+typedef struct {
+    key_state_t *key;
+    bool active;
+} model_event_t;
+
+static model_event_t model[POSTPONER_BUFFER_SIZE];
+static uint8_t modelSize;
+
+static key_state_t unindexedKey;
+static key_state_t *keys[TEST_KEY_COUNT];
+static uint32_t randomState = 2463534242;
+
+static uint32_t nextRandom(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static void modelRemove(uint8_t idx)
+{
+    memmove(&model[idx], &model[idx+1], (modelSize - idx - 1) * sizeof(model[0]));
+    modelSize--;
+}
+
+static void modelAppend(key_state_t *key, bool active)
+{
+    if (modelSize == POSTPONER_BUFFER_SIZE) {
+        model[0].key->current = model[0].active;
+        modelRemove(0);
+    }
+    model[modelSize++] = (model_event_t){ .key = key, .active = active };
+}
+
+static void modelConsumeKeypress(void)
+{
+    key_state_t *removedKeypress = NULL;
+    for (uint8_t i = 0; i < modelSize; i++) {
+        if (model[i].active && removedKeypress == NULL) {
+            removedKeypress = model[i].key;
+            modelRemove(i--);
+        } else if (!model[i].active && model[i].key == removedKeypress) {
+            modelRemove(i);
+            break;
+        }
+    }
+}
+
+static bool modelReplaceKeypresses(key_state_t **replacedKeys, uint8_t count, key_state_t *replacement)
+{
+    uint8_t positions[TEST_KEY_COUNT];
+    uint8_t first = 255;
+
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t i = 0;
+        while (i < modelSize && !(model[i].key == replacedKeys[k] && model[i].active)) {
+            i++;
+        }
+        if (i == modelSize) {
+            return false;
+        }
+        positions[k] = i;
+        first = MIN(first, i);
+    }
+    model[first].key = replacement;
+    for (int16_t i = modelSize - 1; i >= 0; i--) {
+        for (uint8_t k = 0; k < count; k++) {
+            if (positions[k] == i && i != first) {
+                modelRemove(i);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+static key_state_t* modelPendingKeypress(uint8_t n)
+{
+    for (uint8_t i = 0; i < modelSize; i++) {
+        if (model[i].active && n-- == 0) {
+            return model[i].key;
+        }
+    }
+    return NULL;
+}
+
+static bool modelIsKeyReleased(key_state_t *key)
+{
+    for (uint8_t i = 0; i < modelSize; i++) {
+        if (model[i].key == key && !model[i].active) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool modelIsActiveEventually(key_state_t *key)
+{
+    for (int16_t i = modelSize - 1; i >= 0; i--) {
+        if (model[i].key == key) {
+            return model[i].active;
+        }
+    }
+    return key->current;
+}
+
+static bool modelContainsKey(key_state_t *key)
+{
+    for (uint8_t i = 0; i < modelSize; i++) {
+        if (model[i].key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool checkQueries(void)
+{
+    uint8_t failures = TestFailures;
+    uint8_t pendingCount = 0;
+
+    for (uint8_t i = 0; i < modelSize; i++) {
+        pendingCount += model[i].active;
+    }
+    CHECK_EQUAL(PostponerQuery_PendingKeypressCount(), pendingCount);
+    for (uint8_t n = 0; n <= pendingCount; n++) {
+        CHECK_EQUAL(PostponerExtended_PendingId(n), Utils_KeyStateToKeyId(modelPendingKeypress(n)));
+        CHECK_EQUAL(PostponerExtended_IsPendingKeyReleased(n), modelIsKeyReleased(modelPendingKeypress(n)));
+    }
+    for (uint8_t k = 0; k < TEST_KEY_COUNT; k++) {
+        CHECK_EQUAL(PostponerQuery_IsKeyReleased(keys[k]), modelIsKeyReleased(keys[k]));
+        CHECK_EQUAL(PostponerQuery_IsActiveEventually(keys[k]), modelIsActiveEventually(keys[k]));
+        if (keys[k] != &unindexedKey) {
+            CHECK_EQUAL(PostponerQuery_ContainsKeyId(Utils_KeyStateToKeyId(keys[k])), modelContainsKey(keys[k]));
+        }
+    }
+    return TestFailures == failures;
+}
+
+static void runOperation(void)
+{
+    uint32_t operation = nextRandom() % 100;
+    key_state_t *key = keys[nextRandom() % TEST_KEY_COUNT];
+
+    if (operation < 60) {
+        bool active = nextRandom() & 1;
+        PostponerCore_TrackKeyEvent(key, active);
+        modelAppend(key, active);
+    } else if (operation < 80) {
+        // Replays the first event. The keys have no actions, so they are never batched.
+        PostponerCore_RunPostponedEvents();
+        PostponerCore_FinishCycle();
+        PostponerCore_FinishCycle();
+        if (modelSize) {
+            model[0].key->current = model[0].active;
+            modelRemove(0);
+        }
+    } else if (operation < 90) {
+        PostponerExtended_ConsumePendingKeypresses(1, false);
+        modelConsumeKeypress();
+    } else if (operation < 99) {
+        key_state_t *replacedKeys[2] = { key, keys[nextRandom() % TEST_KEY_COUNT] };
+        uint8_t count = replacedKeys[0] == replacedKeys[1] ? 1 : 2;
+        key_state_t *replacement = keys[nextRandom() % TEST_KEY_COUNT];
+        CHECK_EQUAL(PostponerExtended_ReplaceKeypresses(replacedKeys, count, replacement), modelReplaceKeypresses(replacedKeys, count, replacement));
+    } else {
+        PostponerExtended_ResetPostponer();
+        modelSize = 0;
+    }
+}
+
+static void testQueriesMatchQueueContents(void)
+{
+    for (uint32_t i = 0; i < OPERATION_COUNT; i++) {
+        HalShims_AdvanceTime(1000);
+        runOperation();
+        if (!checkQueries()) {
+            fprintf(stderr, "after operation %u\n", i);
+            break;
+        }
+    }
+}
+
+static void testFullQueueDropsOldestEvent(void)
+{
+    PostponerExtended_ResetPostponer();
+    modelSize = 0;
+    for (uint8_t i = 0; i < POSTPONER_BUFFER_SIZE + 3; i++) {
+        PostponerCore_TrackKeyEvent(keys[i % TEST_KEY_COUNT], i % 3 != 2);
+        modelAppend(keys[i % TEST_KEY_COUNT], i % 3 != 2);
+    }
+    CHECK(checkQueries());
+}
+
+int main(void)
+{
+    HalShims_Reset();
+    keys[0] = &KeyStates[SlotId_RightKeyboardHalf][0];
+    keys[1] = &KeyStates[SlotId_RightKeyboardHalf][1];
+    keys[2] = &KeyStates[SlotId_RightKeyboardHalf][MAX_KEY_COUNT_PER_MODULE-1];
+    keys[3] = &KeyStates[SlotId_LeftKeyboardHalf][0];
+    keys[4] = &KeyStates[SlotId_LeftKeyboardHalf][17];
+    keys[5] = &KeyStates[SLOT_COUNT-1][5];
+    keys[6] = &unindexedKey;
+
+    RUN_TEST(testQueriesMatchQueueContents);
+    RUN_TEST(testFullQueueDropsOldestEvent);
+
+    TEST_EXIT();
+}
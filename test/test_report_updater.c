@@ -0,0 +1,257 @@
+#include "test.h"
+#include "trace.h"
+#include "hal_shims.h"
+#include "key_action.h"
+#include "key_states.h"
+#include "keymap.h"
+#include "layer.h"
+#include "right_key_matrix.h"
+#include "usb_composite_device.h"
+#include "usb_report_updater.h"
+#include "usb_interfaces/usb_interface_basic_keyboard.h"
+#include "usb_interfaces/usb_interface_nkro_keyboard.h"
+
+#define KEY_COUNT 8
+
+static void mapKeys(void)
+{
+    for (uint8_t keyId = 0; keyId < KEY_COUNT; keyId++) {
+        key_action_t *action = &CurrentKeymap[LayerId_Base][SlotId_RightKeyboardHalf][keyId];
+        action->type = KeyActionType_Keystroke;
+        action->keystroke.keystrokeType = KeystrokeType_Basic;
+        action->keystroke.scancode = HID_KEYBOARD_SC_A + keyId;
+    }
+}
+
+// Runs the main loop for the given number of milliseconds, completing every transfer right away.
+static void runFor(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        HalShims_AdvanceTime(1000);
+        HalShims_CompleteSends();
+        UpdateUsbReports();
+    }
+}
+
+static hal_shims_report_t* lastReport(uint8_t endpoint)
+{
+    for (uint32_t i = HalShims_SentReportCount; i > 0; i--) {
+        if (HalShims_SentReports[i-1].endpoint == endpoint) {
+            return &HalShims_SentReports[i-1];
+        }
+    }
+    return NULL;
+}
+
+// Reports are sent as a bitfield through the NKRO interface, and in the 8 byte boot format otherwise.
+static bool reportContains(hal_shims_report_t *report, uint8_t scancode)
+{
+    if (report->endpoint == USB_NKRO_KEYBOARD_ENDPOINT_INDEX) {
+        return UsbBasicKeyboardContainsScancode((usb_basic_keyboard_report_t*)report->data, scancode);
+    }
+    usb_boot_keyboard_report_t *bootReport = (usb_boot_keyboard_report_t*)report->data;
+    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
+        if (bootReport->scancodes[i] == scancode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void setProtocol(uint8_t protocol)
+{
+    UsbBasicKeyboardCallback(UsbCompositeDevice.basicKeyboardHandle, kUSB_DeviceHidEventSetProtocol, &protocol);
+}
+
+static void setKeys(uint64_t keyMask)
+{
+    RightKeyMatrix.keyStates = keyMask;
+}
+
+static void releaseAll(void)
+{
+    setKeys(0);
+    runFor(100);
+    HalShims_Reset();
+}
+
+static void testReportFollowsKeys(void)
+{
+    setKeys(1 << 0);
+    runFor(20);
+    hal_shims_report_t *report = lastReport(USB_BASIC_KEYBOARD_ENDPOINT_INDEX);
+    CHECK(report != NULL);
+    if (report) {
+        CHECK_EQUAL(report->length, USB_BASIC_KEYBOARD_REPORT_LENGTH);
+        CHECK(reportContains(report, HID_KEYBOARD_SC_A));
+    }
+
+    setKeys(0);
+    runFor(20);
+    report = lastReport(USB_BASIC_KEYBOARD_ENDPOINT_INDEX);
+    CHECK(report != NULL && !reportContains(report, HID_KEYBOARD_SC_A));
+
+    releaseAll();
+}
+
+static void testNkroReportCarriesAllKeys(void)
+{
+    HalShims_UseNkroKeyboard(true);
+
+    setKeys((1 << KEY_COUNT) - 1);
+    runFor(20);
+    CHECK(lastReport(USB_BASIC_KEYBOARD_ENDPOINT_INDEX) == NULL);
+    hal_shims_report_t *report = lastReport(USB_NKRO_KEYBOARD_ENDPOINT_INDEX);
+    CHECK(report != NULL);
+    if (report) {
+        CHECK_EQUAL(report->length, USB_NKRO_KEYBOARD_REPORT_LENGTH);
+        for (uint8_t keyId = 0; keyId < KEY_COUNT; keyId++) {
+            CHECK(reportContains(report, HID_KEYBOARD_SC_A + keyId));
+        }
+    }
+
+    releaseAll();
+    HalShims_UseNkroKeyboard(false);
+}
+
+// Hosts in boot protocol get boot reports even if they fetched the NKRO report descriptor. Six keys
+// fit the report, a seventh one turns all of its slots to ErrorRollOver until a key is released.
+static void testBootReportKeepsSixKeys(void)
+{
+    HalShims_UseNkroKeyboard(true);
+    setProtocol(0);
+
+    setKeys((1 << USB_BASIC_KEYBOARD_MAX_KEYS) - 1);
+    runFor(20);
+    CHECK(lastReport(USB_NKRO_KEYBOARD_ENDPOINT_INDEX) == NULL);
+    hal_shims_report_t *report = lastReport(USB_BASIC_KEYBOARD_ENDPOINT_INDEX);
+    CHECK(report != NULL);
+    if (report) {
+        CHECK_EQUAL(report->length, USB_BASIC_KEYBOARD_REPORT_LENGTH);
+        for (uint8_t keyId = 0; keyId < USB_BASIC_KEYBOARD_MAX_KEYS; keyId++) {
+            CHECK(reportContains(report, HID_KEYBOARD_SC_A + keyId));
+        }
+    }
+
+    setKeys((1 << KEY_COUNT) - 1);
+    runFor(20);
+    report = lastReport(USB_BASIC_KEYBOARD_ENDPOINT_INDEX);
+    usb_boot_keyboard_report_t *bootReport = (usb_boot_keyboard_report_t*)report->data;
+    for (uint8_t i = 0; i < USB_BASIC_KEYBOARD_MAX_KEYS; i++) {
+        CHECK_EQUAL(bootReport->scancodes[i], HID_KEYBOARD_SC_ERROR_ROLLOVER);
+    }
+
+    setKeys((1 << USB_BASIC_KEYBOARD_MAX_KEYS) - 1);
+    runFor(100);
+    report = lastReport(USB_BASIC_KEYBOARD_ENDPOINT_INDEX);
+    for (uint8_t keyId = 0; keyId < KEY_COUNT; keyId++) {
+        CHECK_EQUAL(reportContains(report, HID_KEYBOARD_SC_A + keyId), keyId < USB_BASIC_KEYBOARD_MAX_KEYS);
+    }
+
+    releaseAll();
+    setProtocol(1);
+    HalShims_UseNkroKeyboard(false);
+}
+
+static void testIdleMainLoopSendsNothing(void)
+{
+    runFor(100);
+    CHECK_EQUAL(HalShims_SentReportCount, 0);
+}
+
+static void testTraceIsReplayed(void)
+{
+    static const char text[] = "key 1 0x05\n10 press 1\n50 release 1\n";
+    static trace_t trace;
+    trace_stats_t stats = {};
+
+    FILE *file = fmemopen((void*)text, sizeof(text) - 1, "r");
+    CHECK(Trace_Read(file, "inline", &trace));
+    fclose(file);
+    CHECK_EQUAL(trace.eventCount, 2);
+
+    Trace_Replay(&trace, &stats);
+    CHECK_EQUAL(stats.updateCount, 50 + TRACE_SETTLE_TIME);
+    CHECK_EQUAL(stats.latencyCount, 1);
+    CHECK_EQUAL(HalShims_SentReportCount, 2);
+    CHECK(reportContains(&HalShims_SentReports[0], HID_KEYBOARD_SC_B));
+    CHECK(!reportContains(&HalShims_SentReports[1], HID_KEYBOARD_SC_B));
+
+    releaseAll();
+}
+
+static uint32_t latencySampleCount(uint8_t firstBucket, uint8_t lastBucket)
+{
+    uint32_t count = 0;
+    for (uint8_t bucket = firstBucket; bucket <= lastBucket; bucket++) {
+        count += KeyLatencyHistogram[bucket];
+    }
+    return count;
+}
+
+// Latency ends with the first report which carries the scancode of the pressed key, not with the next report.
+static void testKeyLatencyEndsWithScancode(void)
+{
+    key_action_t *secondaryRoleKey = &CurrentKeymap[LayerId_Base][SlotId_RightKeyboardHalf][KEY_COUNT];
+    key_action_t *layerKey = &CurrentKeymap[LayerId_Base][SlotId_RightKeyboardHalf][KEY_COUNT + 1];
+    *secondaryRoleKey = (key_action_t){ .type = KeyActionType_Keystroke, .keystroke = { .scancode = HID_KEYBOARD_SC_Z, .secondaryRole = SecondaryRole_LeftShift }};
+    *layerKey = (key_action_t){ .type = KeyActionType_SwitchLayer, .switchLayer = { .layer = LayerId_Fn }};
+    memset(KeyLatencyHistogram, 0, sizeof(KeyLatencyHistogram));
+
+    setKeys(1 << 0);
+    runFor(20);
+    CHECK_EQUAL(KeyLatencyHistogram[0], 1);
+    releaseAll();
+
+    // A tap of a secondary role key types its scancode once it is released.
+    setKeys(1 << KEY_COUNT);
+    runFor(4);
+    setKeys(0);
+    runFor(20);
+    CHECK_EQUAL(latencySampleCount(0, 3000 / KEY_LATENCY_HISTOGRAM_BUCKET_WIDTH - 1), 1);
+    CHECK_EQUAL(latencySampleCount(3000 / KEY_LATENCY_HISTOGRAM_BUCKET_WIDTH, KEY_LATENCY_HISTOGRAM_BUCKET_COUNT - 1), 1);
+    releaseAll();
+
+    // A layer switch types nothing, so its press is skipped, and the next key press is measured.
+    setKeys(1 << (KEY_COUNT + 1));
+    runFor(20);
+    setKeys(0);
+    runFor(20);
+    setKeys(1 << 1);
+    runFor(20);
+    CHECK_EQUAL(latencySampleCount(0, KEY_LATENCY_HISTOGRAM_BUCKET_COUNT - 1), 3);
+    releaseAll();
+
+    memset(secondaryRoleKey, 0, sizeof(*secondaryRoleKey));
+    memset(layerKey, 0, sizeof(*layerKey));
+}
+
+// configs/qwerty.bin is written by configs/generate-config.js.
+static void testConfigMapsKeys(void)
+{
+    CHECK(Trace_LoadConfig("configs/qwerty.bin"));
+    CHECK_EQUAL(CurrentKeymap[LayerId_Base][SlotId_RightKeyboardHalf][7].keystroke.scancode, HID_KEYBOARD_SC_Y);
+
+    setKeys(1 << 7);
+    runFor(20);
+    hal_shims_report_t *report = lastReport(USB_BASIC_KEYBOARD_ENDPOINT_INDEX);
+    CHECK(report != NULL && reportContains(report, HID_KEYBOARD_SC_Y));
+
+    releaseAll();
+}
+
+int main(void)
+{
+    HalShims_Reset();
+    mapKeys();
+
+    RUN_TEST(testReportFollowsKeys);
+    RUN_TEST(testNkroReportCarriesAllKeys);
+    RUN_TEST(testBootReportKeepsSixKeys);
+    RUN_TEST(testIdleMainLoopSendsNothing);
+    RUN_TEST(testTraceIsReplayed);
+    RUN_TEST(testKeyLatencyEndsWithScancode);
+    RUN_TEST(testConfigMapsKeys);
+
+    TEST_EXIT();
+}
@@ -0,0 +1,161 @@
+#include <ctype.h>
+#include "test.h"
+#include "macro_shortcut_lookup.h"
+#include "macro_shortcut_parser.h"
+#include "status_buffer.h"
+
+// Checks the generated perfect hash of macro_shortcut_lookup.c: every abbreviation of the table
+// is found in its own slot, and names which are not in the table, including near misses of the
+// ones which are, are reported as unrecognized instead of colliding with a record.
+
+static bool parse(const char *name, macro_action_t *action)
+{
+    uint32_t statusHead = StatusBuffer_Head;
+
+    *action = MacroShortcutParser_Parse(name, name + strlen(name), MacroSubAction_Tap);
+    return StatusBuffer_Head == statusHead;
+}
+
+static bool isTableName(const char *name)
+{
+    for (uint16_t i = 0; i < SHORTCUT_LOOKUP_TABLE_SIZE; i++) {
+        if (ShortcutLookupTable[i].id && strcmp(ShortcutLookupTable[i].id, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void checkRecognized(const lookup_record_t *record)
+{
+    macro_action_t action;
+
+    if (!parse(record->id, &action)) {
+        fprintf(stderr, "%s is not recognized\n", record->id);
+        TestFailures++;
+        return;
+    }
+    switch (record->type) {
+        case scType_basic:
+            CHECK_EQUAL(action.type, MacroActionType_Key);
+            CHECK_EQUAL(action.key.type, KeystrokeType_Basic);
+            CHECK_EQUAL(action.key.scancode, record->scancode);
+            break;
+        case scType_system:
+            CHECK_EQUAL(action.type, MacroActionType_Key);
+            CHECK_EQUAL(action.key.type, KeystrokeType_System);
+            CHECK_EQUAL(action.key.scancode, record->scancode);
+            break;
+        case scType_media:
+            CHECK_EQUAL(action.type, MacroActionType_Key);
+            CHECK_EQUAL(action.key.type, KeystrokeType_Media);
+            CHECK_EQUAL(action.key.scancode, record->scancode);
+            break;
+        case scType_mouseBtn:
+            CHECK_EQUAL(action.type, MacroActionType_MouseButton);
+            CHECK_EQUAL(action.mouseButton.mouseButtonsMask, record->scancode);
+            break;
+    }
+}
+
+static void checkUnrecognized(const char *name)
+{
+    macro_action_t action;
+
+    // Single characters are parsed without the table.
+    if (strlen(name) < 2 || isTableName(name)) {
+        return;
+    }
+    if (parse(name, &action)) {
+        fprintf(stderr, "%s is recognized\n", name);
+        TestFailures++;
+    }
+}
+
+static void testEveryRecordIsFound(void)
+{
+    uint16_t recordCount = 0;
+
+    for (uint16_t i = 0; i < SHORTCUT_LOOKUP_TABLE_SIZE; i++) {
+        if (ShortcutLookupTable[i].id) {
+            checkRecognized(&ShortcutLookupTable[i]);
+            recordCount++;
+        }
+    }
+    CHECK(recordCount > 0);
+}
+
+static void testNamesAreUnique(void)
+{
+    for (uint16_t i = 0; i < SHORTCUT_LOOKUP_TABLE_SIZE; i++) {
+        for (uint16_t j = i + 1; j < SHORTCUT_LOOKUP_TABLE_SIZE; j++) {
+            const char *a = ShortcutLookupTable[i].id;
+            const char *b = ShortcutLookupTable[j].id;
+            if (a && b && strcmp(a, b) == 0) {
+                fprintf(stderr, "%s is in slots %u and %u\n", a, i, j);
+                TestFailures++;
+            }
+        }
+    }
+}
+
+static void testNearMissesAreRejected(void)
+{
+    char name[64];
+
+    for (uint16_t i = 0; i < SHORTCUT_LOOKUP_TABLE_SIZE; i++) {
+        const char *id = ShortcutLookupTable[i].id;
+        size_t length = id ? strlen(id) : 0;
+        if (!id || length + 2 > sizeof(name)) {
+            continue;
+        }
+
+        strcpy(name, id);
+        name[0] = islower((uint8_t)name[0]) ? toupper((uint8_t)name[0]) : tolower((uint8_t)name[0]);
+        checkUnrecognized(name);
+
+        strcpy(name, id);
+        name[length - 1] = '\0';
+        checkUnrecognized(name);
+
+        strcpy(name, id);
+        strcat(name, "x");
+        checkUnrecognized(name);
+
+        strcpy(name, id);
+        name[length - 1]++;
+        checkUnrecognized(name);
+    }
+}
+
+static void testUnknownNamesAreRejected(void)
+{
+    checkUnrecognized("");
+    checkUnrecognized("enterr");
+    checkUnrecognized("notAKey");
+    checkUnrecognized("mouseBtn9");
+    checkUnrecognized("f25");
+}
+
+// "LS-" taps the modifiers alone, as with the sorted table which the hash replaced.
+static void testModifiersWithoutKeyAreAccepted(void)
+{
+    macro_action_t action;
+    const char *name = "LS-";
+
+    CHECK(parse(name, &action));
+    CHECK_EQUAL(action.type, MacroActionType_Key);
+    CHECK_EQUAL(action.key.scancode, 0);
+    CHECK_EQUAL(action.key.modifierMask, HID_KEYBOARD_MODIFIER_LEFTSHIFT);
+}
+
+int main(void)
+{
+    RUN_TEST(testEveryRecordIsFound);
+    RUN_TEST(testNamesAreUnique);
+    RUN_TEST(testNearMissesAreRejected);
+    RUN_TEST(testUnknownNamesAreRejected);
+    RUN_TEST(testModifiersWithoutKeyAreAccepted);
+
+    TEST_EXIT();
+}
@@ -0,0 +1,79 @@
+#include <glob.h>
+#include <limits.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "test.h"
+#include "trace.h"
+#include "hal_shims.h"
+
+// Replays every trace in traces/ and compares the sent reports with the .golden file next to it.
+// Run with UPDATE_GOLDEN=1 to rewrite the golden files after an intended behaviour change.
+// The reports of the last run are kept in TRACE_OUTPUT_DIR, which the Makefile places in BUILD_DIR.
+
+static trace_t trace;
+
+static bool replayTrace(const char *tracePath)
+{
+    char goldenPath[PATH_MAX], outputPath[PATH_MAX], command[3 * PATH_MAX];
+    char baseName[PATH_MAX];
+    trace_stats_t stats;
+
+    strncpy(baseName, tracePath, sizeof(baseName) - 1);
+    snprintf(goldenPath, sizeof(goldenPath), "%.*s.golden", (int)(strlen(tracePath) - strlen(".trace")), tracePath);
+    snprintf(outputPath, sizeof(outputPath), TRACE_OUTPUT_DIR "/%s.out", basename(baseName));
+
+    HalShims_Reset();
+    if (!Trace_Load(tracePath, &trace)) {
+        return false;
+    }
+    Trace_Replay(&trace, &stats);
+
+    bool updateGolden = getenv("UPDATE_GOLDEN") != NULL;
+    FILE *output = fopen(updateGolden ? goldenPath : outputPath, "w");
+    if (!output) {
+        fprintf(stderr, "%s: cannot write\n", updateGolden ? goldenPath : outputPath);
+        return false;
+    }
+    Trace_WriteReports(output);
+    fclose(output);
+    if (updateGolden) {
+        return true;
+    }
+
+    snprintf(command, sizeof(command), "diff -u %s %s", goldenPath, outputPath);
+    return system(command) == 0;
+}
+
+// Each trace runs in its own process, so that it starts from the power-on state of the firmware.
+static bool runIsolated(const char *tracePath)
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        exit(replayTrace(tracePath) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+int main(void)
+{
+    glob_t traces;
+
+    mkdir(TRACE_OUTPUT_DIR, 0755);
+    CHECK(glob("traces/*.trace", 0, NULL, &traces) == 0);
+
+    for (size_t i = 0; i < traces.gl_pathc; i++) {
+        bool replayed = runIsolated(traces.gl_pathv[i]);
+        if (!replayed) {
+            fprintf(stderr, "%s: reports differ from the golden file\n", traces.gl_pathv[i]);
+        }
+        CHECK(replayed);
+        TestCount++;
+    }
+
+    globfree(&traces);
+    TEST_EXIT();
+}
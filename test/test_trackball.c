@@ -0,0 +1,142 @@
+#include "test.h"
+#include "fsl_spi.h"
+#include "module.h"
+
+// Runs the trackball module's sensor driver against a stand-in of the SPI master, which records
+// every transfer together with the chip select line, and answers motion bursts from the sensor
+// registers of the test. The driver advances a phase on every completed transfer.
+
+#define NCS_GPIO GPIOB
+#define NCS_PIN 1
+#define MOTION_BURST_ADDRESS 0x12
+#define MOTION_BURST_DATA_SIZE 3
+#define MOTION_BIT (1<<7)
+#define MAX_TRANSFER_SIZE 4
+
+typedef struct {
+    uint8_t txData[MAX_TRANSFER_SIZE];
+    uint8_t length;
+    bool isNcsStrobed; // NCS was raised and lowered again since the previous transfer
+    bool isNcsLow;
+} spi_record_t;
+
+static spi_master_config_t spiConfig;
+static spi_master_handle_t *spiHandle;
+static spi_master_callback_t spiCallback;
+static void *spiUserData;
+static spi_record_t lastTransfer;
+static uint32_t transferCount;
+
+static uint8_t sensorMotion;
+static int8_t sensorDeltas[2]; // as the burst returns them after the motion register
+
+void SPI_MasterGetDefaultConfig(spi_master_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+}
+
+void SPI_MasterInit(SPI_Type *base, spi_master_config_t *config, uint32_t srcClock_Hz)
+{
+    spiConfig = *config;
+}
+
+void SPI_MasterTransferCreateHandle(SPI_Type *base, spi_master_handle_t *handle, spi_master_callback_t callback, void *userData)
+{
+    spiHandle = handle;
+    spiCallback = callback;
+    spiUserData = userData;
+}
+
+status_t SPI_MasterTransferNonBlocking(SPI_Type *base, spi_master_handle_t *handle, spi_transfer_t *xfer)
+{
+    uint32_t ncsMask = 1U << NCS_PIN;
+
+    CHECK(base == SPI0 && handle == spiHandle && xfer->dataSize <= MAX_TRANSFER_SIZE);
+    memset(&lastTransfer, 0, sizeof(lastTransfer));
+    memcpy(lastTransfer.txData, xfer->txData, xfer->dataSize);
+    lastTransfer.length = xfer->dataSize;
+    lastTransfer.isNcsStrobed = (NCS_GPIO->PSOR & ncsMask) && (NCS_GPIO->PCOR & ncsMask);
+    lastTransfer.isNcsLow = !(NCS_GPIO->PDOR & ncsMask);
+    NCS_GPIO->PSOR = NCS_GPIO->PCOR = 0;
+    transferCount++;
+
+    if (xfer->dataSize == MOTION_BURST_DATA_SIZE) {
+        xfer->rxData[0] = sensorMotion;
+        xfer->rxData[1] = sensorDeltas[0];
+        xfer->rxData[2] = sensorDeltas[1];
+    }
+    return kStatus_Success;
+}
+
+static void completeTransfer(void)
+{
+    spiCallback(SPI0, spiHandle, kStatus_Success, spiUserData);
+}
+
+static void checkTransfer(const uint8_t *txData, uint8_t length, bool isNcsStrobed)
+{
+    CHECK_EQUAL(lastTransfer.length, length);
+    CHECK(memcmp(lastTransfer.txData, txData, length) == 0);
+    CHECK_EQUAL(lastTransfer.isNcsStrobed, isNcsStrobed);
+    CHECK(lastTransfer.isNcsLow);
+}
+
+// Reads one motion burst: the address with a fresh chip select, then the data without one.
+static void readMotionBurst(uint8_t motion, int8_t firstDelta, int8_t secondDelta)
+{
+    static const uint8_t address[] = {MOTION_BURST_ADDRESS};
+    static const uint8_t data[MOTION_BURST_DATA_SIZE] = {0};
+
+    checkTransfer(address, sizeof(address), true);
+    sensorMotion = motion;
+    sensorDeltas[0] = firstDelta;
+    sensorDeltas[1] = secondDelta;
+    completeTransfer();
+    checkTransfer(data, sizeof(data), false);
+    completeTransfer();
+}
+
+static void testInitialization(void)
+{
+    Module_Init();
+    CHECK_EQUAL(spiConfig.polarity, kSPI_ClockPolarityActiveLow);
+    CHECK_EQUAL(spiConfig.phase, kSPI_ClockPhaseSecondEdge);
+    CHECK_EQUAL(spiConfig.baudRate_Bps, 500000);
+    checkTransfer((uint8_t[]){0xba, 0x5a}, 2, true);
+    completeTransfer();
+    checkTransfer((uint8_t[]){0x91, 0x80}, 2, true);
+    completeTransfer();
+    CHECK_EQUAL(transferCount, 3);
+}
+
+static void testBurstWithoutMotionIsIgnored(void)
+{
+    readMotionBurst(0, 10, 20);
+    CHECK_EQUAL(PointerDelta.x, 0);
+    CHECK_EQUAL(PointerDelta.y, 0);
+}
+
+static void testBurstDeltasAccumulate(void)
+{
+    uint32_t firstTransfer = transferCount;
+
+    readMotionBurst(MOTION_BIT, -5, 7);
+    CHECK_EQUAL(PointerDelta.x, -5);
+    CHECK_EQUAL(PointerDelta.y, 7);
+    readMotionBurst(MOTION_BIT | 0x01, 3, -128);
+    CHECK_EQUAL(PointerDelta.x, -2);
+    CHECK_EQUAL(PointerDelta.y, -121);
+    readMotionBurst(0x01, 9, 9);
+    CHECK_EQUAL(PointerDelta.x, -2);
+    CHECK_EQUAL(PointerDelta.y, -121);
+    CHECK_EQUAL(transferCount - firstTransfer, 3 * 2);
+}
+
+int main(void)
+{
+    RUN_TEST(testInitialization);
+    RUN_TEST(testBurstWithoutMotionIsIgnored);
+    RUN_TEST(testBurstDeltasAccumulate);
+
+    TEST_EXIT();
+}
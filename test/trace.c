@@ -0,0 +1,348 @@
+#include <libgen.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <time.h>
+#include "trace.h"
+#include "hal_shims.h"
+#include "key_action.h"
+#include "keymap.h"
+#include "layer.h"
+#include "macros.h"
+#include "macro_bytecode.h"
+#include "right_key_matrix.h"
+#include "status_buffer.h"
+#include "timer.h"
+#include "usb_report_updater.h"
+#include "eeprom.h"
+#include "config_parser/config_globals.h"
+#include "config_parser/parse_macro.h"
+#include "usb_protocol_handler.h"
+#include "usb_commands/usb_command_apply_config.h"
+#include "usb_interfaces/usb_interface_basic_keyboard.h"
+#include "usb_interfaces/usb_interface_generic_hid.h"
+#include "usb_interfaces/usb_interface_nkro_keyboard.h"
+
+// A trace optionally loads a user config, maps keys of the right half on top of it, then lists
+// timed key events. Lines are:
+//
+//   config <path of a binary user config, relative to the trace>
+//   key <keyId> <scancode> [<modifiers>]
+//   secondary <keyId> <scancode> <role>
+//   macro <keyId> <text action, a command if it starts with $>
+//   command <keyId> <command action>
+//   <ms> press|release <keyId>
+//
+// Consecutive macro and command lines of a key make up the actions of its macro. # starts a comment.
+
+#define TRACE_MAX_LINE 256
+
+static const char *secondaryRoleNames[] = {
+    [SecondaryRole_LeftCtrl] = "LeftCtrl",
+    [SecondaryRole_LeftShift] = "LeftShift",
+    [SecondaryRole_LeftAlt] = "LeftAlt",
+    [SecondaryRole_LeftSuper] = "LeftSuper",
+    [SecondaryRole_RightCtrl] = "RightCtrl",
+    [SecondaryRole_RightShift] = "RightShift",
+    [SecondaryRole_RightAlt] = "RightAlt",
+    [SecondaryRole_RightSuper] = "RightSuper",
+    [SecondaryRole_Mod] = "Mod",
+    [SecondaryRole_Fn] = "Fn",
+    [SecondaryRole_Mouse] = "Mouse",
+};
+
+static bool isKeymapEdited;
+static uint16_t configOffset;
+static uint8_t macroKeyId = 255;
+static uint16_t macroStart;
+static uint8_t macroActionCount;
+
+// Loads a binary user config the way Agent does: it is written to the staging buffer and applied by ApplyConfig.
+bool Trace_LoadConfig(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    size_t length = fread(StagingUserConfigBuffer.buffer, 1, USER_CONFIG_SIZE, file);
+    fclose(file);
+
+    UsbCommand_ApplyConfig();
+    if (GenericHidInBuffer[0] != UsbStatusCode_Success) {
+        fprintf(stderr, "%s: parser error %d at offset %d of %zu\n", path,
+            GenericHidInBuffer[0], GenericHidInBuffer[1] | GenericHidInBuffer[2] << 8, length);
+        return false;
+    }
+    configOffset = ValidatedUserConfigLength;
+    return true;
+}
+
+static key_action_t* keyAction(uint8_t keyId)
+{
+    isKeymapEdited = true;
+    return &CurrentKeymap[LayerId_Base][SlotId_RightKeyboardHalf][keyId];
+}
+
+static void writeByte(uint8_t byte)
+{
+    ValidatedUserConfigBuffer.buffer[configOffset++] = byte;
+}
+
+static void writeString(const char *text, uint16_t length)
+{
+    writeByte(length);
+    memcpy(&ValidatedUserConfigBuffer.buffer[configOffset], text, length);
+    configOffset += length;
+}
+
+// Macros are serialized behind the validated user config and parsed by ParseMacro, like the ones of a real configuration.
+static void beginMacro(uint8_t keyId)
+{
+    char name[8];
+    uint8_t nameLength = snprintf(name, sizeof(name), "key%d", keyId);
+
+    macroKeyId = keyId;
+    macroStart = configOffset;
+    macroActionCount = 0;
+    writeByte(false); // isLooped
+    writeByte(false); // isPrivate
+    writeString(name, nameLength);
+    writeByte(0); // macroActionsCount, patched by endMacro
+}
+
+static void endMacro(void)
+{
+    if (macroKeyId == 255) {
+        return;
+    }
+    uint8_t *count = &ValidatedUserConfigBuffer.buffer[macroStart + 2 + 1 + ValidatedUserConfigBuffer.buffer[macroStart + 2]];
+    if (macroActionCount < 0xff) {
+        *count = macroActionCount;
+    } else {
+        // a compact length of 0xff is followed by the length as a uint16
+        memmove(count + 3, count + 1, &ValidatedUserConfigBuffer.buffer[configOffset] - (count + 1));
+        configOffset += 2;
+        count[0] = 0xff;
+        count[1] = macroActionCount;
+        count[2] = 0;
+    }
+
+    ValidatedUserConfigBuffer.offset = macroStart;
+    ParseMacro(&ValidatedUserConfigBuffer, AllMacrosCount);
+
+    key_action_t *action = keyAction(macroKeyId);
+    action->type = KeyActionType_PlayMacro;
+    action->playMacro.macroId = AllMacrosCount++;
+    IndexMacroNames();
+    macroKeyId = 255;
+}
+
+static void addMacroAction(uint8_t keyId, serialized_macro_action_type_t type, const char *text)
+{
+    if (keyId != macroKeyId) {
+        endMacro();
+        beginMacro(keyId);
+    }
+    writeByte(type);
+    writeString(text, strcspn(text, "\r\n"));
+    macroActionCount++;
+}
+
+static uint8_t parseSecondaryRole(const char *name)
+{
+    for (uint8_t role = 0; role < sizeof(secondaryRoleNames) / sizeof(secondaryRoleNames[0]); role++) {
+        if (secondaryRoleNames[role] && strcmp(secondaryRoleNames[role], name) == 0) {
+            return role;
+        }
+    }
+    return 0;
+}
+
+static bool loadRelativeConfig(const char *traceName, const char *configName)
+{
+    char traceDir[PATH_MAX], configPath[2 * PATH_MAX];
+
+    // The keymap edits of the trace would be overwritten.
+    if (isKeymapEdited) {
+        return false;
+    }
+    strncpy(traceDir, traceName, sizeof(traceDir) - 1);
+    traceDir[sizeof(traceDir) - 1] = '\0';
+    snprintf(configPath, sizeof(configPath), "%s/%s", dirname(traceDir), configName);
+    return Trace_LoadConfig(configPath);
+}
+
+static bool parseLine(char *line, const char *name, trace_t *trace)
+{
+    char command[16], argument[PATH_MAX];
+    unsigned int keyId, scancode, modifiers = 0;
+    uint32_t time;
+    int consumed;
+
+    if (line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#') {
+        return true;
+    }
+    if (sscanf(line, "config %4095s", argument) == 1) {
+        return loadRelativeConfig(name, argument);
+    }
+    if (sscanf(line, "key %u %i %i", &keyId, &scancode, &modifiers) >= 2 && keyId < RIGHT_KEY_MATRIX_KEY_COUNT) {
+        key_action_t *action = keyAction(keyId);
+        action->type = KeyActionType_Keystroke;
+        action->keystroke.keystrokeType = KeystrokeType_Basic;
+        action->keystroke.scancode = scancode;
+        action->keystroke.modifiers = modifiers;
+        action->keystroke.secondaryRole = 0;
+        return true;
+    }
+    if (sscanf(line, "secondary %u %i %15s", &keyId, &scancode, argument) == 3 && keyId < RIGHT_KEY_MATRIX_KEY_COUNT) {
+        key_action_t *action = keyAction(keyId);
+        action->type = KeyActionType_Keystroke;
+        action->keystroke.keystrokeType = KeystrokeType_Basic;
+        action->keystroke.scancode = scancode;
+        action->keystroke.modifiers = 0;
+        action->keystroke.secondaryRole = parseSecondaryRole(argument);
+        return action->keystroke.secondaryRole != 0;
+    }
+    if (sscanf(line, "macro %u %n", &keyId, &consumed) == 1 && keyId < RIGHT_KEY_MATRIX_KEY_COUNT) {
+        addMacroAction(keyId, SerializedMacroActionType_TextMacroAction, line + consumed);
+        return true;
+    }
+    if (sscanf(line, "command %u %n", &keyId, &consumed) == 1 && keyId < RIGHT_KEY_MATRIX_KEY_COUNT) {
+        addMacroAction(keyId, SerializedMacroActionType_CommandMacroAction, line + consumed);
+        return true;
+    }
+    if (sscanf(line, "%u %15s %u", &time, command, &keyId) == 3 && keyId < RIGHT_KEY_MATRIX_KEY_COUNT) {
+        if (trace->eventCount == TRACE_MAX_EVENTS || (trace->eventCount && time < trace->events[trace->eventCount-1].time)) {
+            return false;
+        }
+        trace->events[trace->eventCount++] = (trace_event_t){
+            .time = time,
+            .keyId = keyId,
+            .press = strcmp(command, "press") == 0,
+        };
+        trace->duration = time + TRACE_SETTLE_TIME;
+        return strcmp(command, "press") == 0 || strcmp(command, "release") == 0;
+    }
+    return false;
+}
+
+// Maps the keys of the trace into the current keymap and reads its events. Traces are meant to
+// be read once per process, on top of the power-on state of the firmware.
+bool Trace_Read(FILE *file, const char *name, trace_t *trace)
+{
+    char line[TRACE_MAX_LINE];
+    uint16_t lineNumber = 0;
+
+    memset(trace, 0, sizeof(*trace));
+    MacroBytecode_Reset();
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        if (!parseLine(line, name, trace)) {
+            fprintf(stderr, "%s:%d: invalid line: %s", name, lineNumber, line);
+            return false;
+        }
+    }
+    endMacro();
+    return true;
+}
+
+bool Trace_Load(const char *path, trace_t *trace)
+{
+    FILE *file = fopen(path, "r");
+
+    if (!file) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    bool loaded = Trace_Read(file, path, trace);
+    fclose(file);
+    return loaded;
+}
+
+static uint64_t nanoseconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static bool isKeyboardEndpoint(uint8_t endpoint)
+{
+    return endpoint == USB_BASIC_KEYBOARD_ENDPOINT_INDEX || endpoint == USB_NKRO_KEYBOARD_ENDPOINT_INDEX;
+}
+
+// Replays the trace one main loop update per millisecond, starting from a released keyboard.
+void Trace_Replay(const trace_t *trace, trace_stats_t *stats)
+{
+    uint16_t eventIdx = 0;
+    uint32_t firstReport = HalShims_SentReportCount;
+    uint32_t startTime = Timer_GetCurrentTimeMicros() / 1000;
+    uint32_t *updateTimes = stats->updateTimes;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->updateTimes = updateTimes;
+    RightKeyMatrix.keyStates = 0;
+
+    for (uint32_t time = 0; time < trace->duration; time++) {
+        for (; eventIdx < trace->eventCount && trace->events[eventIdx].time == time; eventIdx++) {
+            uint64_t keyMask = 1ULL << trace->events[eventIdx].keyId;
+            if (trace->events[eventIdx].press) {
+                RightKeyMatrix.keyStates |= keyMask;
+            } else {
+                RightKeyMatrix.keyStates &= ~keyMask;
+            }
+        }
+
+        HalShims_AdvanceTime(1000);
+        HalShims_CompleteSends();
+
+        uint64_t updateStart = nanoseconds();
+        UpdateUsbReports();
+        uint32_t updateTime = nanoseconds() - updateStart;
+        stats->updateTime += updateTime;
+        if (updateTimes) {
+            updateTimes[stats->updateCount] = updateTime;
+        }
+        stats->updateCount++;
+    }
+
+    for (uint16_t i = 0; i < trace->eventCount; i++) {
+        if (!trace->events[i].press) {
+            continue;
+        }
+        uint32_t pressTime = startTime + trace->events[i].time;
+        for (uint32_t r = firstReport; r < HalShims_SentReportCount; r++) {
+            hal_shims_report_t *report = &HalShims_SentReports[r];
+            if (isKeyboardEndpoint(report->endpoint) && report->time / 1000 > pressTime) {
+                stats->latencySum += report->time / 1000 - pressTime;
+                stats->latencyCount++;
+                break;
+            }
+        }
+    }
+}
+
+void Trace_WriteReports(FILE *file)
+{
+    for (uint32_t r = 0; r < HalShims_SentReportCount; r++) {
+        hal_shims_report_t *report = &HalShims_SentReports[r];
+        fprintf(file, "%u ep%u", report->time / 1000, report->endpoint);
+        for (uint8_t i = 0; i < report->length; i++) {
+            fprintf(file, " %02x", report->data[i]);
+        }
+        fprintf(file, "\n");
+    }
+    if (HalShims_SentReportCount == HAL_SHIMS_MAX_SENT_REPORTS) {
+        fprintf(file, "report log full\n");
+    }
+
+    // Errors and warnings of macros belong to the expected output too.
+    char status[STATUS_BUFFER_SIZE + 1];
+    uint32_t position = StatusBuffer_Tail;
+    uint16_t length = StatusBuffer_Read(&position, status, STATUS_BUFFER_SIZE);
+    status[length] = '\0';
+    for (char *line = strtok(status, "\n"); line; line = strtok(NULL, "\n")) {
+        fprintf(file, "status %s\n", line);
+    }
+}
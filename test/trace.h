@@ -0,0 +1,44 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+// Includes:
+
+    #include <stdio.h>
+    #include "fsl_common.h"
+
+// Macros:
+
+    #define TRACE_MAX_EVENTS 1024
+    #define TRACE_SETTLE_TIME 500 // ms replayed after the last event
+
+// Typedefs:
+
+    typedef struct {
+        uint32_t time; // ms
+        uint8_t keyId;
+        bool press;
+    } trace_event_t;
+
+    typedef struct {
+        trace_event_t events[TRACE_MAX_EVENTS];
+        uint16_t eventCount;
+        uint32_t duration; // ms
+    } trace_t;
+
+    typedef struct {
+        uint32_t updateCount;
+        uint64_t updateTime; // ns spent in UpdateUsbReports
+        uint32_t *updateTimes; // ns of every update, if not NULL
+        uint32_t latencySum; // ms from a press to the next keyboard report
+        uint32_t latencyCount;
+    } trace_stats_t;
+
+// Functions:
+
+    bool Trace_LoadConfig(const char *path);
+    bool Trace_Read(FILE *file, const char *name, trace_t *trace);
+    bool Trace_Load(const char *path, trace_t *trace);
+    void Trace_Replay(const trace_t *trace, trace_stats_t *stats);
+    void Trace_WriteReports(FILE *file);
+
+#endif
@@ -35,6 +35,10 @@
 
 #define TRACKBALL_SPI_MASTER SPI0
 #define TRACKBALL_SPI_MASTER_SOURCE_CLOCK kCLOCK_BusClk
+#define TRACKBALL_SPI_BAUD_RATE 500000U
+
+// Minimum time between the address byte and the first data byte of the motion burst (tSRAD_MOTBR).
+#define TRACKBALL_SRAD_MOTBR_US 4
 
 pointer_delta_t PointerDelta;
 
@@ -44,72 +48,83 @@ key_vector_t KeyVector = {
         {PORTA, GPIOA, kCLOCK_PortA, 3}, // left button
         {PORTA, GPIOA, kCLOCK_PortA, 12}, // right button
     },
-    .keyStates = {0}
+    .keyStates = 0
 };
 
 #define BUFFER_SIZE 2
+#define MOTION_BURST_DATA_SIZE 3
 #define MOTION_BIT (1<<7)
 
 typedef enum {
     ModulePhase_SetResolution,
     ModulePhase_Initialized,
-    ModulePhase_ProcessMotion,
-    ModulePhase_ProcessDeltaY,
-    ModulePhase_ProcessDeltaX,
+    ModulePhase_ReadMotionBurst,
+    ModulePhase_ProcessMotionBurst,
 } module_phase_t;
 
 module_phase_t modulePhase = ModulePhase_SetResolution;
 
 uint8_t txBufferPowerUpReset[] = {0xba, 0x5a};
 uint8_t txSetResolution[] = {0x91, 0b10000000};
-uint8_t txBufferGetMotion[] = {0x02, 0x00};
-uint8_t txBufferGetDeltaY[] = {0x03, 0x00};
-uint8_t txBufferGetDeltaX[] = {0x04, 0x00};
 
-uint8_t rxBuffer[BUFFER_SIZE];
+// The motion burst returns the motion, delta x and delta y registers in a single transaction.
+// The address is sent on its own, so that tSRAD_MOTBR can pass before the data bytes are clocked
+// out. The rest of the burst is not needed, and raising NCS ends it.
+uint8_t txBufferMotionBurstAddress[] = {0x12};
+uint8_t txBufferMotionBurstData[MOTION_BURST_DATA_SIZE] = {0x00, 0x00, 0x00};
+
+uint8_t rxBuffer[MOTION_BURST_DATA_SIZE];
 spi_master_handle_t handle;
 spi_transfer_t xfer = {0};
 
-void tx(uint8_t *txBuff)
+void transfer(uint8_t *txBuff, uint8_t length)
 {
-    GPIO_WritePinOutput(TRACKBALL_NCS_GPIO, TRACKBALL_NCS_PIN, 1);
-    GPIO_WritePinOutput(TRACKBALL_NCS_GPIO, TRACKBALL_NCS_PIN, 0);
     xfer.txData = txBuff;
+    xfer.dataSize = length;
     SPI_MasterTransferNonBlocking(TRACKBALL_SPI_MASTER, &handle, &xfer);
 }
 
+void tx(uint8_t *txBuff, uint8_t length)
+{
+    GPIO_WritePinOutput(TRACKBALL_NCS_GPIO, TRACKBALL_NCS_PIN, 1);
+    GPIO_WritePinOutput(TRACKBALL_NCS_GPIO, TRACKBALL_NCS_PIN, 0);
+    transfer(txBuff, length);
+}
+
+// Busy waits at least the given time. A loop iteration takes more than four core clock cycles.
+void delayUs(uint32_t us)
+{
+    for (volatile uint32_t i = us * (SystemCoreClock / 1000000U / 4); i > 0; i--) {
+    }
+}
+
 void trackballUpdate(SPI_Type *base, spi_master_handle_t *masterHandle, status_t status, void *userData)
 {
     switch (modulePhase) {
         case ModulePhase_SetResolution:
-            tx(txSetResolution);
+            tx(txSetResolution, BUFFER_SIZE);
             modulePhase = ModulePhase_Initialized;
             break;
         case ModulePhase_Initialized:
-            tx(txBufferGetMotion);
-            modulePhase = ModulePhase_ProcessMotion;
+            tx(txBufferMotionBurstAddress, sizeof(txBufferMotionBurstAddress));
+            modulePhase = ModulePhase_ReadMotionBurst;
+            break;
+        case ModulePhase_ReadMotionBurst:
+            delayUs(TRACKBALL_SRAD_MOTBR_US);
+            transfer(txBufferMotionBurstData, MOTION_BURST_DATA_SIZE);
+            modulePhase = ModulePhase_ProcessMotionBurst;
             break;
-        case ModulePhase_ProcessMotion: ;
-            uint8_t motion = rxBuffer[1];
+        case ModulePhase_ProcessMotionBurst: ;
+            uint8_t motion = rxBuffer[0];
             bool isMoved = motion & MOTION_BIT;
             if (isMoved) {
-                tx(txBufferGetDeltaY);
-                modulePhase = ModulePhase_ProcessDeltaY;
-            } else {
-                tx(txBufferGetMotion);
+                int8_t deltaY = (int8_t)rxBuffer[1];
+                int8_t deltaX = (int8_t)rxBuffer[2];
+                PointerDelta.x += deltaY; // This is correct given the sensor orientation.
+                PointerDelta.y += deltaX; // This is correct given the sensor orientation.
             }
-            break;
-        case ModulePhase_ProcessDeltaY: ;
-            int8_t deltaY = (int8_t)rxBuffer[1];
-            PointerDelta.x += deltaY; // This is correct given the sensor orientation.
-            tx(txBufferGetDeltaX);
-            modulePhase = ModulePhase_ProcessDeltaX;
-            break;
-        case ModulePhase_ProcessDeltaX: ;
-            int8_t deltaX = (int8_t)rxBuffer[1];
-            PointerDelta.y += deltaX; // This is correct given the sensor orientation.
-            tx(txBufferGetMotion);
-            modulePhase = ModulePhase_ProcessMotion;
+            tx(txBufferMotionBurstAddress, sizeof(txBufferMotionBurstAddress));
+            modulePhase = ModulePhase_ReadMotionBurst;
             break;
     }
 }
@@ -137,13 +152,12 @@ void Trackball_Init(void)
     SPI_MasterGetDefaultConfig(&userConfig);
     userConfig.polarity = kSPI_ClockPolarityActiveLow;
     userConfig.phase = kSPI_ClockPhaseSecondEdge;
-    userConfig.baudRate_Bps = 100000U;
+    userConfig.baudRate_Bps = TRACKBALL_SPI_BAUD_RATE;
     srcFreq = CLOCK_GetFreq(TRACKBALL_SPI_MASTER_SOURCE_CLOCK);
     SPI_MasterInit(TRACKBALL_SPI_MASTER, &userConfig, srcFreq);
     SPI_MasterTransferCreateHandle(TRACKBALL_SPI_MASTER, &handle, trackballUpdate, NULL);
     xfer.rxData = rxBuffer;
-    xfer.dataSize = BUFFER_SIZE;
-    tx(txBufferPowerUpReset);
+    tx(txBufferPowerUpReset, BUFFER_SIZE);
 }
 
 void Module_Init(void)
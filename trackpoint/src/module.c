@@ -9,7 +9,7 @@ key_vector_t KeyVector = {
         {PORTB, GPIOB, kCLOCK_PortB,  5}, // left microswitch
         {PORTA, GPIOA, kCLOCK_PortA,  12}, // right microswitch
     },
-    .keyStates = {0}
+    .keyStates = 0
 };
 
 void Module_Init(void)